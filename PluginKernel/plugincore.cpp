@@ -407,6 +407,10 @@ bool PluginCore::reset(ResetInfo& resetInfo)
     audioProcDescriptor.bitDepth = resetInfo.bitDepth;
 
 	synthEngine.reset(resetInfo.sampleRate);
+
+	// --- the master FX delay depends on the sample rate (lookahead, convolver head block)
+	pluginDescriptor.latencyInSamples = kLatencyInSamples + synthEngine.getLatency();
+
     // --- other reset inits
     return PluginBase::reset(resetInfo);
 }
@@ -496,6 +500,9 @@ void PluginCore::updateParameters()
 	// --- THE update - this trickles all param updates
 	// via the setParameters( ) of each
 	synthEngine.setParameters(engineParams);
+
+	// --- the master FX slots set the latency reported to the host
+	pluginDescriptor.latencyInSamples = kLatencyInSamples + synthEngine.getLatency();
 }
 
 /**
@@ -626,6 +633,108 @@ bool PluginCore::processAudioFrame(ProcessFrameInfo& processFrameInfo)
 }
 
 
+/**
+\brief buffer-processing method
+
+Operation:
+- synth plugins render in blocks with SynthEngine::renderAudioBlock( ); the buffer is split at the sample
+  offsets of its MIDI events so they stay sample accurate
+- each frame fires its MIDI events exactly as processAudioFrame( ) does; they are held in pendingMIDIEvents
+  until the frames ahead of them are rendered, then applied to the engine
+- per-frame parameter updates (VST automation and smoothing) still run on every sample interval
+- FX plugins use the base class frame loop
+
+\param processBufferInfo structure of information about *buffer* processing
+
+\return true if operation succeeds, false otherwise
+*/
+bool PluginCore::processAudioBuffers(ProcessBufferInfo& processBufferInfo)
+{
+	if (getPluginType() != kSynthPlugin)
+		return PluginBase::processAudioBuffers(processBufferInfo);
+
+	// --- sync internal bound variables and update all parameters ONCE per buffer
+	preProcessAudioBuffers(processBufferInfo);
+
+	// --- channels the synth does not write stay silent
+	for (uint32_t i = 0; i < processBufferInfo.numAudioOutChannels; i++)
+		memset(processBufferInfo.outputs[i], 0, processBufferInfo.numFramesToProcess * sizeof(float));
+
+	uint32_t startFrame = 0;
+	for (uint32_t frame = 0; frame < processBufferInfo.numFramesToProcess; frame++)
+	{
+		// --- fire any MIDI events for this sample interval; they land in pendingMIDIEvents
+		pendingMIDIEventCount = 0;
+		holdMIDIEvents = true;
+		processBufferInfo.midiEventQueue->fireMidiEvents(frame);
+		holdMIDIEvents = false;
+
+		// --- render up to the event, then apply it
+		if (pendingMIDIEventCount > 0)
+		{
+			renderSynthFrames(processBufferInfo, startFrame, frame);
+			startFrame = frame;
+
+			for (uint32_t i = 0; i < pendingMIDIEventCount; i++)
+				synthEngine.processMIDIEvent(pendingMIDIEvents[i]);
+			pendingMIDIEventCount = 0;
+		}
+
+		// --- do per-frame updates; VST automation and parameter smoothing
+		doSampleAccurateParameterUpdates();
+	}
+
+	// --- the rest of the buffer
+	renderSynthFrames(processBufferInfo, startFrame, processBufferInfo.numFramesToProcess);
+
+	// --- update per-buffer
+	processBufferInfo.hostInfo->uAbsoluteFrameBufferIndex += processBufferInfo.numFramesToProcess;
+	processBufferInfo.hostInfo->dAbsoluteFrameBufferTime += (double)processBufferInfo.numFramesToProcess / audioProcDescriptor.sampleRate;
+
+	// --- generally not used
+	postProcessAudioBuffers(processBufferInfo);
+
+	return true; /// processed
+}
+
+/**
+\brief render frames [startFrame, endFrame) of the synth into the output buffers
+
+Operation:
+- the engine renders MAX_RENDER_BLOCK_SIZE frames at a time into the double scratch buffers, which are
+  then written to the host's float outputs (left, and right for stereo outputs)
+
+\param processBufferInfo structure of information about *buffer* processing
+\param startFrame first frame to render
+\param endFrame one past the last frame to render
+*/
+void PluginCore::renderSynthFrames(ProcessBufferInfo& processBufferInfo, uint32_t startFrame, uint32_t endFrame)
+{
+	while (startFrame < endFrame)
+	{
+		uint32_t frames = endFrame - startFrame < MAX_RENDER_BLOCK_SIZE ? endFrame - startFrame : MAX_RENDER_BLOCK_SIZE;
+
+		// --- do the synth render
+		synthEngine.renderAudioBlock(&renderBufferLeft[0], &renderBufferRight[0], frames);
+
+		// --- write left channel
+		if (processBufferInfo.numAudioOutChannels > 0)
+		{
+			for (uint32_t i = 0; i < frames; i++)
+				processBufferInfo.outputs[0][startFrame + i] = (float)renderBufferLeft[i];
+		}
+
+		// --- write right channel
+		if (processBufferInfo.numAudioOutChannels > 1 && processBufferInfo.channelIOConfig.outputChannelFormat == kCFStereo)
+		{
+			for (uint32_t i = 0; i < frames; i++)
+				processBufferInfo.outputs[1][startFrame + i] = (float)renderBufferRight[i];
+		}
+
+		startFrame += frames;
+	}
+}
+
 /**
 \brief do anything needed prior to arrival of audio buffers
 
@@ -885,6 +994,14 @@ NOTES:
 */
 bool PluginCore::processMIDIEvent(midiEvent& event)
 {
+	// --- block rendering: hold the event until the frames ahead of it are rendered
+	//     (see processAudioBuffers( )); if the queue is full, apply it now, a few frames early
+	if (holdMIDIEvents && pendingMIDIEventCount < MAX_PENDING_MIDI_EVENTS)
+	{
+		pendingMIDIEvents[pendingMIDIEventCount++] = event;
+		return true;
+	}
+
 	synthEngine.processMIDIEvent(event);
 	return true;
 }
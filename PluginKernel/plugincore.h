@@ -96,9 +96,8 @@ public:
 	/** process frames of data */
 	virtual bool processAudioFrame(ProcessFrameInfo& processFrameInfo);
 
-	// --- uncomment and override this for buffer processing; see base class implementation for
-	//     help on breaking up buffers and getting info from processBufferInfo
-	//virtual bool processAudioBuffers(ProcessBufferInfo& processBufferInfo);
+	/** process buffers of data; the synth renders in blocks that are split at the MIDI event offsets */
+	virtual bool processAudioBuffers(ProcessBufferInfo& processBufferInfo);
 
 	/** preProcess: do any post-buffer processing required; default operation is to send metering data to GUI  */
 	virtual bool postProcessAudioBuffers(ProcessBufferInfo& processInfo);
@@ -133,6 +132,15 @@ public:
 	SynthEngine synthEngine;
 	void updateParameters();
 
+	// --- block rendering: MIDI events fired inside a buffer are held until the frames ahead of them are rendered
+	static const uint32_t MAX_PENDING_MIDI_EVENTS = 256;
+	midiEvent pendingMIDIEvents[MAX_PENDING_MIDI_EVENTS];
+	uint32_t pendingMIDIEventCount = 0;
+	bool holdMIDIEvents = false;
+	double renderBufferLeft[MAX_RENDER_BLOCK_SIZE] = { 0.0 };
+	double renderBufferRight[MAX_RENDER_BLOCK_SIZE] = { 0.0 };
+	void renderSynthFrames(ProcessBufferInfo& processBufferInfo, uint32_t startFrame, uint32_t endFrame);
+
 	ICustomView* bankAndWaveGroup_0 = nullptr;
 
 	// --- END USER VARIABLES AND FUNCTIONS -------------------------------------- //
@@ -72,6 +72,9 @@ bool DCA::update(bool updateAllModRoutings)
 	// --- equal power calculation in synthfunction.h
 	calculatePanValues(panTotal, panLeftGain, panRightGain);
 
+	// --- the channel gains ramp to the new values across the update interval
+	setGainTargets(gainRaw * panLeftGain, gainRaw * panRightGain);
+
 	return true; // handled
 }
 
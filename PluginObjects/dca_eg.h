@@ -59,9 +59,21 @@ public:
 		panLeftGain = 0.707;	// --- center
 		panRightGain = 0.707;	// --- center
 
+		// --- the channel gains ramp up from silence on the first update
+		for (int i = 0; i < 2; i++)
+		{
+			currentGain[i] = 0.0;
+			targetGain[i] = 0.0;
+			gainInc[i] = 0.0;
+		}
+		rampCounter = 0;
+
 		return true;
 	}
 
+	// --- number of samples between full updates; the channel gains ramp across this many samples
+	void setGainRampLength(uint32_t samples) { gainRampLength = samples > 0 ? samples : 1; }
+
 	// --- we can do multi-channel but need a different manner for passing data
 	virtual bool canProcessAudioFrame() { return false; }
 
@@ -75,25 +87,54 @@ public:
 		if (audioData->numInputChannels == 0 || audioData->numOutputChannels == 0)
 			return false;
 
+		// --- smoothed channel gains (gain * pan)
+		advanceGainRamp();
+
 		// --- if MONO, no panning is applied to left channel
 		if (audioData->numInputChannels == 1 && audioData->numOutputChannels == 1)
 			audioData->outputs[0] = audioData->inputs[0] * gainRaw;
 		else if (audioData->numOutputChannels > 1)
 			// --- stereo, add left pan value
-			audioData->outputs[0] = audioData->inputs[0] * gainRaw * panLeftGain;
+			audioData->outputs[0] = audioData->inputs[0] * currentGain[0];
 
 		// --- now process right channel
 		// --- monot -> stereo: copy left channel to right and apply panning gain
 		if (audioData->numInputChannels == 1 && audioData->numOutputChannels == 2)
-			audioData->outputs[1] = audioData->inputs[0] * gainRaw  * panRightGain;
+			audioData->outputs[1] = audioData->inputs[0] * currentGain[1];
 
 		// --- stereo to stereo
 		else if (audioData->numInputChannels == 2 && audioData->numOutputChannels == 2)
-			audioData->outputs[1] = audioData->inputs[1] * gainRaw  * panRightGain;
+			audioData->outputs[1] = audioData->inputs[1] * currentGain[1];
 
 		return true;
 	}
 
+	// --- block version of processSynthAudio( ) for stereo out: applies the smoothed gain and pan to a voice
+	//     buffer and accumulates the result into a stereo bus, scaled by busGain
+	//     NOTE: pass the same buffer for both inputs for a mono voice; the result is the same as
+	//           blockSize calls to processSynthAudio( ) summed into the bus
+	void processBlock(const double* inputLeft, const double* inputRight, double* busLeft, double* busRight, uint32_t blockSize, double busGain)
+	{
+		uint32_t n = 0;
+
+		// --- ramping part
+		for (; n < blockSize && rampCounter > 0; n++)
+		{
+			advanceGainRamp();
+			busLeft[n] += busGain * (inputLeft[n] * currentGain[0]);
+			busRight[n] += busGain * (inputRight[n] * currentGain[1]);
+		}
+
+		// --- steady part
+		const double gainLeft = currentGain[0];
+		const double gainRight = currentGain[1];
+		for (; n < blockSize; n++)
+		{
+			busLeft[n] += busGain * (inputLeft[n] * gainLeft);
+			busRight[n] += busGain * (inputRight[n] * gainRight);
+		}
+	}
+
 	// --- access to modulators
 	// --- get our modulators
 	virtual std::shared_ptr<ModInputData> getModulators() {
@@ -123,6 +164,34 @@ protected:
 	// --- pan value is set internally by voice, or via MIDI/MIDI Channel
 	double panValue = 0.0;			///< pan value is set internally by voice, or via MIDI/MIDI Channel
 
+	// --- smoothed channel gains: gainRaw * pan, ramped between updates
+	double currentGain[2] = { 0.0 };
+	double targetGain[2] = { 0.0 };
+	double gainInc[2] = { 0.0 };
+	uint32_t rampCounter = 0;
+	uint32_t gainRampLength = 1;
+
+	// --- set up the ramp from the current gains to the new targets
+	inline void setGainTargets(double leftGain, double rightGain)
+	{
+		targetGain[0] = leftGain;
+		targetGain[1] = rightGain;
+		for (int i = 0; i < 2; i++)
+			gainInc[i] = (targetGain[i] - currentGain[i]) / (double)gainRampLength;
+		rampCounter = gainRampLength;
+	}
+
+	// --- one step of the ramp; lands exactly on the targets
+	inline void advanceGainRamp()
+	{
+		if (rampCounter == 0)
+			return;
+
+		rampCounter--;
+		for (int i = 0; i < 2; i++)
+			currentGain[i] = rampCounter == 0 ? targetGain[i] : currentGain[i] + gainInc[i];
+	}
+
 	// --- note on flag
 	bool noteOn = false;
 };
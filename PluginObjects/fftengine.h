@@ -0,0 +1,527 @@
+#ifndef __fftEngine_h__
+#define __fftEngine_h__
+
+// --- includes
+#include <stdint.h>
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "guiconstants.h"
+
+// --- FFTW is an optional backend; define HAVE_FFTW in the project to use it
+#ifdef HAVE_FFTW
+#include "fftw3.h"
+#endif
+
+/**
+\brief complex value as { real, imaginary }; the same type as fftw_complex so FFT data can be
+handed to and from FFTW code without conversion
+*/
+typedef double fftComplex[2];
+
+/**
+\brief returns true if the value is a power of two (and not zero)
+*/
+inline bool isPowerOfTwo(uint32_t value)
+{
+	return value != 0 && (value & (value - 1)) == 0;
+}
+
+/**
+\class FFTPlan
+\ingroup FFTW-Objects
+\brief
+The tables (and optional FFTW plans) for one transform size N. Plans are immutable once built and
+are shared by every FFTEngine of that size through the FFTPlanCache.
+
+- complex FFT of size N: the bit-reverse permutation and, per radix-4 pass, the contiguous twiddles
+  W^k, W^2k and W^3k (cos and sin arrays) so the butterfly loops run unit-stride
+- real FFT of size N: the post-twiddles W_N^k, k = 0..N/4, that split the N/2 point complex FFT
+  into the N/2 + 1 bins of the real signal (the complex part comes from the N/2 plan)
+
+\author Will Pirkle
+\version Revision : 1.0
+\date Date : 2018 / 09 / 24
+*/
+class FFTPlan
+{
+public:
+	FFTPlan(uint32_t _size)
+	{
+		size = _size;
+		while ((1u << log2Size) < size)
+			log2Size++;
+
+		// --- bit reversal
+		bitReverse.assign(size, 0);
+		for (uint32_t i = 0; i < size; i++)
+		{
+			uint32_t r = 0;
+			for (uint32_t b = 0; b < log2Size; b++)
+				r |= ((i >> b) & 1) << (log2Size - 1 - b);
+			bitReverse[i] = r;
+		}
+
+		// --- radix-4 passes: an odd log2 size starts with one radix-2 pass, so the first
+		//     radix-4 pass combines blocks of 2; otherwise blocks of 1
+		uint32_t quarter = (log2Size & 1) ? 2 : 1;
+		for (; 4 * quarter <= size; quarter *= 4)
+		{
+			passOffset.push_back((uint32_t)passTwiddles.size());
+			passQuarter.push_back(quarter);
+
+			// --- [cos1 | sin1 | cos2 | sin2 | cos3 | sin3], quarter entries each
+			passTwiddles.resize(passTwiddles.size() + 6 * quarter);
+			double* tw = &passTwiddles[passOffset.back()];
+			for (uint32_t k = 0; k < quarter; k++)
+			{
+				for (uint32_t j = 1; j <= 3; j++)
+				{
+					double angle = kTwoPi*(double)(j*k) / (double)(4 * quarter);
+					tw[(2 * j - 2)*quarter + k] = cos(angle);
+					tw[(2 * j - 1)*quarter + k] = sin(angle);
+				}
+			}
+		}
+
+		// --- real post-twiddles
+		uint32_t numRealTwiddles = size / 4 + 1;
+		realCos.assign(numRealTwiddles, 0.0);
+		realSin.assign(numRealTwiddles, 0.0);
+		for (uint32_t k = 0; k < numRealTwiddles; k++)
+		{
+			realCos[k] = cos(kTwoPi*(double)k / (double)size);
+			realSin[k] = sin(kTwoPi*(double)k / (double)size);
+		}
+
+#ifdef HAVE_FFTW
+		// --- FFTW plans on split arrays; FFTW_UNALIGNED lets one plan run on any caller's buffers
+		//     NOTE: FFTW's planner is not thread-safe; the cache serializes our planning, so any other
+		//           FFTW user in the process must not plan concurrently
+		double* re = (double*)fftw_malloc(sizeof(double) * size);
+		double* im = (double*)fftw_malloc(sizeof(double) * size);
+		double* x = (double*)fftw_malloc(sizeof(double) * size);
+		fftw_iodim dim = { (int)size, 1, 1 };
+		const unsigned flags = FFTW_ESTIMATE | FFTW_UNALIGNED;
+
+		complexPlan = fftw_plan_guru_split_dft(1, &dim, 0, nullptr, re, im, re, im, flags);
+		realForwardPlan = fftw_plan_guru_split_dft_r2c(1, &dim, 0, nullptr, x, re, im, flags);
+		realInversePlan = fftw_plan_guru_split_dft_c2r(1, &dim, 0, nullptr, re, im, x, flags);
+
+		fftw_free(re);
+		fftw_free(im);
+		fftw_free(x);
+#endif
+	}
+
+	~FFTPlan()
+	{
+#ifdef HAVE_FFTW
+		if (complexPlan)
+			fftw_destroy_plan(complexPlan);
+		if (realForwardPlan)
+			fftw_destroy_plan(realForwardPlan);
+		if (realInversePlan)
+			fftw_destroy_plan(realInversePlan);
+#endif
+	}
+
+	uint32_t size = 0;
+	uint32_t log2Size = 0;
+
+	// --- complex tables
+	std::vector<uint32_t> bitReverse;
+	std::vector<double> passTwiddles;	///< all radix-4 passes, see passOffset
+	std::vector<uint32_t> passOffset;	///< start of each pass in passTwiddles
+	std::vector<uint32_t> passQuarter;	///< block size / 4 of each pass
+
+	// --- real post-twiddles
+	std::vector<double> realCos;
+	std::vector<double> realSin;
+
+#ifdef HAVE_FFTW
+	fftw_plan complexPlan = nullptr;
+	fftw_plan realForwardPlan = nullptr;
+	fftw_plan realInversePlan = nullptr;
+#endif
+
+private:
+	// --- no copies; owners share it through the cache
+	FFTPlan(const FFTPlan&);
+	FFTPlan& operator=(const FFTPlan&);
+};
+
+/**
+\class FFTPlanCache
+\ingroup FFTW-Objects
+\brief
+Process-wide cache of FFTPlans keyed by size. The cache holds weak references: a plan lives as long
+as one FFTEngine uses it, and all engines of the same size share one set of tables.
+
+- getPlan( ) locks and may build a plan; call it from initialization code, not the audio thread
+
+\author Will Pirkle
+\version Revision : 1.0
+\date Date : 2018 / 09 / 24
+*/
+class FFTPlanCache
+{
+public:
+	/** get (or build) the plan for a power-of-two size; nullptr for other sizes */
+	static std::shared_ptr<const FFTPlan> getPlan(uint32_t size)
+	{
+		if (!isPowerOfTwo(size))
+			return nullptr;
+
+		static std::mutex cacheMutex;
+		static std::map<uint32_t, std::weak_ptr<const FFTPlan>> cache;
+
+		std::lock_guard<std::mutex> lock(cacheMutex);
+		std::shared_ptr<const FFTPlan> plan = cache[size].lock();
+		if (!plan)
+		{
+			plan = std::make_shared<const FFTPlan>(size);
+			cache[size] = plan;
+		}
+		return plan;
+	}
+};
+
+/**
+\class FFTEngine
+\ingroup FFTW-Objects
+\brief
+Power-of-two FFTs for the FFT objects: a built-in radix-2/4 complex FFT and a split real FFT
+(N/2 point complex FFT plus post-twiddle), or FFTW when HAVE_FFTW is defined.
+
+Conventions (the same as FFTW):
+- forward uses e^(-j2pi kn/N); neither direction is scaled, so inverse(forward(x)) = N*x
+- real transforms take N samples and N/2 + 1 bins; the imaginary parts of bins 0 and N/2 are zero
+- the split (re, im) forms are the native ones; the fftComplex forms interleave on the way in and out
+
+The engine owns only its scratch memory; the tables come from the shared FFTPlanCache.
+
+\author Will Pirkle
+\version Revision : 1.0
+\date Date : 2018 / 09 / 24
+*/
+class FFTEngine
+{
+public:
+	FFTEngine() { }
+	~FFTEngine() { }
+
+	/** setup for a power-of-two size (>= 2); allocates unless reserve( ) covered the size, call off the audio thread */
+	bool initialize(uint32_t _size)
+	{
+		if (!isPowerOfTwo(_size) || _size < 2)
+			return false;
+
+		if (plan && size == _size)
+			return true;
+
+		size = _size;
+
+		// --- reserved sizes come without the cache lock (see reserve( ))
+		uint32_t log2Size = 0;
+		while ((1u << log2Size) < size)
+			log2Size++;
+
+		if (log2Size < reservedPlans.size())
+		{
+			plan = reservedPlans[log2Size];
+			halfPlan = reservedPlans[log2Size - 1];
+		}
+		else
+		{
+			plan = FFTPlanCache::getPlan(size);
+			halfPlan = FFTPlanCache::getPlan(size / 2);
+		}
+		scratchReal.assign(size, 0.0);
+		scratchImag.assign(size, 0.0);
+		splitReal.assign(size / 2 + 1, 0.0);
+		splitImag.assign(size / 2 + 1, 0.0);
+		return plan != nullptr && halfPlan != nullptr;
+	}
+
+	/** hold the plans of every power-of-two size up to maxSize and size the scratch for it, so that a later
+	    initialize( ) with a size up to maxSize neither locks nor allocates; call off the audio thread */
+	bool reserve(uint32_t maxSize)
+	{
+		if (!isPowerOfTwo(maxSize) || maxSize < 2)
+			return false;
+
+		reservedPlans.clear();
+		for (uint32_t planSize = 1; planSize <= maxSize; planSize *= 2)
+			reservedPlans.push_back(FFTPlanCache::getPlan(planSize));
+
+		scratchReal.reserve(maxSize);
+		scratchImag.reserve(maxSize);
+		splitReal.reserve(maxSize / 2 + 1);
+		splitImag.reserve(maxSize / 2 + 1);
+		return true;
+	}
+
+	uint32_t getSize() { return size; }
+
+	/** in-place complex FFT, split form */
+	void forward(double* re, double* im)
+	{
+#ifdef HAVE_FFTW
+		fftw_execute_split_dft(plan->complexPlan, re, im, re, im);
+#else
+		complexTransform(*plan, re, im);
+#endif
+	}
+
+	/** in-place complex IFFT (unscaled), split form */
+	void inverse(double* re, double* im)
+	{
+		// --- swapping the real and imaginary parts turns the forward transform into the inverse
+#ifdef HAVE_FFTW
+		fftw_execute_split_dft(plan->complexPlan, im, re, im, re);
+#else
+		complexTransform(*plan, im, re);
+#endif
+	}
+
+	/** in-place complex FFT of size N */
+	void forward(fftComplex* data)
+	{
+		deinterleave(data, size);
+		forward(&scratchReal[0], &scratchImag[0]);
+		interleave(data, size);
+	}
+
+	/** in-place complex IFFT (unscaled) of size N */
+	void inverse(fftComplex* data)
+	{
+		deinterleave(data, size);
+		inverse(&scratchReal[0], &scratchImag[0]);
+		interleave(data, size);
+	}
+
+	/** real FFT: N samples in, N/2 + 1 bins out in split form */
+	void forwardReal(const double* input, double* re, double* im)
+	{
+#ifdef HAVE_FFTW
+		fftw_execute_split_dft_r2c(plan->realForwardPlan, const_cast<double*>(input), re, im);
+#else
+		const uint32_t half = size / 2;
+
+		// --- pack even samples as real, odd samples as imaginary and do the N/2 FFT
+		for (uint32_t n = 0; n < half; n++)
+		{
+			re[n] = input[2 * n];
+			im[n] = input[2 * n + 1];
+		}
+		complexTransform(*halfPlan, re, im);
+
+		// --- split: X[k] = E[k] + W^k O[k] with E, O from Z[k] and conj(Z[N/2 - k])
+		double z0 = re[0];
+		re[0] = z0 + im[0];
+		re[half] = z0 - im[0];
+		im[0] = 0.0;
+		im[half] = 0.0;
+
+		const double* wc = &plan->realCos[0];
+		const double* ws = &plan->realSin[0];
+		for (uint32_t k = 1; k <= half / 2; k++)
+		{
+			uint32_t j = half - k;
+			double evenReal = 0.5*(re[k] + re[j]);
+			double evenImag = 0.5*(im[k] - im[j]);
+			double oddReal = 0.5*(im[k] + im[j]);
+			double oddImag = -0.5*(re[k] - re[j]);
+
+			double tr = wc[k] * oddReal + ws[k] * oddImag;
+			double ti = wc[k] * oddImag - ws[k] * oddReal;
+
+			re[k] = evenReal + tr;
+			im[k] = evenImag + ti;
+			re[j] = evenReal - tr;
+			im[j] = ti - evenImag;
+		}
+#endif
+	}
+
+	/** real IFFT (unscaled): N/2 + 1 bins in split form, N samples out; the bins are not modified */
+	void inverseReal(const double* re, const double* im, double* output)
+	{
+		const uint32_t half = size / 2;
+
+#ifdef HAVE_FFTW
+		// --- c2r destroys its input
+		memcpy(&scratchReal[0], re, (half + 1) * sizeof(double));
+		memcpy(&scratchImag[0], im, (half + 1) * sizeof(double));
+		fftw_execute_split_dft_c2r(plan->realInversePlan, &scratchReal[0], &scratchImag[0], output);
+#else
+		// --- unsplit into Z[k] = E[k] + jO[k], both sides of each pair at once
+		double* zr = &scratchReal[0];
+		double* zi = &scratchImag[0];
+		zr[0] = re[0] + re[half];
+		zi[0] = re[0] - re[half];
+
+		const double* wc = &plan->realCos[0];
+		const double* ws = &plan->realSin[0];
+		for (uint32_t k = 1; k <= half / 2; k++)
+		{
+			uint32_t j = half - k;
+			double evenReal = re[k] + re[j];
+			double evenImag = im[k] - im[j];
+			double diffReal = re[k] - re[j];
+			double diffImag = im[k] + im[j];
+
+			// --- O = (X[k] - conj(X[N/2 - k])) * conj(W^k)
+			double oddReal = diffReal*wc[k] - diffImag*ws[k];
+			double oddImag = diffReal*ws[k] + diffImag*wc[k];
+
+			zr[k] = evenReal - oddImag;
+			zi[k] = evenImag + oddReal;
+			zr[j] = evenReal + oddImag;
+			zi[j] = oddReal - evenImag;
+		}
+
+		complexTransform(*halfPlan, zi, zr);
+
+		for (uint32_t n = 0; n < half; n++)
+		{
+			output[2 * n] = zr[n];
+			output[2 * n + 1] = zi[n];
+		}
+#endif
+	}
+
+	/** real FFT: N samples in, N/2 + 1 bins out */
+	void forwardReal(const double* input, fftComplex* output)
+	{
+		forwardReal(input, &scratchReal[0], &scratchImag[0]);
+		interleave(output, size / 2 + 1);
+	}
+
+	/** real IFFT (unscaled): N/2 + 1 bins in, N samples out */
+	void inverseReal(const fftComplex* input, double* output)
+	{
+		for (uint32_t k = 0; k <= size / 2; k++)
+		{
+			splitReal[k] = input[k][0];
+			splitImag[k] = input[k][1];
+		}
+		inverseReal(&splitReal[0], &splitImag[0], output);
+	}
+
+protected:
+	uint32_t size = 0;
+	std::shared_ptr<const FFTPlan> plan = nullptr;		///< size N
+	std::shared_ptr<const FFTPlan> halfPlan = nullptr;	///< size N/2, for the real transforms
+	std::vector<std::shared_ptr<const FFTPlan>> reservedPlans;	///< [log2(N)], see reserve( )
+
+	// --- scratch: split form of interleaved data, and the unsplit spectrum of the real IFFT
+	std::vector<double> scratchReal;
+	std::vector<double> scratchImag;
+	std::vector<double> splitReal;
+	std::vector<double> splitImag;
+
+	void deinterleave(const fftComplex* data, uint32_t count)
+	{
+		for (uint32_t i = 0; i < count; i++)
+		{
+			scratchReal[i] = data[i][0];
+			scratchImag[i] = data[i][1];
+		}
+	}
+
+	void interleave(fftComplex* data, uint32_t count)
+	{
+		for (uint32_t i = 0; i < count; i++)
+		{
+			data[i][0] = scratchReal[i];
+			data[i][1] = scratchImag[i];
+		}
+	}
+
+	// --- built-in in-place forward complex FFT: bit reversal, one radix-2 pass for odd log2 sizes,
+	//     then radix-4 passes; every inner loop runs unit-stride over a quarter block so it vectorizes
+	static void complexTransform(const FFTPlan& fftPlan, double* re, double* im)
+	{
+		const uint32_t n = fftPlan.size;
+		const uint32_t* bitReverse = &fftPlan.bitReverse[0];
+		for (uint32_t i = 0; i < n; i++)
+		{
+			uint32_t j = bitReverse[i];
+			if (j > i)
+			{
+				std::swap(re[i], re[j]);
+				std::swap(im[i], im[j]);
+			}
+		}
+
+		if (fftPlan.log2Size & 1)
+		{
+			for (uint32_t i = 0; i < n; i += 2)
+			{
+				double ar = re[i], ai = im[i];
+				re[i] = ar + re[i + 1];
+				im[i] = ai + im[i + 1];
+				re[i + 1] = ar - re[i + 1];
+				im[i + 1] = ai - im[i + 1];
+			}
+		}
+
+		// --- after bit reversal the four quarters of a block hold the sub-FFTs of the
+		//     samples 0, 2, 1, 3 (mod 4); twiddle them and combine with a 4 point DFT
+		for (uint32_t pass = 0; pass < fftPlan.passQuarter.size(); pass++)
+		{
+			const uint32_t m = fftPlan.passQuarter[pass];
+			const double* c1 = &fftPlan.passTwiddles[fftPlan.passOffset[pass]];
+			const double* s1 = c1 + m;
+			const double* c2 = s1 + m;
+			const double* s2 = c2 + m;
+			const double* c3 = s2 + m;
+			const double* s3 = c3 + m;
+
+			for (uint32_t start = 0; start < n; start += 4 * m)
+			{
+				double* ar = &re[start];
+				double* ai = &im[start];
+				double* br = ar + m;
+				double* bi = ai + m;
+				double* cr = br + m;
+				double* ci = bi + m;
+				double* dr = cr + m;
+				double* di = ci + m;
+
+				for (uint32_t k = 0; k < m; k++)
+				{
+					// --- W^k = cos - jsin
+					double xbr = br[k] * c2[k] + bi[k] * s2[k];
+					double xbi = bi[k] * c2[k] - br[k] * s2[k];
+					double xcr = cr[k] * c1[k] + ci[k] * s1[k];
+					double xci = ci[k] * c1[k] - cr[k] * s1[k];
+					double xdr = dr[k] * c3[k] + di[k] * s3[k];
+					double xdi = di[k] * c3[k] - dr[k] * s3[k];
+
+					double t0r = ar[k] + xbr, t0i = ai[k] + xbi;
+					double t1r = ar[k] - xbr, t1i = ai[k] - xbi;
+					double t2r = xcr + xdr, t2i = xci + xdi;
+					double t3r = xcr - xdr, t3i = xci - xdi;
+
+					ar[k] = t0r + t2r;
+					ai[k] = t0i + t2i;
+					cr[k] = t0r - t2r;
+					ci[k] = t0i - t2i;
+					br[k] = t1r + t3i;
+					bi[k] = t1i - t3r;
+					dr[k] = t1r - t3i;
+					di[k] = t1i + t3r;
+				}
+			}
+		}
+	}
+};
+
+#endif /* defined(__fftEngine_h__) */
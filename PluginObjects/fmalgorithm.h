@@ -0,0 +1,313 @@
+#ifndef __fmAlgorithm_h__
+#define __fmAlgorithm_h__
+
+// --- includes
+#include "synthdefs.h"
+#include "synthoscillator.h"
+
+// --- osc1..osc4 are the operators
+const uint32_t NUM_FM_OPERATORS = 4;
+
+/**
+\enum fmAlgorithm
+\ingroup SynthDefs
+\brief Operator routings; "a -> b" means a phase-modulates b, op4 has self-feedback in all fixed algorithms
+
+ - kOff : normal vector-mixed oscillators
+
+ - kAlgorithm1 : 4 -> 3 -> 2 -> 1
+
+ - kAlgorithm2 : (3 + 4) -> 2 -> 1
+
+ - kAlgorithm3 : (4 + (3 -> 2)) -> 1
+
+ - kAlgorithm4 : ((4 -> 3) + 2) -> 1
+
+ - kAlgorithm5 : 2 -> 1, 4 -> 3; carriers 1, 3
+
+ - kAlgorithm6 : 4 -> (1, 2, 3); carriers 1, 2, 3
+
+ - kAlgorithm7 : 4 -> 3; carriers 1, 2, 3
+
+ - kAlgorithm8 : all carriers (additive)
+
+ - kCustom : FMAlgorithmParameters::customModIndex and customCarrier
+*/
+enum class fmAlgorithm { kOff, kAlgorithm1, kAlgorithm2, kAlgorithm3, kAlgorithm4, kAlgorithm5, kAlgorithm6, kAlgorithm7, kAlgorithm8, kCustom };
+
+/**
+\struct FMAlgorithmParameters
+\ingroup SynthStructures
+\brief Parameters for the FM operator matrix
+
+- modulationIndex : peak phase deviation in radians for a full-scale modulator, applied to every edge of a fixed algorithm
+- feedback : op4 self-feedback index (radians), fixed algorithms only
+- customModIndex[dst][src] : per-edge index for kCustom; the diagonal is self-feedback
+*/
+struct FMAlgorithmParameters
+{
+	FMAlgorithmParameters() {}
+	FMAlgorithmParameters& operator=(const FMAlgorithmParameters& params)	// need this override for collections to work
+	{
+		if (this == &params)
+			return *this;
+
+		algorithm = params.algorithm;
+		modulationIndex = params.modulationIndex;
+		feedback = params.feedback;
+		memcpy(&customModIndex[0][0], &params.customModIndex[0][0], NUM_FM_OPERATORS * NUM_FM_OPERATORS * sizeof(double));
+		memcpy(&customCarrier[0], &params.customCarrier[0], NUM_FM_OPERATORS * sizeof(bool));
+		return *this;
+	}
+
+	bool operator==(const FMAlgorithmParameters& params) const
+	{
+		return algorithm == params.algorithm &&
+			modulationIndex == params.modulationIndex &&
+			feedback == params.feedback &&
+			memcmp(&customModIndex[0][0], &params.customModIndex[0][0], NUM_FM_OPERATORS * NUM_FM_OPERATORS * sizeof(double)) == 0 &&
+			memcmp(&customCarrier[0], &params.customCarrier[0], NUM_FM_OPERATORS * sizeof(bool)) == 0;
+	}
+
+	// --- individual parameters
+	fmAlgorithm algorithm = fmAlgorithm::kOff;
+	double modulationIndex = 1.0;
+	double feedback = 0.0;
+	double customModIndex[NUM_FM_OPERATORS][NUM_FM_OPERATORS] = { { 0.0 } };
+	bool customCarrier[NUM_FM_OPERATORS] = { true, false, false, false };
+};
+
+/**
+\class FMOperatorMatrix
+\ingroup SynthClasses
+\brief Audio-rate phase modulation between the four voice oscillators.
+
+The routing is compiled once per parameter change into:
+- a render order (topological sort of the modulation edges, self-feedback excluded)
+- a depth matrix in cycles (index / 2pi) so the oscillator's kPhaseMod input can take it directly
+- a flag per edge: modulators rendered earlier in this sample are read directly, anything else
+  (cycles in a custom matrix) reads the previous sample
+
+Self-feedback uses the average of the last two outputs, which keeps high feedback from buzzing.
+The per-sample loop then touches only the oscillators and this small matrix - no mod matrix.
+
+\author Will Pirkle
+\version Revision : 1.0
+\date Date : 2018 / 09 / 24
+*/
+class FMOperatorMatrix
+{
+public:
+	FMOperatorMatrix() { }
+	~FMOperatorMatrix() { }
+
+	// --- the operators; caches their phase modulation inputs
+	void setOperators(SynthOsc* osc1, SynthOsc* osc2, SynthOsc* osc3, SynthOsc* osc4)
+	{
+		SynthOsc* ops[NUM_FM_OPERATORS] = { osc1, osc2, osc3, osc4 };
+		for (uint32_t i = 0; i < NUM_FM_OPERATORS; i++)
+		{
+			operators[i] = ops[i];
+			phaseModInput[i] = &(ops[i]->getModulators()->modulationInputs[kPhaseMod]);
+		}
+	}
+
+	// --- clear the output history
+	void reset()
+	{
+		memset(&output[0], 0, NUM_FM_OPERATORS * sizeof(double));
+		memset(&lastOutput[0], 0, NUM_FM_OPERATORS * sizeof(double));
+		memset(&lastOutput2[0], 0, NUM_FM_OPERATORS * sizeof(double));
+	}
+
+	// --- recompile if the routing changed; call at control rate
+	void setParameters(const FMAlgorithmParameters& params)
+	{
+		if (compiled && params == parameters)
+			return;
+
+		bool wasEnabled = isEnabled();
+		parameters = params;
+		compileAlgorithm();
+
+		// --- hand the phase modulation inputs back at zero
+		if (wasEnabled && !isEnabled())
+		{
+			for (uint32_t i = 0; i < NUM_FM_OPERATORS; i++)
+			{
+				if (phaseModInput[i])
+					*phaseModInput[i] = 0.0;
+			}
+		}
+	}
+
+	bool isEnabled() { return parameters.algorithm != fmAlgorithm::kOff; }
+
+	// --- render all four operators in dependency order, return the carrier mix
+	inline double renderAudioOutput()
+	{
+		for (uint32_t k = 0; k < NUM_FM_OPERATORS; k++)
+		{
+			uint32_t op = renderOrder[k];
+
+			// --- sum the modulators; 'output' holds this sample for already-rendered operators
+			//     and the last sample for the rest (see compileAlgorithm)
+			double phaseMod = feedbackDepth[op] * 0.5*(lastOutput[op] + lastOutput2[op]);
+			for (uint32_t src = 0; src < NUM_FM_OPERATORS; src++)
+				phaseMod += modDepth[op][src] * output[src];
+
+			*phaseModInput[op] = phaseMod;
+			output[op] = operators[op]->renderAudioOutput().outputs[0];
+		}
+
+		double carrierSum = 0.0;
+		for (uint32_t i = 0; i < NUM_FM_OPERATORS; i++)
+		{
+			carrierSum += carrierGain[i] * output[i];
+			lastOutput2[i] = lastOutput[i];
+			lastOutput[i] = output[i];
+		}
+
+		return carrierSum;
+	}
+
+	// --- operator outputs from the last render, for use as mod sources
+	double getOperatorOutput(uint32_t op) { return op < NUM_FM_OPERATORS ? output[op] : 0.0; }
+
+protected:
+	FMAlgorithmParameters parameters;
+	bool compiled = false;
+
+	SynthOsc* operators[NUM_FM_OPERATORS] = { nullptr };
+	double* phaseModInput[NUM_FM_OPERATORS] = { nullptr };
+
+	// --- compiled routing
+	uint32_t renderOrder[NUM_FM_OPERATORS] = { 0, 1, 2, 3 };
+	double modDepth[NUM_FM_OPERATORS][NUM_FM_OPERATORS] = { { 0.0 } };	///< [dst][src], cycles
+	double feedbackDepth[NUM_FM_OPERATORS] = { 0.0 };						///< cycles
+	double carrierGain[NUM_FM_OPERATORS] = { 0.0 };
+
+	// --- operator outputs: current (or last, until rendered), and the two before for feedback
+	double output[NUM_FM_OPERATORS] = { 0.0 };
+	double lastOutput[NUM_FM_OPERATORS] = { 0.0 };
+	double lastOutput2[NUM_FM_OPERATORS] = { 0.0 };
+
+	// --- build the depth matrix, carriers and render order
+	void compileAlgorithm()
+	{
+		double index[NUM_FM_OPERATORS][NUM_FM_OPERATORS] = { { 0.0 } };
+		bool carrier[NUM_FM_OPERATORS] = { false };
+
+		// --- ops are 0-based here: op1 = 0 ... op4 = 3
+		const double I = parameters.modulationIndex;
+		switch (parameters.algorithm)
+		{
+		case fmAlgorithm::kAlgorithm1:
+			index[2][3] = I; index[1][2] = I; index[0][1] = I;
+			carrier[0] = true;
+			break;
+		case fmAlgorithm::kAlgorithm2:
+			index[1][2] = I; index[1][3] = I; index[0][1] = I;
+			carrier[0] = true;
+			break;
+		case fmAlgorithm::kAlgorithm3:
+			index[1][2] = I; index[0][1] = I; index[0][3] = I;
+			carrier[0] = true;
+			break;
+		case fmAlgorithm::kAlgorithm4:
+			index[2][3] = I; index[0][2] = I; index[0][1] = I;
+			carrier[0] = true;
+			break;
+		case fmAlgorithm::kAlgorithm5:
+			index[0][1] = I; index[2][3] = I;
+			carrier[0] = carrier[2] = true;
+			break;
+		case fmAlgorithm::kAlgorithm6:
+			index[0][3] = I; index[1][3] = I; index[2][3] = I;
+			carrier[0] = carrier[1] = carrier[2] = true;
+			break;
+		case fmAlgorithm::kAlgorithm7:
+			index[2][3] = I;
+			carrier[0] = carrier[1] = carrier[2] = true;
+			break;
+		case fmAlgorithm::kAlgorithm8:
+			carrier[0] = carrier[1] = carrier[2] = carrier[3] = true;
+			break;
+		case fmAlgorithm::kCustom:
+			memcpy(&index[0][0], &parameters.customModIndex[0][0], NUM_FM_OPERATORS * NUM_FM_OPERATORS * sizeof(double));
+			memcpy(&carrier[0], &parameters.customCarrier[0], NUM_FM_OPERATORS * sizeof(bool));
+			break;
+		default:
+			break;
+		}
+
+		if (parameters.algorithm != fmAlgorithm::kCustom && parameters.algorithm != fmAlgorithm::kOff)
+			index[3][3] = parameters.feedback;
+
+		// --- split off the self-feedback; radians -> cycles
+		for (uint32_t dst = 0; dst < NUM_FM_OPERATORS; dst++)
+		{
+			feedbackDepth[dst] = index[dst][dst] / kTwoPi;
+			index[dst][dst] = 0.0;
+		}
+
+		// --- topological order (Kahn); anything left in a cycle goes last in index order
+		bool placed[NUM_FM_OPERATORS] = { false };
+		uint32_t count = 0;
+		while (count < NUM_FM_OPERATORS)
+		{
+			bool progress = false;
+			for (uint32_t op = 0; op < NUM_FM_OPERATORS; op++)
+			{
+				if (placed[op])
+					continue;
+
+				bool ready = true;
+				for (uint32_t src = 0; src < NUM_FM_OPERATORS; src++)
+				{
+					if (index[op][src] != 0.0 && !placed[src])
+						ready = false;
+				}
+
+				if (ready)
+				{
+					renderOrder[count++] = op;
+					placed[op] = progress = true;
+				}
+			}
+
+			// --- cycle: break it at the lowest unplaced operator
+			if (!progress)
+			{
+				for (uint32_t op = 0; op < NUM_FM_OPERATORS; op++)
+				{
+					if (!placed[op])
+					{
+						renderOrder[count++] = op;
+						placed[op] = true;
+						break;
+					}
+				}
+			}
+		}
+
+		// --- depths in cycles; an edge whose source renders later reads the previous sample,
+		//     which is what 'output' still holds at that point in the loop
+		uint32_t numCarriers = 0;
+		for (uint32_t dst = 0; dst < NUM_FM_OPERATORS; dst++)
+		{
+			for (uint32_t src = 0; src < NUM_FM_OPERATORS; src++)
+				modDepth[dst][src] = index[dst][src] / kTwoPi;
+
+			if (carrier[dst])
+				numCarriers++;
+		}
+
+		for (uint32_t i = 0; i < NUM_FM_OPERATORS; i++)
+			carrierGain[i] = carrier[i] ? 1.0 / (double)numCarriers : 0.0;
+
+		compiled = true;
+	}
+};
+
+#endif /* defined(__fmAlgorithm_h__) */
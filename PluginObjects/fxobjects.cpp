@@ -149,6 +149,92 @@ double Biquad::processAudioSample(double xn)
 	return xn; // didn't process anything :(
 }
 
+/**
+\brief process a block through the biquad; same math as processAudioSample( ) with the structure decoded
+once and the coefficients and states held in locals for the whole block
+
+\param input input samples
+\param output output samples; may be the same buffer as input
+\param blockSize number of samples
+*/
+void Biquad::processAudioBlock(const float* input, float* output, uint32_t blockSize)
+{
+	const double A0 = coeffArray[a0];
+	const double A1 = coeffArray[a1];
+	const double A2 = coeffArray[a2];
+	const double B1 = coeffArray[b1];
+	const double B2 = coeffArray[b2];
+
+	double xz1 = stateArray[x_z1];
+	double xz2 = stateArray[x_z2];
+	double yz1 = stateArray[y_z1];
+	double yz2 = stateArray[y_z2];
+
+	if (parameters.biquadCalcType == biquadAlgorithm::kDirect)
+	{
+		for (uint32_t i = 0; i < blockSize; i++)
+		{
+			double xn = input[i];
+			double yn = A0 * xn + A1 * xz1 + A2 * xz2 - B1 * yz1 - B2 * yz2;
+			checkFloatUnderflow(yn);
+
+			xz2 = xz1;
+			xz1 = xn;
+			yz2 = yz1;
+			yz1 = yn;
+			output[i] = (float)yn;
+		}
+	}
+	else if (parameters.biquadCalcType == biquadAlgorithm::kCanonical)
+	{
+		for (uint32_t i = 0; i < blockSize; i++)
+		{
+			double wn = input[i] - B1 * xz1 - B2 * xz2;
+			double yn = A0 * wn + A1 * xz1 + A2 * xz2;
+			checkFloatUnderflow(yn);
+
+			xz2 = xz1;
+			xz1 = wn;
+			output[i] = (float)yn;
+		}
+	}
+	else if (parameters.biquadCalcType == biquadAlgorithm::kTransposeDirect)
+	{
+		for (uint32_t i = 0; i < blockSize; i++)
+		{
+			double wn = input[i] + yz1;
+			double yn = A0 * wn + xz1;
+			checkFloatUnderflow(yn);
+
+			yz1 = yz2 - B1 * wn;
+			yz2 = -B2 * wn;
+			xz1 = xz2 + A1 * wn;
+			xz2 = A2 * wn;
+			output[i] = (float)yn;
+		}
+	}
+	else if (parameters.biquadCalcType == biquadAlgorithm::kTransposeCanonical)
+	{
+		for (uint32_t i = 0; i < blockSize; i++)
+		{
+			double xn = input[i];
+			double yn = A0 * xn + xz1;
+			checkFloatUnderflow(yn);
+
+			xz1 = A1 * xn - B1 * yn + xz2;
+			xz2 = A2 * xn - B2 * yn;
+			output[i] = (float)yn;
+		}
+	}
+	else if (input != output)
+		memcpy(output, input, blockSize * sizeof(float)); // didn't process anything :(
+
+	stateArray[x_z1] = xz1;
+	stateArray[x_z2] = xz2;
+	stateArray[y_z1] = yz1;
+	stateArray[y_z2] = yz2;
+}
+
 // --- returns true if coeffs were updated
 bool AudioFilter::calculateFilterCoeffs()
 {
@@ -949,6 +1035,32 @@ double AudioFilter::processAudioSample(double xn)
 	return coeffArray[d0] * xn + coeffArray[c0] * biquad.processAudioSample(xn);
 }
 
+/**
+\brief process a block through the filter; the pure filter case (c0 = 1, d0 = 0) runs the biquad block
+directly, the rest mix per sample with a non-virtual biquad call
+
+\param input input samples
+\param output output samples; may be the same buffer as input
+\param blockSize number of samples
+*/
+void AudioFilter::processAudioBlock(const float* input, float* output, uint32_t blockSize)
+{
+	const double C0 = coeffArray[c0];
+	const double D0 = coeffArray[d0];
+
+	if (C0 == 1.0 && D0 == 0.0)
+	{
+		biquad.processAudioBlock(input, output, blockSize);
+		return;
+	}
+
+	for (uint32_t i = 0; i < blockSize; i++)
+	{
+		double xn = input[i];
+		output[i] = (float)(D0 * xn + C0 * biquad.Biquad::processAudioSample(xn));
+	}
+}
+
 /**
 \brief sets the new attack time and re-calculates the time constant
 
@@ -1042,30 +1154,65 @@ const SignalGenData LFO::renderAudioOutput()
 	return output;
 }
 
+/**
+\brief process a stereo block in place
+
+- NOTES:<br>
+The tank runs sample by sample over REVERB_BLOCK_SIZE sub-blocks (the branches of one sample are
+processed together, see processTank( )); the shelving filters (both channels together, see BiquadCascade)
+and the wet/dry mix are then separate passes over the sub-block.<br>
+
+\param left left channel, input and output
+\param right right channel, input and output
+\param blockSize number of samples
+*/
+void ReverbTank::processBlock(double* left, double* right, uint32_t blockSize)
+{
+	if (!delayMemory.get())
+		return;
+
+	double tankLeft[REVERB_BLOCK_SIZE];
+	double tankRight[REVERB_BLOCK_SIZE];
+
+	for (uint32_t offset = 0; offset < blockSize; offset += REVERB_BLOCK_SIZE)
+	{
+		uint32_t count = blockSize - offset < REVERB_BLOCK_SIZE ? blockSize - offset : REVERB_BLOCK_SIZE;
+		double* blockLeft = &left[offset];
+		double* blockRight = &right[offset];
+
+		// --- the tank, on the mono-ized input
+		for (uint32_t i = 0; i < count; i++)
+			processTank(0.5*blockLeft[i] + 0.5*blockRight[i], tankLeft[i], tankRight[i]);
+
+		// --- filter, both channels in one cascade
+		double* tank[NUM_CHANNELS] = { tankLeft, tankRight };
+		shelvingFilters.processBlock(tank, tank, count);
+
+		// --- sum with dry
+		for (uint32_t i = 0; i < count; i++)
+		{
+			blockLeft[i] = dryGain*blockLeft[i] + wetGain*tankLeft[i];
+			blockRight[i] = dryGain*blockRight[i] + wetGain*tankRight[i];
+		}
+	}
+}
 
-#ifdef HAVE_FFTW
 
 /**
-\brief destroys the FFTW arrays and plans.
+\brief destroys the FFT arrays.
 */
 void FastFFT::destroyFFTW()
 {
-#ifdef HAVE_FFTW
-	if (plan_forward)
-		fftw_destroy_plan(plan_forward);
-	if (plan_backward)
-		fftw_destroy_plan(plan_backward);
-
-	if (fft_input)
-		fftw_free(fft_input);
 	if (fft_result)
-		fftw_free(fft_result);
-
-	if (ifft_input)
-		fftw_free(ifft_input);
+		delete[] fft_result;
 	if (ifft_result)
-		fftw_free(ifft_result);
-#endif
+		delete[] ifft_result;
+	if (ifft_real_result)
+		delete[] ifft_real_result;
+
+	fft_result = nullptr;
+	ifft_result = nullptr;
+	ifft_real_result = nullptr;
 }
 
 
@@ -1102,7 +1249,7 @@ void FastFFT::initialize(unsigned int _frameLength, windowType _window)
 	// --- WP: this is why denominators are (frameLength) rather than (frameLength - 1)
 	if (window == windowType::kRectWindow)
 	{
-		for (int n = 0; n < frameLength - 1; n++)
+		for (unsigned int n = 0; n < frameLength - 1; n++)
 		{
 			windowBuffer[n] = 1.0;
 			windowGainCorrection += windowBuffer[n];
@@ -1110,7 +1257,7 @@ void FastFFT::initialize(unsigned int _frameLength, windowType _window)
 	}
 	else if (window == windowType::kHammingWindow)
 	{
-		for (int n = 0; n < frameLength - 1; n++)
+		for (unsigned int n = 0; n < frameLength - 1; n++)
 		{
 			windowBuffer[n] = 0.54 - 0.46*cos((n*2.0*kPi) / (frameLength));
 			windowGainCorrection += windowBuffer[n];
@@ -1118,7 +1265,7 @@ void FastFFT::initialize(unsigned int _frameLength, windowType _window)
 	}
 	else if (window == windowType::kHannWindow)
 	{
-		for (int n = 0; n < frameLength; n++)
+		for (unsigned int n = 0; n < frameLength; n++)
 		{
 			windowBuffer[n] = 0.5 * (1 - cos((n*2.0*kPi) / (frameLength)));
 			windowGainCorrection += windowBuffer[n];
@@ -1126,7 +1273,7 @@ void FastFFT::initialize(unsigned int _frameLength, windowType _window)
 	}
 	else if (window == windowType::kBlackmanHarrisWindow)
 	{
-		for (int n = 0; n < frameLength; n++)
+		for (unsigned int n = 0; n < frameLength; n++)
 		{
 			windowBuffer[n] = (0.42323 - (0.49755*cos((n*2.0*kPi) / (frameLength))) + 0.07922*cos((2 * n*2.0*kPi) / (frameLength)));
 			windowGainCorrection += windowBuffer[n];
@@ -1134,7 +1281,7 @@ void FastFFT::initialize(unsigned int _frameLength, windowType _window)
 	}
 	else if (window == windowType::kNoWindow)
 	{
-		for (int n = 0; n < frameLength; n++)
+		for (unsigned int n = 0; n < frameLength; n++)
 		{
 			windowBuffer[n] = 1.0;
 			windowGainCorrection += windowBuffer[n];
@@ -1142,7 +1289,7 @@ void FastFFT::initialize(unsigned int _frameLength, windowType _window)
 	}
 	else // --- default to kNoWindow
 	{
-		for (int n = 0; n < frameLength; n++)
+		for (unsigned int n = 0; n < frameLength; n++)
 		{
 			windowBuffer[n] = 1.0;
 			windowGainCorrection += windowBuffer[n];
@@ -1153,14 +1300,12 @@ void FastFFT::initialize(unsigned int _frameLength, windowType _window)
 	windowGainCorrection = 1.0 / windowGainCorrection;
 
 	destroyFFTW();
-	fft_input = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * frameLength);
-	fft_result = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * frameLength);
-
-	ifft_input =  (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * frameLength);
-	ifft_result = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * frameLength);
+	fft_result = new fftComplex[frameLength];
+	ifft_result = new fftComplex[frameLength];
+	ifft_real_result = new double[frameLength];
 
-	plan_forward = fftw_plan_dft_1d(frameLength, fft_input, fft_result, FFTW_FORWARD, FFTW_ESTIMATE);
-	plan_backward = fftw_plan_dft_1d(frameLength, ifft_input, ifft_result, FFTW_BACKWARD, FFTW_ESTIMATE);
+	// --- the tables for this length are shared with every other FFT object of the same length
+	fftEngine.initialize(frameLength);
 }
 
 /**
@@ -1171,22 +1316,31 @@ void FastFFT::initialize(unsigned int _frameLength, windowType _window)
 \param inputReal an array of real valued points
 \param inputImag an array of imaginary valued points (will be 0 for audio which is real-valued)
 
-\returns a pointer to a fftw_complex array: a 2D array of real (column 0) and imaginary (column 1) parts
+\returns a pointer to a fftComplex array: a 2D array of real (column 0) and imaginary (column 1) parts
 */
-fftw_complex* FastFFT::doFFT(double* inputReal, double* inputImag)
+fftComplex* FastFFT::doFFT(double* inputReal, double* inputImag)
 {
-	// ------ load up the FFT input array
-	for (int i = 0; i < frameLength; i++)
+	// --- real input: half spectrum with the real FFT, the upper half is its mirror image
+	if (!inputImag)
 	{
-		fft_input[i][0] = inputReal[i];		// --- real
-		if (inputImag)
-			fft_input[i][1] = inputImag[i]; // --- imag
-		else
-			fft_input[i][1] = 0.0;
+		fftEngine.forwardReal(inputReal, fft_result);
+		for (unsigned int i = frameLength / 2 + 1; i < frameLength; i++)
+		{
+			fft_result[i][0] = fft_result[frameLength - i][0];
+			fft_result[i][1] = -fft_result[frameLength - i][1];
+		}
+		return fft_result;
 	}
 
-	// --- do the FFT
-	fftw_execute(plan_forward);
+	// ------ load up the FFT array
+	for (unsigned int i = 0; i < frameLength; i++)
+	{
+		fft_result[i][0] = inputReal[i];		// --- real
+		fft_result[i][1] = inputImag[i];		// --- imag
+	}
+
+	// --- do the FFT in place
+	fftEngine.forward(fft_result);
 
 	return fft_result;
 }
@@ -1199,42 +1353,75 @@ fftw_complex* FastFFT::doFFT(double* inputReal, double* inputImag)
 \param inputReal an array of real valued points
 \param inputImag an array of imaginary valued points (will be 0 for audio which is real-valued)
 
-\returns a pointer to a fftw_complex array: a 2D array of real (column 0) and imaginary (column 1) parts
+\returns a pointer to a fftComplex array: a 2D array of real (column 0) and imaginary (column 1) parts
 */
-fftw_complex* FastFFT::doInverseFFT(double* inputReal, double* inputImag)
+fftComplex* FastFFT::doInverseFFT(double* inputReal, double* inputImag)
 {
-	// ------ load up the iFFT input array
-	for (int i = 0; i < frameLength; i++)
+	// ------ load up the iFFT array
+	for (unsigned int i = 0; i < frameLength; i++)
 	{
-		ifft_input[i][0] = inputReal[i];		// --- real
+		ifft_result[i][0] = inputReal[i];		// --- real
 		if (inputImag)
-			ifft_input[i][1] = inputImag[i]; // --- imag
+			ifft_result[i][1] = inputImag[i]; // --- imag
 		else
-			ifft_input[i][1] = 0.0;
+			ifft_result[i][1] = 0.0;
 	}
 
-	// --- do the IFFT
-	fftw_execute(plan_backward);
+	// --- do the IFFT in place
+	fftEngine.inverse(ifft_result);
 
 	return ifft_result;
 }
 
 /**
-\brief destroys the FFTW arrays and plans.
+\brief perform the FFT operation on real data
+
+- NOTES:<br>
+The spectrum of real data is conjugate-symmetric, so only bins 0 to N/2 are computed and returned;
+this is about half the work of doFFT( ) with complex input.<br>
+
+\param input an array of real valued points
+
+\returns a pointer to a fftComplex array of getNumBins( ) = N/2 + 1 bins
 */
-void PhaseVocoder::destroyFFTW()
+fftComplex* FastFFT::doRealFFT(double* input)
 {
-	if (plan_forward)
-		fftw_destroy_plan(plan_forward);
-	if (plan_backward)
-		fftw_destroy_plan(plan_backward);
+	fftEngine.forwardReal(input, fft_result);
+	return fft_result;
+}
+
+/**
+\brief perform the IFFT operation on a half spectrum
 
+- NOTES:<br>
+The upper half of the spectrum is taken as the mirror image of the input, so the output is real.<br>
+Like doInverseFFT( ), the output is not scaled by 1/N.<br>
+
+\param input an array of getNumBins( ) = N/2 + 1 bins
+
+\returns a pointer to an array of N real valued points
+*/
+double* FastFFT::doInverseRealFFT(fftComplex* input)
+{
+	fftEngine.inverseReal(input, ifft_real_result);
+	return ifft_real_result;
+}
+
+/**
+\brief destroys the FFT arrays.
+*/
+void PhaseVocoder::destroyFFTW()
+{
 	if (fft_input)
-		fftw_free(fft_input);
+		delete[] fft_input;
 	if (fft_result)
-		fftw_free(fft_result);
+		delete[] fft_result;
 	if (ifft_result)
-		fftw_free(ifft_result);
+		delete[] ifft_result;
+
+	fft_input = nullptr;
+	fft_result = nullptr;
+	ifft_result = nullptr;
 }
 
 /**
@@ -1264,17 +1451,14 @@ void PhaseVocoder::initialize(unsigned int _frameLength, unsigned int _hopSize,
 	// --- SETUP BUFFERS ---- //
 	//     NOTE: input and output buffers are circular, others are linear
 	//
-	// --- input buffer, for processing the x(n) timeline
-	if (inputBuffer)
-		delete inputBuffer;
+	// --- buffers only grow; a reserved length is reused with no allocation
+	if (frameLength > frameCapacity)
+		allocateBuffers(frameLength);
 
-	inputBuffer = new double[frameLength];
+	// --- input buffer, for processing the x(n) timeline
 	memset(&inputBuffer[0], 0, frameLength * sizeof(double));
 
 	// --- output buffer, for processing the y(n) timeline and accumulating frames
-	if (outputBuffer)
-		delete outputBuffer;
-
 	// --- the output buffer is declared as 2x the normal frame size
 	//     to accomodate time-stretching/pitch shifting; you can increase the size
 	//     here; if so make sure to calculate the wrapMaskOut properly and everything
@@ -1282,15 +1466,10 @@ void PhaseVocoder::initialize(unsigned int _frameLength, unsigned int _hopSize,
 	//     (not sure why you would do this - and it will surely affect CPU performance)
 	//     NOTE: the length of the buffer is only to accomodate accumulations
 	//           it does not stretch time or change causality on its own
-	outputBuffer = new double[frameLength * 4];
 	memset(&outputBuffer[0], 0, (frameLength*4.0) * sizeof(double));
 	wrapMaskOut = (frameLength*4.0) - 1;
 
 	// --- fixed window buffer
-	if (windowBuffer)
-		delete windowBuffer;
-
-	windowBuffer = new double[frameLength];
 	memset(&windowBuffer[0], 0, frameLength * sizeof(double));
 
 	// --- this is from Reiss & McPherson's code
@@ -1303,7 +1482,7 @@ void PhaseVocoder::initialize(unsigned int _frameLength, unsigned int _hopSize,
 	// --- WP: this is why denominators are (frameLength) rather than (frameLength - 1)
 	if (window == windowType::kRectWindow)
 	{
-		for (int n = 0; n < frameLength - 1; n++)
+		for (unsigned int n = 0; n < frameLength - 1; n++)
 		{
 			windowBuffer[n] = 1.0;
 			windowHopCorrection += windowBuffer[n];
@@ -1311,7 +1490,7 @@ void PhaseVocoder::initialize(unsigned int _frameLength, unsigned int _hopSize,
 	}
 	else if (window == windowType::kHammingWindow)
 	{
-		for (int n = 0; n < frameLength - 1; n++)
+		for (unsigned int n = 0; n < frameLength - 1; n++)
 		{
 			windowBuffer[n] = 0.54 - 0.46*cos((n*2.0*kPi) / (frameLength));
 			windowHopCorrection += windowBuffer[n];
@@ -1319,7 +1498,7 @@ void PhaseVocoder::initialize(unsigned int _frameLength, unsigned int _hopSize,
 	}
 	else if (window == windowType::kHannWindow)
 	{
-		for (int n = 0; n < frameLength; n++)
+		for (unsigned int n = 0; n < frameLength; n++)
 		{
 			windowBuffer[n] = 0.5 * (1 - cos((n*2.0*kPi) / (frameLength)));
 			windowHopCorrection += windowBuffer[n];
@@ -1327,7 +1506,7 @@ void PhaseVocoder::initialize(unsigned int _frameLength, unsigned int _hopSize,
 	}
 	else if (window == windowType::kBlackmanHarrisWindow)
 	{
-		for (int n = 0; n < frameLength; n++)
+		for (unsigned int n = 0; n < frameLength; n++)
 		{
 			windowBuffer[n] = (0.42323 - (0.49755*cos((n*2.0*kPi) / (frameLength))) + 0.07922*cos((2 * n*2.0*kPi) / (frameLength)));
 			windowHopCorrection += windowBuffer[n];
@@ -1335,7 +1514,7 @@ void PhaseVocoder::initialize(unsigned int _frameLength, unsigned int _hopSize,
 	}
 	else if (window == windowType::kNoWindow)
 	{
-		for (int n = 0; n < frameLength; n++)
+		for (unsigned int n = 0; n < frameLength; n++)
 		{
 			windowBuffer[n] = 1.0;
 			windowHopCorrection += windowBuffer[n];
@@ -1343,7 +1522,7 @@ void PhaseVocoder::initialize(unsigned int _frameLength, unsigned int _hopSize,
 	}
 	else // --- default to kNoWindow
 	{
-		for (int n = 0; n < frameLength; n++)
+		for (unsigned int n = 0; n < frameLength; n++)
 		{
 			windowBuffer[n] = 1.0;
 			windowHopCorrection += windowBuffer[n];
@@ -1369,15 +1548,79 @@ void PhaseVocoder::initialize(unsigned int _frameLength, unsigned int _hopSize,
 	needInverseFFT = false;
 	needOverlapAdd = false;
 
-#ifdef HAVE_FFTW
+	// --- the tables for this length are shared with every other FFT object of the same length
+	fftEngine.initialize(frameLength);
+}
+
+/**
+\brief allocate the timelines, window and FFT arrays for frames up to a maximum length
+
+- NOTES:<br>
+Call off the audio thread; a later initialize( ) with a frame length up to maxFrameLength reuses these
+arrays, and the FFT tables for those lengths, without allocating.<br>
+
+\param maxFrameLength the largest FFT length - MUST be a power of 2
+*/
+void PhaseVocoder::reserve(unsigned int maxFrameLength)
+{
+	if (maxFrameLength > frameCapacity)
+		allocateBuffers(maxFrameLength);
+
+	fftEngine.reserve(maxFrameLength);
+}
+
+/**
+\brief (re)allocate every array for a frame length; initialize( ) clears them
+
+\param capacity the FFT length to allocate for
+*/
+void PhaseVocoder::allocateBuffers(unsigned int capacity)
+{
+	if (inputBuffer)
+		delete[] inputBuffer;
+	if (outputBuffer)
+		delete[] outputBuffer;
+	if (windowBuffer)
+		delete[] windowBuffer;
+
+	// --- the output buffer is 4x the frame, see initialize( )
+	inputBuffer = new double[capacity];
+	outputBuffer = new double[capacity * 4];
+	windowBuffer = new double[capacity];
+
+	// --- audio is real: r2c into the half spectrum, c2r back out
 	destroyFFTW();
-	fft_input = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * frameLength);
-	fft_result = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * frameLength);
-	ifft_result = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * frameLength);
+	fft_input = new double[capacity];
+	fft_result = new fftComplex[capacity / 2 + 1];
+	ifft_result = new double[capacity];
+
+	frameCapacity = capacity;
+}
+
+/**
+\brief clear the timelines and restart the frame
+
+- NOTES:<br>
+The frame length, hop size, window and FFT setup from initialize( ) are kept; nothing is allocated.<br>
+*/
+void PhaseVocoder::reset()
+{
+	if (inputBuffer)
+		memset(&inputBuffer[0], 0, frameLength * sizeof(double));
+	if (outputBuffer)
+		memset(&outputBuffer[0], 0, (wrapMaskOut + 1) * sizeof(double));
+
+	inputWriteIndex = 0;
+	inputReadIndex = 0;
+
+	outputWriteIndex = 0;
+	outputReadIndex = 0;
+
+	fftCounter = 0;
 
-	plan_forward = fftw_plan_dft_1d(frameLength, fft_input, fft_result, FFTW_FORWARD, FFTW_ESTIMATE);
-	plan_backward = fftw_plan_dft_1d(frameLength, fft_result, ifft_result, FFTW_BACKWARD, FFTW_ESTIMATE);
-#endif
+	// --- reset flags
+	needInverseFFT = false;
+	needOverlapAdd = false;
 }
 
 /**
@@ -1429,17 +1672,16 @@ bool PhaseVocoder::advanceAndCheckFFT()
 
 	// --- we have a FFT ready
 	// --- load up the input to the FFT
-	for (int i = 0; i < frameLength; i++)
+	for (unsigned int i = 0; i < frameLength; i++)
 	{
-		fft_input[i][0] = inputBuffer[inputReadIndex++] * windowBuffer[i];
-		fft_input[i][1] = 0.0; // use this if your data is complex valued
+		fft_input[i] = inputBuffer[inputReadIndex++] * windowBuffer[i];
 
 		// --- wrap if index > bufferlength - 1
 		inputReadIndex &= wrapMask;
 	}
 
-	// --- do the FFT
-	fftw_execute(plan_forward);
+	// --- do the real FFT: N/2 + 1 bins
+	fftEngine.forwardReal(fft_input, fft_result);
 
 	// --- in case user does not take IFFT, just to prevent zero output
 	needInverseFFT = true;
@@ -1505,6 +1747,54 @@ double PhaseVocoder::processAudioSample(double input, bool& fftReady)
 	return currentOutput;
 }
 
+/**
+\brief process a block of input samples through the vocoder to produce a block of output samples
+
+- NOTES:<br>
+The block stops at the next FFT so the caller can process the FFT data before the next block;
+call this in a loop until all samples are consumed. The input and output may be the same array.<br>
+
+\param input the input samples x(n)
+\param output the vocoder output samples y(n)
+\param blockSize the number of samples available
+\param fftReady a return flag indicating if the FFT has occurred and FFT data is ready to process
+
+\returns the number of samples processed: blockSize or getSamplesToNextFFT( ), whichever is smaller
+*/
+unsigned int PhaseVocoder::processAudioBlock(const double* input, double* output, unsigned int blockSize, bool& fftReady)
+{
+	// --- if user did not manually do fft and overlap, do them here
+	if (needInverseFFT)
+		doInverseFFT();
+	if (needOverlapAdd)
+		doOverlapAdd();
+
+	fftReady = false;
+	unsigned int count = blockSize < frameLength - fftCounter ? blockSize : frameLength - fftCounter;
+	if (count == 0)
+		return 0;
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		double xn = input[i];
+
+		// --- get the current output sample and clear it for the next overlap/add
+		output[i] = outputBuffer[outputReadIndex];
+		outputBuffer[outputReadIndex++] = 0.0;
+		outputReadIndex &= wrapMaskOut;
+
+		// --- push into buffer
+		inputBuffer[inputWriteIndex++] = xn;
+		inputWriteIndex &= wrapMask;
+	}
+
+	// --- only the last sample can complete a frame
+	fftCounter += count - 1;
+	fftReady = advanceAndCheckFFT();
+
+	return count;
+}
+
 /**
 \brief perform the inverse FFT on the processed data
 
@@ -1515,8 +1805,8 @@ then you can call this function at the appropriate time - see the PSMVocoder obj
 */
 void PhaseVocoder::doInverseFFT()
 {
-	// do the IFFT
-	fftw_execute(plan_backward);
+	// --- do the real IFFT; the FFT data stays intact
+	fftEngine.inverseReal(fft_result, ifft_result);
 
 	// --- output is now in ifft_result array
 	needInverseFFT = false;
@@ -1552,10 +1842,10 @@ void PhaseVocoder::doOverlapAdd(double* outputData, int length)
 		return;
 	}
 
-	for (int i = 0; i < frameLength; i++)
+	for (unsigned int i = 0; i < frameLength; i++)
 	{
 		// --- accumulate
-		outputBuffer[outputWriteIndex++] += windowHopCorrection * ifft_result[i][0];
+		outputBuffer[outputWriteIndex++] += windowHopCorrection * ifft_result[i];
 
 		// --- wrap if index > bufferlength - 1
 		outputWriteIndex &= wrapMaskOut;
@@ -1564,6 +1854,3 @@ void PhaseVocoder::doOverlapAdd(double* outputData, int length)
 	// --- set a flag
 	needOverlapAdd = false;
 }
-
-#endif
-
@@ -284,6 +284,90 @@ inline double dB2Raw(double dB)
 	return pow(10.0, (dB / 20.0));
 }
 
+/**
+@fastLog2
+\ingroup FX-Functions
+
+@brief log2 from the exponent bits plus an odd series for the mantissa; no branches or library calls,
+so block loops of it vectorize. Error about 1e-9 (< 1e-8 dB through fastRaw2dB( ))
+
+\param x - value to convert; must be a positive, normal number
+\return log2(x)
+*/
+inline double fastLog2(double x)
+{
+	uint64_t bits = 0;
+	memcpy(&bits, &x, sizeof(double));
+	double exponent = (double)((int64_t)((bits >> 52) & 0x7FF) - 1023);
+
+	// --- mantissa in [1, 2), then folded to [sqrt(0.5), sqrt(2)) so the series converges fast
+	bits = (bits & 0x000FFFFFFFFFFFFFull) | 0x3FF0000000000000ull;
+	double m = 0.0;
+	memcpy(&m, &bits, sizeof(double));
+	double fold = m > kSqrtTwo ? 1.0 : 0.0;
+	m *= 1.0 - 0.5*fold;
+	exponent += fold;
+
+	// --- log2(m) = 2/ln(2) * atanh((m - 1)/(m + 1))
+	double t = (m - 1.0) / (m + 1.0);
+	double t2 = t*t;
+	double series = t*(1.0 + t2*(1.0 / 3.0 + t2*(1.0 / 5.0 + t2*(1.0 / 7.0 + t2*(1.0 / 9.0)))));
+	return exponent + 2.8853900817779268*series;
+}
+
+/**
+@fastExp2
+\ingroup FX-Functions
+
+@brief 2^x from the exponent bits plus a Taylor series for the fraction; no branches or library calls.
+Relative error < 1e-8
+
+\param x - exponent, clamped to [-1022, 1023]
+\return 2^x
+*/
+inline double fastExp2(double x)
+{
+	x = fmin(fmax(x, -1022.0), 1023.0);
+
+	// --- x = i + f, f in [-0.5, 0.5]
+	double i = floor(x + 0.5);
+	double y = (x - i)*0.69314718055994531;
+	double p = 1.0 + y*(1.0 + y*(1.0 / 2.0 + y*(1.0 / 6.0 + y*(1.0 / 24.0 + y*(1.0 / 120.0 + y*(1.0 / 720.0 + y*(1.0 / 5040.0)))))));
+
+	uint64_t bits = (uint64_t)((int64_t)i + 1023) << 52;
+	double scale = 0.0;
+	memcpy(&scale, &bits, sizeof(double));
+	return p*scale;
+}
+
+/**
+@fastRaw2dB
+\ingroup FX-Functions
+
+@brief raw2dB( ) through fastLog2( ), for gain computers working on blocks
+
+\param raw - value to convert to dB; must be a positive, normal number
+\return the dB value
+*/
+inline double fastRaw2dB(double raw)
+{
+	return 6.0205999132796239*fastLog2(raw);	// --- 20*log10(2)
+}
+
+/**
+@fastdB2Raw
+\ingroup FX-Functions
+
+@brief dB2Raw( ) through fastExp2( ), for gain computers working on blocks
+
+\param dB - value to convert to raw
+\return the raw value
+*/
+inline double fastdB2Raw(double dB)
+{
+	return fastExp2(0.16609640474436813*dB);	// --- log2(10)/20
+}
+
 /**
 @peakGainFor_Q
 \ingroup FX-Functions
@@ -1086,7 +1170,7 @@ inline bool resample(double* input, double* output, uint32_t inLength, uint32_t
 			int x1 = (int)xInterp; // floor?
 			double xbar = xInterp - x1;
 
-			if (xInterp > 1 && x1 < outLength-2)
+			if (xInterp > 1 && x1 < inLength-2)
 			{
 				x[0] = x1 - 1;
 				y[0] = input[(int)x[0]];
@@ -1108,7 +1192,7 @@ inline bool resample(double* input, double* output, uint32_t inLength, uint32_t
 			else // --- linear for outer 2 end pts
 			{
 				int x2 = x1 + 1;
-				if (x2 >= outLength)
+				if (x2 >= inLength)
 					x2 = x1;
 				double y1 = input[x1];
 				double y2 = input[x2];
@@ -1128,7 +1212,7 @@ inline bool resample(double* input, double* output, uint32_t inLength, uint32_t
 			double xInterp = i*inc;
 			int x1 = (int)xInterp; // floor?
 			int x2 = x1 + 1;
-			if (x2 >= outLength)
+			if (x2 >= inLength)
 				x2 = x1;
 			double y1 = input[x1];
 			double y2 = input[x2];
@@ -1200,6 +1284,40 @@ public:
 		// --- do nothing
 		return false; // NOT handled
 	}
+
+	/** process a block of mono samples; input and output may be the same buffer
+	--- optional: the default calls processAudioSample( ) once per sample; objects on hot paths override this
+		with a loop that the compiler can inline (one virtual call per block instead of per sample) */
+	virtual void processAudioBlock(const float* input, float* output, uint32_t blockSize)
+	{
+		for (uint32_t i = 0; i < blockSize; i++)
+			output[i] = (float)processAudioSample(input[i]);
+	}
+
+	/** process a block of stereo samples in non-interleaved buffers; inputs and outputs may be the same buffers
+	--- optional: the default runs processAudioFrame( ) once per frame for objects that can process frames
+		and returns false (NOT handled) for mono objects, which have one set of state for one channel */
+	virtual bool processStereoAudioBlock(const float* inputLeft, const float* inputRight,
+										 float* outputLeft, float* outputRight,
+										 uint32_t blockSize)
+	{
+		if (!canProcessAudioFrame())
+			return false; // NOT handled
+
+		float inputFrame[2] = { 0.0 };
+		float outputFrame[2] = { 0.0 };
+		for (uint32_t i = 0; i < blockSize; i++)
+		{
+			inputFrame[0] = inputLeft[i];
+			inputFrame[1] = inputRight[i];
+			if (!processAudioFrame(inputFrame, outputFrame, 2, 2))
+				return false;
+
+			outputLeft[i] = outputFrame[0];
+			outputRight[i] = outputFrame[1];
+		}
+		return true;
+	}
 };
 
 /**
@@ -1393,6 +1511,10 @@ public:
 	*/
 	virtual double processAudioSample(double xn);
 
+	/** process a block through the biquad; the structure is decoded once and the
+	    coefficients and states stay in registers for the whole block */
+	virtual void processAudioBlock(const float* input, float* output, uint32_t blockSize);
+
 	/** get parameters: note use of custom structure for passing param data */
 	/**
 	\return BiquadParameters custom data structure
@@ -1550,6 +1672,9 @@ public:
 	*/
 	virtual double processAudioSample(double xn);
 
+	/** process a block through the filter; see Biquad::processAudioBlock( ) */
+	virtual void processAudioBlock(const float* input, float* output, uint32_t blockSize);
+
 	/** --- sample rate change necessarily requires recalculation */
 	virtual void setSampleRate(double _sampleRate)
 	{
@@ -1588,6 +1713,9 @@ public:
 	/** --- helper for Harma filters (phaser) */
 	double getS_value() { return biquad.getS_value(); }
 
+	/** --- the calculated coefficients, indexed by filterCoeff (a0, a1, a2, b1, b2, c0, d0) */
+	const double* getCoefficients() { return &coeffArray[0]; }
+
 protected:
 	// --- our calculator
 	Biquad biquad; ///< the biquad object
@@ -1766,12 +1894,266 @@ protected:
 	LRFilterBankParameters parameters; ///< parameters for the object
 };
 
+// --- series sections per BiquadCascade lane
+const uint32_t BIQUAD_CASCADE_MAX_SECTIONS = 8;
+
+/**
+\class BiquadCascade
+\ingroup FX-Objects
+\brief
+The BiquadCascade object runs LANES independent cascades of up to BIQUAD_CASCADE_MAX_SECTIONS biquads (EQ bands, crossover
+sections) together: the coefficients and states are SoA rows [section][lane], and every section is one fixed-length loop
+over the lanes, so the compiler processes the lanes (channels, or parallel bands of a filter bank) as one vector.
+
+- the sections use the transposed canonical structure (biquadAlgorithm::kTransposeCanonical), as AudioFilter does
+- the coefficients come from the AudioFilter calculator; the dry/wet mix of that filter (c0, d0) is folded into the
+  section, H(z) = d0 + c0*H_biquad(z), so every filterAlgorithm is a plain biquad here
+- coefficient changes ramp linearly, sample by sample, over setRampTime_mSec( ); the feedback coefficients move on a
+  straight line inside the (convex) stability triangle, so each step is a stable filter. Changes before the first
+  block after reset( ) are applied at once
+
+Audio I/O:
+- Processes LANES inputs to LANES outputs; processBlock( ) for blocks, processFrame( ) for one sample of every lane.
+
+Control I/F:
+- setSectionCount( ), setSection( ) with AudioFilterParameters per section (and lane), setRampTime_mSec( ).
+
+\author Will Pirkle http://www.willpirkle.com
+\remark This object is included in Designing Audio Effects Plugins in C++ 2nd Ed. by Will Pirkle
+\version Revision : 1.0
+\date Date : 2018 / 09 / 7
+*/
+template <uint32_t LANES>
+class BiquadCascade
+{
+public:
+	BiquadCascade()		/* C-TOR */
+	{
+		// --- pass-through until the sections are set
+		for (uint32_t s = 0; s < BIQUAD_CASCADE_MAX_SECTIONS; s++)
+		{
+			for (uint32_t i = 0; i < LANES; i++)
+			{
+				current.a0[s][i] = 1.0;
+				target.a0[s][i] = 1.0;
+			}
+		}
+	}
+	~BiquadCascade() {}	/* D-TOR */
+
+	/** clear the states; a new sample rate recalculates every section */
+	bool reset(double _sampleRate)
+	{
+		memset(&z1[0][0], 0, sizeof(z1));
+		memset(&z2[0][0], 0, sizeof(z2));
+
+		if (sampleRate != _sampleRate)
+		{
+			sampleRate = _sampleRate;
+			designer.setSampleRate(sampleRate);
+			for (uint32_t s = 0; s < sectionCount; s++)
+			{
+				for (uint32_t i = 0; i < LANES; i++)
+					designSection(i, s);
+			}
+		}
+
+		// --- no ramp into the first block
+		snapCoefficients();
+		primed = false;
+		updateRampSamples();
+		return true;
+	}
+
+	/** number of sections in series in every lane */
+	void setSectionCount(uint32_t count)
+	{
+		if (count > BIQUAD_CASCADE_MAX_SECTIONS)
+			count = BIQUAD_CASCADE_MAX_SECTIONS;
+		sectionCount = count;
+	}
+
+	/** set one section of one lane */
+	void setSection(uint32_t lane, uint32_t section, const AudioFilterParameters& params)
+	{
+		if (lane >= LANES || section >= BIQUAD_CASCADE_MAX_SECTIONS)
+			return;
+
+		sectionParameters[section][lane] = params;
+		designSection(lane, section);
+		startRamp();
+	}
+
+	/** set one section of every lane */
+	void setSection(uint32_t section, const AudioFilterParameters& params)
+	{
+		if (section >= BIQUAD_CASCADE_MAX_SECTIONS)
+			return;
+
+		for (uint32_t i = 0; i < LANES; i++)
+		{
+			sectionParameters[section][i] = params;
+			designSection(i, section);
+		}
+		startRamp();
+	}
+
+	/** coefficient ramp time; 0 = changes apply at the next sample */
+	void setRampTime_mSec(double _rampTime_mSec)
+	{
+		rampTime_mSec = _rampTime_mSec;
+		updateRampSamples();
+	}
+
+	/** one sample of every lane, in place */
+	inline void processFrame(double* x)
+	{
+		for (uint32_t s = 0; s < sectionCount; s++)
+		{
+			for (uint32_t i = 0; i < LANES; i++)
+			{
+				double xn = x[i];
+				double yn = current.a0[s][i] * xn + z1[s][i];
+
+				// --- underflow check as a select (same as checkFloatUnderflow( ))
+				yn = fabs(yn) < kSmallestPositiveFloatValue ? 0.0 : yn;
+
+				z1[s][i] = current.a1[s][i] * xn - current.b1[s][i] * yn + z2[s][i];
+				z2[s][i] = current.a2[s][i] * xn - current.b2[s][i] * yn;
+				x[i] = yn;
+			}
+		}
+
+		if (rampRemaining > 0)
+			advanceRamp();
+		primed = true;
+	}
+
+	/** a block of every lane; input[lane] and output[lane] may be the same buffer */
+	void processBlock(const double* const* input, double* const* output, uint32_t blockSize)
+	{
+		alignas(32) double x[LANES];
+		for (uint32_t n = 0; n < blockSize; n++)
+		{
+			for (uint32_t i = 0; i < LANES; i++)
+				x[i] = input[i][n];
+
+			processFrame(x);
+
+			for (uint32_t i = 0; i < LANES; i++)
+				output[i][n] = x[i];
+		}
+	}
+
+private:
+	// --- SoA coefficient rows
+	struct CascadeCoeffs
+	{
+		alignas(32) double a0[BIQUAD_CASCADE_MAX_SECTIONS][LANES] = { { 0.0 } };
+		alignas(32) double a1[BIQUAD_CASCADE_MAX_SECTIONS][LANES] = { { 0.0 } };
+		alignas(32) double a2[BIQUAD_CASCADE_MAX_SECTIONS][LANES] = { { 0.0 } };
+		alignas(32) double b1[BIQUAD_CASCADE_MAX_SECTIONS][LANES] = { { 0.0 } };
+		alignas(32) double b2[BIQUAD_CASCADE_MAX_SECTIONS][LANES] = { { 0.0 } };
+	};
+
+	CascadeCoeffs current;		///< coefficients in use
+	CascadeCoeffs target;		///< coefficients being ramped to
+	CascadeCoeffs increment;	///< per-sample ramp steps
+
+	alignas(32) double z1[BIQUAD_CASCADE_MAX_SECTIONS][LANES] = { { 0.0 } };	///< transposed canonical states
+	alignas(32) double z2[BIQUAD_CASCADE_MAX_SECTIONS][LANES] = { { 0.0 } };
+
+	AudioFilterParameters sectionParameters[BIQUAD_CASCADE_MAX_SECTIONS][LANES];	///< stored per section for sample rate changes
+	AudioFilter designer;		///< coefficient calculator
+	uint32_t sectionCount = 0;	///< sections in use
+	double sampleRate = 0.0;	///< current sample rate
+	double rampTime_mSec = 0.0;	///< coefficient ramp time
+	uint32_t rampSamples = 0;	///< coefficient ramp length
+	uint32_t rampRemaining = 0;	///< samples left in the ramp
+	bool primed = false;		///< a sample was processed since reset( )
+
+	/** calculate a section's target coefficients, c0/d0 folded in */
+	void designSection(uint32_t lane, uint32_t section)
+	{
+		designer.setParameters(sectionParameters[section][lane]);
+		const double* coeffs = designer.getCoefficients();
+
+		target.a0[section][lane] = coeffs[d0] + coeffs[c0] * coeffs[a0];
+		target.a1[section][lane] = coeffs[d0] * coeffs[b1] + coeffs[c0] * coeffs[a1];
+		target.a2[section][lane] = coeffs[d0] * coeffs[b2] + coeffs[c0] * coeffs[a2];
+		target.b1[section][lane] = coeffs[b1];
+		target.b2[section][lane] = coeffs[b2];
+	}
+
+	/** ramp every coefficient from where it is to its target over rampSamples */
+	void startRamp()
+	{
+		if (!primed || rampSamples == 0)
+		{
+			snapCoefficients();
+			return;
+		}
+
+		double scale = 1.0 / (double)rampSamples;
+		for (uint32_t s = 0; s < BIQUAD_CASCADE_MAX_SECTIONS; s++)
+		{
+			for (uint32_t i = 0; i < LANES; i++)
+			{
+				increment.a0[s][i] = (target.a0[s][i] - current.a0[s][i])*scale;
+				increment.a1[s][i] = (target.a1[s][i] - current.a1[s][i])*scale;
+				increment.a2[s][i] = (target.a2[s][i] - current.a2[s][i])*scale;
+				increment.b1[s][i] = (target.b1[s][i] - current.b1[s][i])*scale;
+				increment.b2[s][i] = (target.b2[s][i] - current.b2[s][i])*scale;
+			}
+		}
+		rampRemaining = rampSamples;
+	}
+
+	/** one ramp step; the last step lands exactly on the targets */
+	inline void advanceRamp()
+	{
+		if (--rampRemaining == 0)
+		{
+			snapCoefficients();
+			return;
+		}
+
+		for (uint32_t s = 0; s < sectionCount; s++)
+		{
+			for (uint32_t i = 0; i < LANES; i++)
+			{
+				current.a0[s][i] += increment.a0[s][i];
+				current.a1[s][i] += increment.a1[s][i];
+				current.a2[s][i] += increment.a2[s][i];
+				current.b1[s][i] += increment.b1[s][i];
+				current.b2[s][i] += increment.b2[s][i];
+			}
+		}
+	}
+
+	/** jump to the targets */
+	void snapCoefficients()
+	{
+		current = target;
+		rampRemaining = 0;
+	}
+
+	/** ramp length in samples */
+	void updateRampSamples()
+	{
+		rampSamples = rampTime_mSec > 0.0 ? (uint32_t)(rampTime_mSec*sampleRate / 1000.0) : 0;
+	}
+};
+
 // --- constants
 const unsigned int TLD_AUDIO_DETECT_MODE_PEAK = 0;
 const unsigned int TLD_AUDIO_DETECT_MODE_MS = 1;
 const unsigned int TLD_AUDIO_DETECT_MODE_RMS = 2;
 const double TLD_AUDIO_ENVELOPE_ANALOG_TC = -0.99967234081320612357829304641019; // ln(36.7%)
 
+// --- scratch size of the block detectors and gain computers (DynamicsProcessor, PeakLimiter)
+const uint32_t DYNAMICS_BLOCK_SIZE = 64;
+
 /**
 \struct AudioDetectorParameters
 \ingroup FX-Objects
@@ -1903,6 +2285,59 @@ public:
 		return 20.0*log10(currEnvelope);
 	}
 
+	/** detect a block: the same envelope as processAudioSample( ), split into a flat rectify pass, the recursive
+	    envelope pass and a flat RMS/dB pass (dB through fastRaw2dB( )); input and output may be the same buffer */
+	/**
+	\param input input samples
+	\param output detected values, linear or dB
+	\param blockSize number of samples
+	*/
+	void processBlock(const double* input, double* output, uint32_t blockSize)
+	{
+		// --- full wave rectify; square for MS and RMS
+		if (audioDetectorParameters.detectMode == TLD_AUDIO_DETECT_MODE_MS ||
+			audioDetectorParameters.detectMode == TLD_AUDIO_DETECT_MODE_RMS)
+		{
+			for (uint32_t i = 0; i < blockSize; i++)
+				output[i] = input[i] * input[i];
+		}
+		else
+		{
+			for (uint32_t i = 0; i < blockSize; i++)
+				output[i] = fabs(input[i]);
+		}
+
+		// --- the envelope is the only recursive part
+		double envelope = lastEnvelope;
+		for (uint32_t i = 0; i < blockSize; i++)
+		{
+			double x = output[i];
+			envelope = (x > envelope ? attackTime : releaseTime) * (envelope - x) + x;
+			checkFloatUnderflow(envelope);
+			if (audioDetectorParameters.clampToUnityMax)
+				envelope = fmin(envelope, 1.0);
+			envelope = fmax(envelope, 0.0);
+			output[i] = envelope;
+		}
+		lastEnvelope = envelope;
+
+		if (audioDetectorParameters.detectMode == TLD_AUDIO_DETECT_MODE_RMS)
+		{
+			for (uint32_t i = 0; i < blockSize; i++)
+				output[i] = sqrt(output[i]);
+		}
+
+		if (!audioDetectorParameters.detect_dB)
+			return;
+
+		// --- 0.0 maps to -96dB as in processAudioSample( )
+		for (uint32_t i = 0; i < blockSize; i++)
+		{
+			double x = output[i];
+			output[i] = x > 0.0 ? fastRaw2dB(fmax(x, kSmallestPositiveFloatValue)) : -96.0;
+		}
+	}
+
 	/** get parameters: note use of custom structure for passing param data */
 	/**
 	\return AudioDetectorParameters custom data structure
@@ -2127,6 +2562,48 @@ public:
 		return xn * gr * makeupGain;
 	}
 
+	/** process a block; the makeup gain is computed once
+	    NOTE: a sidechain sample set with processAuxInputAudioSample( ) is held for the whole block */
+	virtual void processAudioBlock(const float* input, float* output, uint32_t blockSize)
+	{
+		double makeupGain = pow(10.0, parameters.outputGain_dB / 20.0);
+		for (uint32_t i = 0; i < blockSize; i++)
+		{
+			double xn = input[i];
+			double detect_dB = detector.processAudioSample(parameters.enableSidechain ? sidechainInputSample : xn);
+			output[i] = (float)(xn * computeGain(detect_dB) * makeupGain);
+		}
+	}
+
+	/** process a double block: detection, gain computer and DCA run as passes over DYNAMICS_BLOCK_SIZE chunks,
+	    with the dB to gain conversion through fastdB2Raw( ); input and output may be the same buffer */
+	/**
+	\param input input samples
+	\param sidechain detector input, blockSize samples (e.g. a stereo link); nullptr = detect the input
+	\param output processed samples
+	\param blockSize number of samples
+	*/
+	void processBlock(const double* input, const double* sidechain, double* output, uint32_t blockSize)
+	{
+		for (uint32_t offset = 0; offset < blockSize; offset += DYNAMICS_BLOCK_SIZE)
+		{
+			uint32_t frames = blockSize - offset < DYNAMICS_BLOCK_SIZE ? blockSize - offset : DYNAMICS_BLOCK_SIZE;
+
+			detector.processBlock(sidechain ? &sidechain[offset] : &input[offset], detectBlock, frames);
+
+			for (uint32_t i = 0; i < frames; i++)
+				gainBlock[i] = computeGainReduction_dB(detectBlock[i]);
+
+			// --- makeup gain folded into the dB value; one conversion per sample
+			for (uint32_t i = 0; i < frames; i++)
+				output[offset + i] = input[offset + i] * fastdB2Raw(gainBlock[i] + parameters.outputGain_dB);
+
+			// --- meters follow the last sample
+			parameters.gainReduction_dB = gainBlock[frames - 1];
+		}
+		parameters.gainReduction = dB2Raw(parameters.gainReduction_dB);
+	}
+
 protected:
 	DynamicsProcessorParameters parameters; ///< object parameters
 	AudioDetector detector; ///< the sidechain audio detector
@@ -2134,8 +2611,23 @@ protected:
 	// --- storage for sidechain audio input (mono only)
 	double sidechainInputSample = 0.0; ///< storage for sidechain sample
 
+	// --- block scratch
+	double detectBlock[DYNAMICS_BLOCK_SIZE] = { 0.0 };	///< detected level (dB)
+	double gainBlock[DYNAMICS_BLOCK_SIZE] = { 0.0 };	///< gain reduction (dB)
+
 	/** compute (and save) the current gain value based on detected input (dB) */
 	inline double computeGain(double detect_dB)
+	{
+		// --- convert gain; store values for user meters
+		parameters.gainReduction_dB = computeGainReduction_dB(detect_dB);
+		parameters.gainReduction = pow(10.0, (parameters.gainReduction_dB) / 20.0);
+
+		// --- the current gain coefficient value
+		return parameters.gainReduction;
+	}
+
+	/** the gain computer: gain reduction in dB for a detected input (dB) */
+	inline double computeGainReduction_dB(double detect_dB)
 	{
 		double output_dB = 0.0;
 
@@ -2210,12 +2702,7 @@ protected:
 			}
 		}
 
-		// --- convert gain; store values for user meters
-		parameters.gainReduction_dB = output_dB - detect_dB;
-		parameters.gainReduction = pow(10.0, (parameters.gainReduction_dB) / 20.0);
-
-		// --- the current gain coefficient value
-		return parameters.gainReduction;
+		return output_dB - detect_dB;
 	}
 };
 
@@ -2279,62 +2766,289 @@ private:
 
 
 /**
-\class CircularBuffer
+\class IDelayMemoryClient
 \ingroup FX-Objects
 \brief
-The CircularBuffer object implements a simple circular buffer. It uses a wrap mask to wrap the read or write index quickly.
+Interface for an object whose delay memory is placed by a DelayMemoryArena.
 
 \author Will Pirkle http://www.willpirkle.com
 \remark This object is included in Designing Audio Effects Plugins in C++ 2nd Ed. by Will Pirkle
 \version Revision : 1.0
 \date Date : 2018 / 09 / 7
 */
-/** A simple cyclic buffer: NOTE - this is NOT an IAudioSignalProcessor or IAudioSignalGenerator
-	S must be a power of 2.
-*/
-template <typename T>
-class CircularBuffer
+class IDelayMemoryClient
 {
 public:
-	CircularBuffer() {}		/* C-TOR */
-	~CircularBuffer() {}	/* D-TOR */
+	virtual ~IDelayMemoryClient() {}
 
-							/** flush buffer by resetting all values to 0.0 */
-	void flushBuffer(){ memset(&buffer[0], 0, bufferLength * sizeof(T)); }
+	/** the arena has placed (and zeroed) this client's memory */
+	virtual void assignDelayMemory(void* memory) = 0;
+};
 
-	/** Create a buffer based on a target maximum in SAMPLES
-	//	   do NOT call from realtime audio thread; do this prior to any processing */
-	void createCircularBuffer(unsigned int _bufferLength)
-	{
-		// --- find nearest power of 2 for buffer, and create
-		createCircularBufferPowerOfTwo((unsigned int)(pow(2, ceil(log(_bufferLength) / log(2)))));
-	}
+/**
+\class DelayMemoryArena
+\ingroup FX-Objects
+\brief
+The DelayMemoryArena object holds the delay lines of a group of processors (e.g. one engine's FX chain) in a
+single contiguous block.
 
-	/** Create a buffer based on a target maximum in SAMPLESwhere the size is
-	    pre-calculated as a power of two */
-	void createCircularBufferPowerOfTwo(unsigned int _bufferLengthPowerOfTwo)
-	{
-		// --- reset to top
-		writeIndex = 0;
+- call beginReset( ), reset the processors, then commit( ); between the two the delay lines only register their
+  sizes (see DelayMemory), commit( ) lays them out and hands every registered line its view
+- each line starts on a 64-byte boundary; the block only grows, so a reset at the same or a lower sample rate
+  reuses it and a higher rate makes one allocation
+- commit( ) zeroes the whole block, so its pages are touched at reset and not on the audio thread
+- a line created outside a reset falls back to its own heap memory and is counted (getLateAllocationCount( ))
 
-		// --- find nearest power of 2 for buffer, save it as bufferLength
-		bufferLength = _bufferLengthPowerOfTwo;
+\author Will Pirkle http://www.willpirkle.com
+\remark This object is included in Designing Audio Effects Plugins in C++ 2nd Ed. by Will Pirkle
+\version Revision : 1.0
+\date Date : 2018 / 09 / 7
+*/
+class DelayMemoryArena
+{
+public:
+	DelayMemoryArena() {}	/* C-TOR */
+	~DelayMemoryArena() {}	/* D-TOR */
 
-		// --- save (bufferLength - 1) for use as wrapping mask
-		wrapMask = bufferLength - 1;
+	/** start collecting the line sizes; do NOT call from realtime audio thread */
+	void beginReset() { collecting = true; }
 
-		// --- create new buffer
-		buffer.reset(new T[bufferLength]);
+	/** true between beginReset( ) and commit( ) */
+	bool isCollecting() { return collecting; }
 
-		// --- flush buffer
-		flushBuffer();
+	/** add or resize a client's line */
+	void request(IDelayMemoryClient* client, size_t bytes)
+	{
+		bytes = (bytes + alignment - 1) & ~(alignment - 1);
+		for (size_t i = 0; i < requests.size(); i++)
+		{
+			if (requests[i].client == client)
+			{
+				requests[i].bytes = bytes;
+				return;
+			}
+		}
+		requests.push_back({ client, bytes });
+	}
+
+	/** remove a client; its region is reused at the next commit( ) */
+	void release(IDelayMemoryClient* client)
+	{
+		for (size_t i = 0; i < requests.size(); i++)
+		{
+			if (requests[i].client == client)
+			{
+				requests.erase(requests.begin() + i);
+				return;
+			}
+		}
+	}
+
+	/** lay out all registered lines, growing the block if needed, and assign the views */
+	bool commit()
+	{
+		collecting = false;
+
+		size_t total = 0;
+		for (size_t i = 0; i < requests.size(); i++)
+			total += requests[i].bytes;
+
+		if (total > capacity)
+		{
+			// --- over-allocate for the alignment
+			memory.reset(new uint8_t[total + alignment]);
+			alignedMemory = (uint8_t*)(((uintptr_t)memory.get() + alignment - 1) & ~(uintptr_t)(alignment - 1));
+			capacity = total;
+		}
+
+		used = total;
+		if (capacity > 0)
+			memset(alignedMemory, 0, capacity);
+
+		size_t offset = 0;
+		for (size_t i = 0; i < requests.size(); i++)
+		{
+			requests[i].client->assignDelayMemory(alignedMemory + offset);
+			offset += requests[i].bytes;
+		}
+		return true;
+	}
+
+	/** a line was created outside beginReset( )/commit( ) */
+	void noteLateAllocation() { lateAllocations++; }
+
+	/** bytes in the block / bytes in use */
+	size_t getCapacity() { return capacity; }
+	size_t getUsed() { return used; }
+
+	/** number of lines that allocated outside a reset */
+	uint32_t getLateAllocationCount() { return lateAllocations; }
+
+private:
+	struct Request
+	{
+		IDelayMemoryClient* client;
+		size_t bytes;
+	};
+
+	static const size_t alignment = 64;	///< cache line
+	std::vector<Request> requests;		///< registered lines in layout order
+	std::unique_ptr<uint8_t[]> memory = nullptr;
+	uint8_t* alignedMemory = nullptr;
+	size_t capacity = 0;
+	size_t used = 0;
+	bool collecting = false;
+	uint32_t lateAllocations = 0;
+};
+
+/**
+\class DelayMemory
+\ingroup FX-Objects
+\brief
+The DelayMemory object is the storage of one delay line: its own heap memory, or a view into a DelayMemoryArena.
+
+- with an arena, create( ) during a reset only registers the size; the memory arrives at DelayMemoryArena::commit( )
+  (a line that keeps its size keeps its current view until then)
+- create( ) with an unchanged size never reallocates; it only clears
+
+\author Will Pirkle http://www.willpirkle.com
+\remark This object is included in Designing Audio Effects Plugins in C++ 2nd Ed. by Will Pirkle
+\version Revision : 1.0
+\date Date : 2018 / 09 / 7
+*/
+template <typename T>
+class DelayMemory : public IDelayMemoryClient
+{
+public:
+	DelayMemory() {}	/* C-TOR */
+	~DelayMemory() { if (arena) arena->release(this); }	/* D-TOR */
+
+	/** place this line in an arena (nullptr = heap); drops the current memory */
+	void setArena(DelayMemoryArena* _arena)
+	{
+		if (arena)
+			arena->release(this);
+		arena = _arena;
+		heap.reset();
+		data = nullptr;
+		length = 0;
+	}
+
+	/** size the line; do NOT call from realtime audio thread */
+	void create(size_t _length)
+	{
+		if (arena && arena->isCollecting())
+		{
+			// --- keep the current arena view if the size holds, else wait for the commit
+			if (_length != length || heap)
+				data = nullptr;
+			length = _length;
+			heap.reset();
+			arena->request(this, length * sizeof(T));
+			clear();
+			return;
+		}
+
+		if (_length == length && data)
+		{
+			clear();
+			return;
+		}
+
+		// --- no arena, or resized outside a reset: own memory
+		if (arena)
+		{
+			arena->release(this);
+			arena->noteLateAllocation();
+		}
+		length = _length;
+		heap.reset(new T[length]);
+		data = heap.get();
+		clear();
+	}
+
+	/** zero the line */
+	void clear() { if (data) memset(data, 0, length * sizeof(T)); }
+
+	/** the line; nullptr until created (or until the arena commits) */
+	inline T* get() { return data; }
+	size_t size() { return length; }
+
+	/** IDelayMemoryClient */
+	virtual void assignDelayMemory(void* memory)
+	{
+		heap.reset();
+		data = (T*)memory;
+	}
+
+private:
+	DelayMemoryArena* arena = nullptr;		///< owner of the memory, if any
+	std::unique_ptr<T[]> heap = nullptr;	///< own memory when there is no arena
+	T* data = nullptr;						///< the line
+	size_t length = 0;						///< in samples
+};
+
+
+/**
+\class CircularBuffer
+\ingroup FX-Objects
+\brief
+The CircularBuffer object implements a simple circular buffer. It uses a wrap mask to wrap the read or write index quickly.
+
+\author Will Pirkle http://www.willpirkle.com
+\remark This object is included in Designing Audio Effects Plugins in C++ 2nd Ed. by Will Pirkle
+\version Revision : 1.0
+\date Date : 2018 / 09 / 7
+*/
+/** A simple cyclic buffer: NOTE - this is NOT an IAudioSignalProcessor or IAudioSignalGenerator
+	S must be a power of 2.
+*/
+template <typename T>
+class CircularBuffer
+{
+public:
+	CircularBuffer() {}		/* C-TOR */
+	~CircularBuffer() {}	/* D-TOR */
+
+							/** flush buffer by resetting all values to 0.0 */
+	void flushBuffer(){ buffer.clear(); }
+
+	/** place the buffer in a DelayMemoryArena (nullptr = own heap memory); takes effect at the next create */
+	void setDelayMemoryArena(DelayMemoryArena* arena) { buffer.setArena(arena); }
+
+	/** Create a buffer based on a target maximum in SAMPLES
+	//	   do NOT call from realtime audio thread; do this prior to any processing */
+	void createCircularBuffer(unsigned int _bufferLength)
+	{
+		// --- find nearest power of 2 for buffer, and create
+		unsigned int lengthPowerOfTwo = 1;
+		while (lengthPowerOfTwo < _bufferLength)
+			lengthPowerOfTwo <<= 1;
+		createCircularBufferPowerOfTwo(lengthPowerOfTwo);
+	}
+
+	/** Create a buffer based on a target maximum in SAMPLESwhere the size is
+	    pre-calculated as a power of two */
+	void createCircularBufferPowerOfTwo(unsigned int _bufferLengthPowerOfTwo)
+	{
+		// --- reset to top
+		writeIndex = 0;
+
+		// --- find nearest power of 2 for buffer, save it as bufferLength
+		bufferLength = _bufferLengthPowerOfTwo;
+
+		// --- save (bufferLength - 1) for use as wrapping mask
+		wrapMask = bufferLength - 1;
+
+		// --- create new buffer (flushed); an unchanged length keeps the memory
+		buffer.create(bufferLength);
 	}
 
 	/** write a value into the buffer; this overwrites the previous oldest value in the buffer */
 	void writeBuffer(T input)
 	{
 		// --- write and increment index counter
-		buffer[writeIndex++] = input;
+		buffer.get()[writeIndex++] = input;
 
 		// --- wrap if index > bufferlength - 1
 		writeIndex &= wrapMask;
@@ -2352,7 +3066,7 @@ public:
 		readIndex &= wrapMask;
 
 		// --- read it
-		return buffer[readIndex];
+		return buffer.get()[readIndex];
 	}
 
 	/** read an arbitrary location that includes a fractional sample */
@@ -2380,7 +3094,7 @@ public:
 	void setInterpolate(bool b) { interpolate = b; }
 
 private:
-	std::unique_ptr<T[]> buffer = nullptr;	///< smart pointer will auto-delete
+	DelayMemory<T> buffer;				///< own memory or a DelayMemoryArena view
 	unsigned int writeIndex = 0;		///> write index
 	unsigned int bufferLength = 1024;	///< must be nearest power of 2
 	unsigned int wrapMask = 1023;		///< must be (bufferLength - 1)
@@ -2388,6 +3102,214 @@ private:
 };
 
 
+/**
+\enum delayInterpolation
+\ingroup Constants-Enums
+\brief
+Use this strongly typed enum to set the fractional read of a GuardedCircularBuffer
+
+- enum class delayInterpolation { kNone, kLinear, kCubic, kAllpass };
+
+- kNone : integer part only
+- kLinear : two-point linear, same as CircularBuffer
+- kCubic : four-point (Catmull-Rom) Hermite; the delay is bounded to >= 1 sample for the newer point
+- kAllpass : first-order allpass (Thiran); flat magnitude, one state per buffer so it suits a single tap
+
+\author Will Pirkle http://www.willpirkle.com
+\remark This object is included in Designing Audio Effects Plugins in C++ 2nd Ed. by Will Pirkle
+\version Revision : 1.0
+\date Date : 2018 / 09 / 7
+*/
+enum class delayInterpolation { kNone, kLinear, kCubic, kAllpass };
+
+// --- samples mirrored past the end of a GuardedCircularBuffer; covers the 4-point cubic read
+const unsigned int DELAY_GUARD_SAMPLES = 4;
+
+/**
+\class GuardedCircularBuffer
+\ingroup FX-Objects
+\brief
+The GuardedCircularBuffer object is a CircularBuffer variant for modulated and multi-tap reads.
+
+- the write index runs downwards, so older samples are at higher addresses
+- the first DELAY_GUARD_SAMPLES samples are mirrored past the end (guard zone), so every interpolated read
+  is one masked index followed by contiguous loads: no second mask and no branch on the wrap
+- readBuffer( ) uses the same timing as CircularBuffer (read before write: a delay of 0 is the last write)
+- writeBlock( ) + readBlock( ) run a block of feed-forward taps: the read positions of a block are
+  independent, so the tap loop can be vectorized
+
+\author Will Pirkle http://www.willpirkle.com
+\remark This object is included in Designing Audio Effects Plugins in C++ 2nd Ed. by Will Pirkle
+\version Revision : 1.0
+\date Date : 2018 / 09 / 7
+*/
+template <typename T>
+class GuardedCircularBuffer
+{
+public:
+	GuardedCircularBuffer() {}		/* C-TOR */
+	~GuardedCircularBuffer() {}		/* D-TOR */
+
+	/** flush buffer by resetting all values to 0.0 */
+	void flushBuffer()
+	{
+		buffer.clear();
+		allpassState = 0.0;
+	}
+
+	/** place the buffer in a DelayMemoryArena (nullptr = own heap memory); takes effect at the next create */
+	void setDelayMemoryArena(DelayMemoryArena* arena) { buffer.setArena(arena); }
+
+	/** Create a buffer based on a target maximum in SAMPLES
+	//	   do NOT call from realtime audio thread; do this prior to any processing */
+	void createCircularBuffer(unsigned int _bufferLength)
+	{
+		unsigned int lengthPowerOfTwo = DELAY_GUARD_SAMPLES;
+		while (lengthPowerOfTwo < _bufferLength)
+			lengthPowerOfTwo <<= 1;
+		createCircularBufferPowerOfTwo(lengthPowerOfTwo);
+	}
+
+	/** Create a buffer where the size is pre-calculated as a power of two (>= DELAY_GUARD_SAMPLES) */
+	void createCircularBufferPowerOfTwo(unsigned int _bufferLengthPowerOfTwo)
+	{
+		writeIndex = 0;
+		bufferLength = _bufferLengthPowerOfTwo;
+		wrapMask = bufferLength - 1;
+		allpassState = 0.0;
+
+		// --- line + guard zone (flushed); an unchanged length keeps the memory
+		buffer.create(bufferLength + DELAY_GUARD_SAMPLES);
+	}
+
+	/** set the fractional read */
+	void setInterpolation(delayInterpolation _interpolation) { interpolation = _interpolation; }
+
+	/** write a value into the buffer; this overwrites the previous oldest value in the buffer */
+	inline void writeBuffer(T input)
+	{
+		T* data = buffer.get();
+		writeIndex = (writeIndex - 1) & wrapMask;
+		data[writeIndex] = input;
+
+		// --- guard zone copy; a select, not a branch
+		data[writeIndex < DELAY_GUARD_SAMPLES ? writeIndex + bufferLength : writeIndex] = input;
+	}
+
+	/** write a block (oldest first) */
+	void writeBlock(const T* input, uint32_t blockSize)
+	{
+		for (uint32_t i = 0; i < blockSize; i++)
+			writeBuffer(input[i]);
+	}
+
+	/** read an arbitrary location that is delayInSamples old */
+	inline T readBuffer(int delayInSamples)
+	{
+		return buffer.get()[(writeIndex + delayInSamples) & wrapMask];
+	}
+
+	/** read an arbitrary location that includes a fractional sample, with the current interpolation */
+	inline T readBuffer(double delayInFractionalSamples)
+	{
+		return readAt(0, delayInFractionalSamples);
+	}
+
+	/** after writeBlock( ): output[i] = input[i] delayed by delays[i] samples */
+	void readBlock(const double* delays, T* output, uint32_t blockSize)
+	{
+		// --- input[i] of the last block is (blockSize - 1 - i) samples from the write index
+		switch (interpolation)
+		{
+		case delayInterpolation::kNone:
+			for (uint32_t i = 0; i < blockSize; i++)
+				output[i] = readNone(blockSize - 1 - i, delays[i]);
+			break;
+		case delayInterpolation::kLinear:
+			for (uint32_t i = 0; i < blockSize; i++)
+				output[i] = readLinear(blockSize - 1 - i, delays[i]);
+			break;
+		case delayInterpolation::kCubic:
+			for (uint32_t i = 0; i < blockSize; i++)
+				output[i] = readCubic(blockSize - 1 - i, delays[i]);
+			break;
+		case delayInterpolation::kAllpass:
+			for (uint32_t i = 0; i < blockSize; i++)
+				output[i] = readAllpass(blockSize - 1 - i, delays[i]);
+			break;
+		}
+	}
+
+private:
+	DelayMemory<T> buffer;				///< line + guard zone; own memory or a DelayMemoryArena view
+	unsigned int writeIndex = 0;		///< newest sample, runs downwards
+	unsigned int bufferLength = 0;		///< power of 2, without the guard zone
+	unsigned int wrapMask = 0;			///< bufferLength - 1
+	delayInterpolation interpolation = delayInterpolation::kLinear;
+	T allpassState = 0.0;				///< kAllpass output z^-1
+
+	/** read at (offset + delay) samples from the write index */
+	inline T readAt(unsigned int offset, double delay)
+	{
+		switch (interpolation)
+		{
+		case delayInterpolation::kNone:
+			return readNone(offset, delay);
+		case delayInterpolation::kCubic:
+			return readCubic(offset, delay);
+		case delayInterpolation::kAllpass:
+			return readAllpass(offset, delay);
+		default:
+			return readLinear(offset, delay);
+		}
+	}
+
+	inline T readNone(unsigned int offset, double delay)
+	{
+		return buffer.get()[(writeIndex + offset + (unsigned int)delay) & wrapMask];
+	}
+
+	/** p[0] = delayed by the integer part, p[1] one sample older */
+	inline T readLinear(unsigned int offset, double delay)
+	{
+		unsigned int delayInt = (unsigned int)delay;
+		double fraction = delay - (double)delayInt;
+		const T* p = &buffer.get()[(writeIndex + offset + delayInt) & wrapMask];
+		return fraction*p[1] + (1.0 - fraction)*p[0];
+	}
+
+	/** p[0] is one sample newer than the integer delay, p[1..3] the integer delay and two older */
+	inline T readCubic(unsigned int offset, double delay)
+	{
+		delay = delay < 1.0 ? 1.0 : delay;
+		unsigned int delayInt = (unsigned int)delay;
+		double t = delay - (double)delayInt;
+		const T* p = &buffer.get()[(writeIndex + offset + delayInt - 1) & wrapMask];
+
+		// --- Catmull-Rom between p[1] and p[2]
+		T c1 = 0.5*(p[2] - p[0]);
+		T c2 = p[0] - 2.5*p[1] + 2.0*p[2] - 0.5*p[3];
+		T c3 = 0.5*(p[3] - p[0]) + 1.5*(p[1] - p[2]);
+		return ((c3*t + c2)*t + c1)*t + p[1];
+	}
+
+	/** first-order allpass on the integer-delayed stream; the fraction is kept in [0.5, 1.5) where it is best behaved */
+	inline T readAllpass(unsigned int offset, double delay)
+	{
+		unsigned int delayInt = (unsigned int)delay;
+		double fraction = delay - (double)delayInt;
+		unsigned int shift = (fraction < 0.5 && delayInt > 0) ? 1 : 0;
+		delayInt -= shift;
+		fraction += (double)shift;
+
+		double eta = (1.0 - fraction) / (1.0 + fraction);
+		const T* p = &buffer.get()[(writeIndex + offset + delayInt) & wrapMask];
+		allpassState = p[1] + eta*(p[0] - allpassState);
+		return allpassState;
+	}
+};
+
+
 /**
 \class ImpulseConvolver
 \ingroup FX-Objects
@@ -2684,6 +3606,7 @@ struct AudioDelayParameters
 		leftDelay_mSec = params.leftDelay_mSec;
 		rightDelay_mSec = params.rightDelay_mSec;
 		delayRatio_Pct = params.delayRatio_Pct;
+		interpolation = params.interpolation;
 
 		return *this;
 	}
@@ -2698,6 +3621,7 @@ struct AudioDelayParameters
 	double leftDelay_mSec = 0.0;	///< left delay time
 	double rightDelay_mSec = 0.0;	///< right delay time
 	double delayRatio_Pct = 100.0;	///< dela ratio: right length = (delayRatio)*(left length)
+	delayInterpolation interpolation = delayInterpolation::kLinear; ///< fractional delay read
 };
 
 /**
@@ -2792,13 +3716,31 @@ public:
 
 		// --- if we get here we know we have 2 output channels
 		//
-		// --- pick up inputs
-		//
-		// --- LEFT channel
-		double xnL = inputFrame[0];
+		// --- pick up inputs: LEFT channel, RIGHT channel (duplicate left input if mono-in)
+		double frame[2] = { inputFrame[0], inputChannels > 1 ? inputFrame[1] : inputFrame[0] };
+		processFrame(frame);
+
+		// --- set left and right channels
+		outputFrame[0] = (float)frame[0];
+		outputFrame[1] = (float)frame[1];
+
+		return true;
+	}
+
+	/** process one STEREO frame of doubles in place: frame[0] = left, frame[1] = right */
+	/**
+	
+eturn false (frame untouched) if the algorithm is not normal or ping-pong
+	*/
+	inline bool processFrame(double* frame)
+	{
+		// --- make sure we support this delay algorithm
+		if (parameters.algorithm != delayAlgorithm::kNormal &&
+			parameters.algorithm != delayAlgorithm::kPingPong)
+			return false;
 
-		// --- RIGHT channel (duplicate left input if mono-in)
-		double xnR = inputChannels > 1 ? inputFrame[1] : xnL;
+		double xnL = frame[0];
+		double xnR = frame[1];
 
 		// --- read delay LEFT
 		double ynL = delayBuffer_L.readBuffer(delayInSamples_L);
@@ -2836,15 +3778,56 @@ public:
 		// --- form mixture out = dry*xn + wet*yn
 		double outputR = dryMix*xnR + wetMix*ynR;
 
-		// --- set left channel
-		outputFrame[0] = outputL;
+		frame[0] = outputL;
+		frame[1] = outputR;
+
+		return true;
+	}
+
+	/** process a MONO block */
+	virtual void processAudioBlock(const float* input, float* output, uint32_t blockSize)
+	{
+		for (uint32_t i = 0; i < blockSize; i++)
+			output[i] = (float)AudioDelay::processAudioSample(input[i]);
+	}
 
-		// --- set right channel
-		outputFrame[1] = outputR;
+	/** process a STEREO block; the algorithm is checked once */
+	virtual bool processStereoAudioBlock(const float* inputLeft, const float* inputRight,
+										 float* outputLeft, float* outputRight,
+										 uint32_t blockSize)
+	{
+		if (parameters.algorithm != delayAlgorithm::kNormal &&
+			parameters.algorithm != delayAlgorithm::kPingPong)
+			return false;
 
+		double frame[2] = { 0.0 };
+		for (uint32_t i = 0; i < blockSize; i++)
+		{
+			frame[0] = inputLeft[i];
+			frame[1] = inputRight[i];
+			processFrame(frame);
+			outputLeft[i] = (float)frame[0];
+			outputRight[i] = (float)frame[1];
+		}
 		return true;
 	}
 
+	/** process a STEREO block of doubles in place; a block in an unsupported algorithm passes through */
+	void processBlock(double* left, double* right, uint32_t blockSize)
+	{
+		double frame[2] = { 0.0 };
+		for (uint32_t i = 0; i < blockSize; i++)
+		{
+			frame[0] = left[i];
+			frame[1] = right[i];
+			if (!processFrame(frame))
+				return;
+
+			left[i] = frame[0];
+			right[i] = frame[1];
+		}
+	}
+
 	/** get parameters: note use of custom structure for passing param data */
 	/**
 	\return AudioDelayParameters custom data structure
@@ -2865,6 +3848,8 @@ public:
 
 		// --- save; rest of updates are cheap on CPU
 		parameters = _parameters;
+		delayBuffer_L.setInterpolation(parameters.interpolation);
+		delayBuffer_R.setInterpolation(parameters.interpolation);
 
 		// --- check update type first:
 		if (parameters.updateType == delayUpdateType::kLeftAndRight)
@@ -2909,6 +3894,13 @@ public:
 		delayBuffer_R.createCircularBuffer(bufferLength);
 	}
 
+	/** place the delay buffers in a DelayMemoryArena; takes effect at the next createDelayBuffers( ) */
+	void setDelayMemoryArena(DelayMemoryArena* arena)
+	{
+		delayBuffer_L.setDelayMemoryArena(arena);
+		delayBuffer_R.setDelayMemoryArena(arena);
+	}
+
 private:
 	AudioDelayParameters parameters; ///< object parameters
 
@@ -2922,8 +3914,8 @@ private:
 	double dryMix = 0.707; ///< dry output default = -3dB
 
 	// --- delay buffer of doubles
-	CircularBuffer<double> delayBuffer_L;	///< LEFT delay buffer of doubles
-	CircularBuffer<double> delayBuffer_R;	///< RIGHT delay buffer of doubles
+	GuardedCircularBuffer<double> delayBuffer_L;	///< LEFT delay buffer of doubles
+	GuardedCircularBuffer<double> delayBuffer_R;	///< RIGHT delay buffer of doubles
 };
 
 
@@ -3293,6 +4285,7 @@ struct ModulatedDelayParameters
 		lfoRate_Hz = params.lfoRate_Hz;
 		lfoDepth_Pct = params.lfoDepth_Pct;
 		feedback_Pct = params.feedback_Pct;
+		interpolation = params.interpolation;
 		return *this;
 	}
 
@@ -3301,6 +4294,7 @@ struct ModulatedDelayParameters
 	double lfoRate_Hz = 0.0;	///< mod delay LFO rate in Hz
 	double lfoDepth_Pct = 0.0;	///< mod delay LFO depth in %
 	double feedback_Pct = 0.0;	///< feedback in %
+	delayInterpolation interpolation = delayInterpolation::kLinear; ///< modulated delay read; kCubic or kAllpass are smoother
 };
 
 /**
@@ -3370,6 +4364,91 @@ public:
 		if (inputChannels == 0 || outputChannels == 0)
 			return false;
 
+		// --- modulate the delay
+		updateModulation();
+
+		// --- just call the function and pass our info in/out
+		return delay.processAudioFrame(inputFrame, outputFrame, inputChannels, outputChannels);
+	}
+
+	/** process a STEREO block of frames */
+	virtual bool processStereoAudioBlock(const float* inputLeft, const float* inputRight,
+										 float* outputLeft, float* outputRight,
+										 uint32_t blockSize)
+	{
+		double frame[2] = { 0.0 };
+		for (uint32_t i = 0; i < blockSize; i++)
+		{
+			frame[0] = inputLeft[i];
+			frame[1] = inputRight[i];
+			updateModulation();
+			if (!delay.processFrame(frame))
+				return false;
+
+			outputLeft[i] = (float)frame[0];
+			outputRight[i] = (float)frame[1];
+		}
+		return true;
+	}
+
+	/** process a STEREO block of doubles in place */
+	void processBlock(double* left, double* right, uint32_t blockSize)
+	{
+		double frame[2] = { 0.0 };
+		for (uint32_t i = 0; i < blockSize; i++)
+		{
+			frame[0] = left[i];
+			frame[1] = right[i];
+			updateModulation();
+			if (!delay.processFrame(frame))
+				return;
+
+			left[i] = frame[0];
+			right[i] = frame[1];
+		}
+	}
+
+	/** get parameters: note use of custom structure for passing param data */
+	/**
+	\return ModulatedDelayParameters custom data structure
+	*/
+	ModulatedDelayParameters getParameters() { return parameters; }
+
+	/** set parameters: note use of custom structure for passing param data */
+	/**
+	\param ModulatedDelayParameters custom data structure
+	*/
+	void setParameters(ModulatedDelayParameters _parameters)
+	{
+		// --- bulk copy
+		parameters = _parameters;
+
+		OscillatorParameters lfoParams = lfo.getParameters();
+		lfoParams.frequency_Hz = parameters.lfoRate_Hz;
+		if (parameters.algorithm == modDelaylgorithm::kVibrato)
+			lfoParams.waveform = generatorWaveform::kSin;
+		else
+			lfoParams.waveform = generatorWaveform::kTriangle;
+
+		lfo.setParameters(lfoParams);
+
+		AudioDelayParameters adParams = delay.getParameters();
+		adParams.feedback_Pct = parameters.feedback_Pct;
+		adParams.interpolation = parameters.interpolation;
+		delay.setParameters(adParams);
+	}
+
+	/** place the delay buffers in a DelayMemoryArena; takes effect at the next reset( ) */
+	void setDelayMemoryArena(DelayMemoryArena* arena) { delay.setDelayMemoryArena(arena); }
+
+private:
+	ModulatedDelayParameters parameters; ///< object parameters
+	AudioDelay delay;	///< the delay to modulate
+	LFO lfo;			///< the modulator
+
+	/** render the LFO and set this sample's delay time (and the algorithm's wet/dry and feedback) */
+	void updateModulation()
+	{
 		// --- render LFO
 		SignalGenData lfoOutput = lfo.renderAudioOutput();
 
@@ -3421,44 +4500,7 @@ public:
 
 		// --- modulate the delay
 		delay.setParameters(params);
-
-		// --- just call the function and pass our info in/out
-		return delay.processAudioFrame(inputFrame, outputFrame, inputChannels, outputChannels);
 	}
-
-	/** get parameters: note use of custom structure for passing param data */
-	/**
-	\return ModulatedDelayParameters custom data structure
-	*/
-	ModulatedDelayParameters getParameters() { return parameters; }
-
-	/** set parameters: note use of custom structure for passing param data */
-	/**
-	\param ModulatedDelayParameters custom data structure
-	*/
-	void setParameters(ModulatedDelayParameters _parameters)
-	{
-		// --- bulk copy
-		parameters = _parameters;
-
-		OscillatorParameters lfoParams = lfo.getParameters();
-		lfoParams.frequency_Hz = parameters.lfoRate_Hz;
-		if (parameters.algorithm == modDelaylgorithm::kVibrato)
-			lfoParams.waveform = generatorWaveform::kSin;
-		else
-			lfoParams.waveform = generatorWaveform::kTriangle;
-
-		lfo.setParameters(lfoParams);
-
-		AudioDelayParameters adParams = delay.getParameters();
-		adParams.feedback_Pct = parameters.feedback_Pct;
-		delay.setParameters(adParams);
-	}
-
-private:
-	ModulatedDelayParameters parameters; ///< object parameters
-	AudioDelay delay;	///< the delay to modulate
-	LFO lfo;			///< the modulator
 };
 
 /**
@@ -3669,6 +4711,20 @@ public:
 		return output;
 	}
 
+	/** process a block through the phaser */
+	virtual void processAudioBlock(const float* input, float* output, uint32_t blockSize)
+	{
+		for (uint32_t i = 0; i < blockSize; i++)
+			output[i] = (float)PhaseShifter::processAudioSample(input[i]);
+	}
+
+	/** process a block of doubles; output may alias input */
+	void processBlock(const double* input, double* output, uint32_t blockSize)
+	{
+		for (uint32_t i = 0; i < blockSize; i++)
+			output[i] = PhaseShifter::processAudioSample(input[i]);
+	}
+
 	/** return false: this object only processes samples */
 	virtual bool canProcessAudioFrame() { return false; }
 
@@ -3932,6 +4988,9 @@ public:
 		delayBuffer.createCircularBuffer(bufferLength);
 	}
 
+	/** place the delay buffer in a DelayMemoryArena; takes effect at the next createDelayBuffer( ) */
+	void setDelayMemoryArena(DelayMemoryArena* arena) { delayBuffer.setDelayMemoryArena(arena); }
+
 	/** read delay at current location */
 	double readDelay()
 	{
@@ -4317,6 +5376,9 @@ public:
 		delay.createDelayBuffer(_sampleRate, delay_mSec);
 	}
 
+	/** place the delay buffer in a DelayMemoryArena; takes effect at the next createDelayBuffer( ) */
+	void setDelayMemoryArena(DelayMemoryArena* arena) { delay.setDelayMemoryArena(arena); }
+
 protected:
 	// --- component parameters
 	DelayAPFParameters delayAPFParameters;	///< obeject parameters
@@ -4528,6 +5590,13 @@ public:
 		nestedAPF.createDelayBuffer(_sampleRate, nestedAPFDelay_mSec);
 	}
 
+	/** place both delay buffers in a DelayMemoryArena; takes effect at the next createDelayBuffers( ) */
+	void setDelayMemoryArena(DelayMemoryArena* arena)
+	{
+		DelayAPF::setDelayMemoryArena(arena);
+		nestedAPF.setDelayMemoryArena(arena);
+	}
+
 private:
 	NestedDelayAPFParameters nestedAPFParameters; ///< object parameters
 	DelayAPF nestedAPF;	///< nested APF object
@@ -4743,6 +5812,9 @@ struct ReverbTankParameters
 // --- constants for reverb tank
 const unsigned int NUM_BRANCHES = 4;
 const unsigned int NUM_CHANNELS = 2; // stereo
+const unsigned int REVERB_BLOCK_SIZE = 64;			///< sub-block size of ReverbTank::processBlock( )
+const double REVERB_MAX_DELAY_mSec = 100.0;			///< capacity of every line in the delay arena
+const double REVERB_SHELF_RAMP_mSec = 5.0;			///< shelving filter coefficient ramp
 
 /**
 \class ReverbTank
@@ -4756,6 +5828,20 @@ Audio I/O:
 Control I/F:
 - Use ReverbTankParameters structure to get/set object params.
 
+Implementation:
+- each branch only reads its neighbour through that neighbour's fixed delay, so all NUM_BRANCHES branches
+  of one sample are independent; the branch state is held per lane (SoA) and every stage is a flat loop
+  over the branches with no virtual calls or per-branch objects
+- the pre-delay and the three branch banks (fixed delays, outer and inner APFs) are one DelayMemory line
+  (own memory or a DelayMemoryArena view); a bank interleaves its NUM_BRANCHES lines so that one sample of
+  all branches is one contiguous write
+- delay times and output taps are whole samples, as in the original SimpleDelay-based tank; the outer APF
+  delays are swept down from there by per-branch triangle LFOs and only the sweep is linearly interpolated
+- processBlock( ) runs the tank over sub-blocks and then does the shelving filters and the wet/dry mix
+  as passes over the sub-block; processAudioFrame( ) is the same tank one sample at a time
+- the low and high shelves of both channels are one BiquadCascade (two sections, one lane per channel);
+  shelf changes ramp over REVERB_SHELF_RAMP_mSec
+
 \author Will Pirkle http://www.willpirkle.com
 \remark This object is included in Designing Audio Effects Plugins in C++ 2nd Ed. by Will Pirkle
 \version Revision : 1.0
@@ -4764,7 +5850,13 @@ Control I/F:
 class ReverbTank : public IAudioSignalProcessor
 {
 public:
-	ReverbTank() {}		/* C-TOR */
+	ReverbTank()		/* C-TOR */
+	{
+		// --- low shelf -> high shelf, both channels
+		shelvingFilters.setSectionCount(2);
+		shelvingFilters.setRampTime_mSec(REVERB_SHELF_RAMP_mSec);
+		updateShelvingFilters();
+	}
 	~ReverbTank() {}	/* D-TOR */
 
 	/** reset members to initialized state */
@@ -4773,24 +5865,27 @@ public:
 		// ---store
 		sampleRate = _sampleRate;
 
-		// ---set up preDelay
-		preDelay.reset(_sampleRate);
-		preDelay.createDelayBuffer(_sampleRate, 100.0);
+		// --- one power-of-two length for every line; +3 for the interpolated read
+		unsigned int length = 1;
+		while (length < (unsigned int)(REVERB_MAX_DELAY_mSec*sampleRate / 1000.0) + 3)
+			length <<= 1;
 
-		for (int i = 0; i < NUM_BRANCHES; i++)
-		{
-			branchDelays[i].reset(_sampleRate);
-			branchDelays[i].createDelayBuffer(_sampleRate, 100.0);
+		// --- pre-delay + three interleaved banks (flushed; an unchanged size keeps the memory)
+		delayMemory.create((size_t)length*(1 + 3 * NUM_BRANCHES));
 
-			branchNestedAPFs[i].reset(_sampleRate);
-			branchNestedAPFs[i].createDelayBuffers(_sampleRate, 100.0, 100.0);
+		delayLength = length;
+		delayMask = length - 1;
+		writeIndex = 0;
 
-			branchLPFs[i].reset(_sampleRate);
-		}
-		for (int i = 0; i < NUM_CHANNELS; i++)
+		for (uint32_t i = 0; i < NUM_BRANCHES; i++)
 		{
-			shelvingFilters[i].reset(_sampleRate);
+			lpfState[i] = 0.0;
+			lfoPhase[i] = 0.0;
 		}
+		shelvingFilters.reset(_sampleRate);
+
+		// --- delay times in samples follow the new rate
+		updateBranches();
 
 		return true;
 	}
@@ -4805,7 +5900,7 @@ public:
 	*/
 	virtual double processAudioSample(double xn)
 	{
-		float inputs[2] = { 0.0 };
+		float inputs[2] = { (float)xn, 0.0 };
 		float outputs[2] = { 0.0 };
 		processAudioFrame(inputs, outputs, 1, 1);
 		return outputs[0];
@@ -4817,87 +5912,73 @@ public:
 		uint32_t inputChannels,
 		uint32_t outputChannels)
 	{
-		double output = 0.0;
-
-		// --- global feedback from delay in last branch
-		double globFB = branchDelays[NUM_BRANCHES-1].readDelay();
-
-		// --- feedback value
-		double fb = parameters.kRT*(globFB);
-
-		// --- mono-ized input signal
 		double xnL = inputFrame[0];
 		double xnR = inputChannels > 1 ? inputFrame[1] : 0.0;
-		double monoXn = double(1.0 / inputChannels)*xnL + double(1.0 / inputChannels)*xnR;
-
-		// --- pre delay output
-		double preDelayOut = preDelay.processAudioSample(monoXn);
-
-		// --- input to first branch = preDalay + globFB
-		double input = preDelayOut + fb;
-		for (int i = 0; i < NUM_BRANCHES; i++)
+		if (!delayMemory.get())
 		{
-			double apfOut = branchNestedAPFs[i].processAudioSample(input);
-			double lpfOut = branchLPFs[i].processAudioSample(apfOut);
-			double delayOut = parameters.kRT*branchDelays[i].processAudioSample(lpfOut);
-			input = delayOut + preDelayOut;
+			outputFrame[0] = (float)xnL;
+			if (outputChannels > 1)
+				outputFrame[1] = (float)xnR;
+			return true;
 		}
-		// --- gather outputs
-		/*
-		There are 25 prime numbers between 1 and 100.
-		They are 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41,
-		43, 47, 53, 59, 61, 67, 71, 73, 79, 83, 89, and 97
-
-		we want 16 of them: 23, 29, 31, 37, 41,
-		43, 47, 53, 59, 61, 67, 71, 73, 79, 83, 89, and 97
-		*/
 
-		double weight = 0.707;
-
-		double outL= 0.0;
-		outL += weight*branchDelays[0].readDelayAtPercentage(23.0);
-		outL -= weight*branchDelays[1].readDelayAtPercentage(41.0);
-		outL += weight*branchDelays[2].readDelayAtPercentage(59.0);
-		outL -= weight*branchDelays[3].readDelayAtPercentage(73.0);
+		// --- mono-ized input signal
+		double monoXn = double(1.0 / inputChannels)*xnL + double(1.0 / inputChannels)*xnR;
 
+		double outL = 0.0;
 		double outR = 0.0;
-		outR -= weight*branchDelays[0].readDelayAtPercentage(29.0);
-		outR += weight*branchDelays[1].readDelayAtPercentage(43.0);
-		outR -= weight*branchDelays[2].readDelayAtPercentage(61.0);
-		outR += weight*branchDelays[3].readDelayAtPercentage(79.0);
-
-		if (parameters.density == reverbDensity::kThick)
-		{
-			outL += weight*branchDelays[0].readDelayAtPercentage(31.0);
-			outL -= weight*branchDelays[1].readDelayAtPercentage(47.0);
-			outL += weight*branchDelays[2].readDelayAtPercentage(67.0);
-			outL -= weight*branchDelays[3].readDelayAtPercentage(83.0);
-
-			outR -= weight*branchDelays[0].readDelayAtPercentage(37.0);
-			outR += weight*branchDelays[1].readDelayAtPercentage(53.0);
-			outR -= weight*branchDelays[2].readDelayAtPercentage(71.0);
-			outR += weight*branchDelays[3].readDelayAtPercentage(89.0);
-		}
+		processTank(monoXn, outL, outR);
 
 		// ---  filter
-		double tankOutL = shelvingFilters[0].processAudioSample(outL);
-		double tankOutR = shelvingFilters[1].processAudioSample(outR);
-
-		// --- sum with dry
-		double dry = pow(10.0, parameters.dryLevel_dB / 20.0);
-		double wet = pow(10.0, parameters.wetLevel_dB / 20.0);
+		double tankOut[NUM_CHANNELS] = { outL, outR };
+		shelvingFilters.processFrame(tankOut);
+		double tankOutL = tankOut[0];
+		double tankOutR = tankOut[1];
 
 		if (outputChannels == 1)
-			outputFrame[0] = dry*xnL + wet*(0.5*tankOutL + 0.5*tankOutR);
+			outputFrame[0] = (float)(dryGain*xnL + wetGain*(0.5*tankOutL + 0.5*tankOutR));
 		else
 		{
-			outputFrame[0] = dry*xnL + wet*tankOutL;
-			outputFrame[1] = dry*xnR + wet*tankOutR;
+			outputFrame[0] = (float)(dryGain*xnL + wetGain*tankOutL);
+			outputFrame[1] = (float)(dryGain*xnR + wetGain*tankOutR);
 		}
 
 		return true;
 	}
 
+	/** process a block of stereo reverb in place; see processBlock( ) in fxobjects.cpp */
+	void processBlock(double* left, double* right, uint32_t blockSize);
+
+	/** place the delay lines in a DelayMemoryArena; takes effect at the next reset( ) */
+	void setDelayMemoryArena(DelayMemoryArena* arena) { delayMemory.setArena(arena); }
+
+	/** process a block of stereo reverb */
+	virtual bool processStereoAudioBlock(const float* inputLeft, const float* inputRight,
+										 float* outputLeft, float* outputRight,
+										 uint32_t blockSize)
+	{
+		double blockLeft[REVERB_BLOCK_SIZE];
+		double blockRight[REVERB_BLOCK_SIZE];
+		for (uint32_t offset = 0; offset < blockSize; offset += REVERB_BLOCK_SIZE)
+		{
+			uint32_t count = blockSize - offset < REVERB_BLOCK_SIZE ? blockSize - offset : REVERB_BLOCK_SIZE;
+			for (uint32_t i = 0; i < count; i++)
+			{
+				blockLeft[i] = inputLeft[offset + i];
+				blockRight[i] = inputRight[offset + i];
+			}
+
+			processBlock(blockLeft, blockRight, count);
+
+			for (uint32_t i = 0; i < count; i++)
+			{
+				outputLeft[offset + i] = (float)blockLeft[i];
+				outputRight[offset + i] = (float)blockRight[i];
+			}
+		}
+		return true;
+	}
+
 	/** get parameters: note use of custom structure for passing param data */
 	/**
 	\return ReverbTankParameters custom data structure
@@ -4910,90 +5991,293 @@ public:
 	*/
 	void setParameters(const ReverbTankParameters& params)
 	{
-		// --- do the updates here, the sub-components will only update themselves if
-		//     their parameters changed, so we let those object handle that chore
-		TwoBandShelvingFilterParameters filterParams = shelvingFilters[0].getParameters();
-		filterParams.highShelf_fc = params.highShelf_fc;
-		filterParams.highShelfBoostCut_dB = params.highShelfBoostCut_dB;
-		filterParams.lowShelf_fc = params.lowShelf_fc;
-		filterParams.lowShelfBoostCut_dB = params.lowShelfBoostCut_dB;
+		// --- the shelving filters are only recalculated (and ramped) if their parameters changed
+		bool shelvesChanged = params.lowShelf_fc != parameters.lowShelf_fc ||
+							  params.lowShelfBoostCut_dB != parameters.lowShelfBoostCut_dB ||
+							  params.highShelf_fc != parameters.highShelf_fc ||
+							  params.highShelfBoostCut_dB != parameters.highShelfBoostCut_dB;
 
-		// --- copy to both channels
-		shelvingFilters[0].setParameters(filterParams);
-		shelvingFilters[1].setParameters(filterParams);
+		// --- save our copy, then the per-branch values
+		parameters = params;
+		if (shelvesChanged)
+			updateShelvingFilters();
+		updateBranches();
 
-		SimpleLPFParameters  lpfParams = branchLPFs[0].getParameters();
-		lpfParams.g = params.lpf_g;
+		// --- mix gains, once per update rather than per sample
+		dryGain = pow(10.0, parameters.dryLevel_dB / 20.0);
+		wetGain = pow(10.0, parameters.wetLevel_dB / 20.0);
+	}
 
-		for (int i = 0; i < NUM_BRANCHES; i++)
-		{
-			branchLPFs[i].setParameters(lpfParams);
-		}
+private:
+	ReverbTankParameters parameters;				///< object parameters
 
-		// --- update pre delay
-		SimpleDelayParameters delayParams = preDelay.getParameters();
-		delayParams.delayTime_mSec = params.preDelayTime_mSec;
-		preDelay.setParameters(delayParams);
+	BiquadCascade<NUM_CHANNELS> shelvingFilters;	///< low shelf -> high shelf; lane 0 = left, 1 = right
 
-		// --- set apf and delay parameters
-		int m = 0;
-		NestedDelayAPFParameters apfParams = branchNestedAPFs[0].getParameters();
-		delayParams = branchDelays[0].getParameters();
+	/** set both shelves of both channels from the parameters */
+	void updateShelvingFilters()
+	{
+		AudioFilterParameters filterParams;
+		filterParams.algorithm = filterAlgorithm::kLowShelf;
+		filterParams.fc = parameters.lowShelf_fc;
+		filterParams.boostCut_dB = parameters.lowShelfBoostCut_dB;
+		shelvingFilters.setSection(0, filterParams);
+
+		filterParams.algorithm = filterAlgorithm::kHiShelf;
+		filterParams.fc = parameters.highShelf_fc;
+		filterParams.boostCut_dB = parameters.highShelfBoostCut_dB;
+		shelvingFilters.setSection(1, filterParams);
+	}
+
+	// --- weighting values to make various and low-correlated APF delay values easily
+	double apfDelayWeight[NUM_BRANCHES * 2] = { 0.317, 0.873, 0.477, 0.291, 0.993, 0.757, 0.179, 0.575 };///< weighting values to make various and low-correlated APF delay values easily
+	double fixedDelayWeight[NUM_BRANCHES] = { 1.0, 0.873, 0.707, 0.667 };	///< weighting values to make various and fixed delay values easily
+	double lfoRate_Hz[NUM_BRANCHES] = { 0.15, 0.33, 0.57, 0.73 };			///< outer APF modulation rates
+	double sampleRate = 0.0;	///< current sample rate
+
+	// --- delay memory: pre-delay line, then the fixed delay, outer APF and inner APF banks;
+	//     sample n of branch i in a bank is at [n*NUM_BRANCHES + i]
+	DelayMemory<double> delayMemory;
+	unsigned int delayLength = 0;	///< power of two, shared by all lines
+	unsigned int delayMask = 0;		///< delayLength - 1
+	unsigned int writeIndex = 0;	///< shared: every line is written once per sample
+
+	// --- per-branch (SoA) values from the parameters
+	unsigned int preDelay_Samples = 0;
+	unsigned int fixedDelay_Samples[NUM_BRANCHES] = { 0 };
+	unsigned int innerDelay_Samples[NUM_BRANCHES] = { 0 };
+	double outerDelay_Samples[NUM_BRANCHES] = { 0.0 };			///< maximum (unmodulated) outer APF delay, whole samples
+	double outerModulation_Samples[NUM_BRANCHES] = { 0.0 };		///< modulation depth below the maximum
+	unsigned int tapLeft_Samples[2][NUM_BRANCHES] = { { 0 } };	///< output taps, normal and thick
+	unsigned int tapRight_Samples[2][NUM_BRANCHES] = { { 0 } };
+	double tapGain = 0.0;										///< 0 for sparse density
+	double lfoPhaseInc[NUM_BRANCHES] = { 0.0 };
+	double outerAPF_g = 0.5;
+	double innerAPF_g = -0.5;
+	double lpf_g = 0.0;
+	double kRT = 0.0;
+	double wetGain = 0.707;
+	double dryGain = 0.707;
+
+	// --- per-branch state
+	double lpfState[NUM_BRANCHES] = { 0.0 };
+	double lfoPhase[NUM_BRANCHES] = { 0.0 };
+
+	/** delay times, taps and LFO increments from the parameters and sample rate */
+	void updateBranches()
+	{
+		double samplesPerMSec = sampleRate / 1000.0;
+		double maxDelay_Samples = delayLength > 3 ? (double)(delayLength - 3) : 0.0;
 
 		// --- global max Delay times
 		double globalAPFMaxDelay = (parameters.apfDelayWeight_Pct / 100.0)*parameters.apfDelayMax_mSec;
 		double globalFixedMaxDelay = (parameters.fixeDelayWeight_Pct / 100.0)*parameters.fixeDelayMax_mSec;
 
-		// --- lfo
-		apfParams.enableLFO = true;
-		apfParams.lfoMaxModulation_mSec = 0.3;
-		apfParams.lfoDepth = 1.0;
-
-		for (int i = 0; i < NUM_BRANCHES; i++)
-		{
-			// --- setup APFs
-			apfParams.outerAPFdelayTime_mSec = globalAPFMaxDelay*apfDelayWeight[m++];
-			apfParams.innerAPFdelayTime_mSec = globalAPFMaxDelay*apfDelayWeight[m++];
-			apfParams.innerAPF_g = -0.5;
-			apfParams.outerAPF_g = 0.5;
-			if (i == 0)
-				apfParams.lfoRate_Hz = 0.15;
-			else if (i == 1)
-				apfParams.lfoRate_Hz = 0.33;
-			else if (i == 2)
-				apfParams.lfoRate_Hz = 0.57;
-			else if (i == 3)
-				apfParams.lfoRate_Hz = 0.73;
-
-			branchNestedAPFs[i].setParameters(apfParams);
-
-			// --- fixedDelayWeight
-			delayParams.delayTime_mSec = globalFixedMaxDelay*fixedDelayWeight[i];
-			branchDelays[i].setParameters(delayParams);
-		}
-
-		// --- save our copy
-		parameters = params;
+		preDelay_Samples = (unsigned int)fmin(fmax(parameters.preDelayTime_mSec*samplesPerMSec, 0.0), maxDelay_Samples);
+
+		// --- output taps at prime percentages of each fixed delay, alternating sign across branches
+		const double tapLeft_Pct[2][NUM_BRANCHES] = { { 23.0, 41.0, 59.0, 73.0 }, { 31.0, 47.0, 67.0, 83.0 } };
+		const double tapRight_Pct[2][NUM_BRANCHES] = { { 29.0, 43.0, 61.0, 79.0 }, { 37.0, 53.0, 71.0, 89.0 } };
+
+		// --- all delays and taps are whole samples, as the SimpleDelay lines of the original tank
+		//     read them (SimpleDelayParameters::interpolate is off); only the LFO sweep is fractional
+		for (uint32_t i = 0; i < NUM_BRANCHES; i++)
+		{
+			double fixedDelay = fmin(fmax(globalFixedMaxDelay*fixedDelayWeight[i] * samplesPerMSec, 0.0), maxDelay_Samples);
+			fixedDelay_Samples[i] = (unsigned int)fixedDelay;
+			for (int j = 0; j < 2; j++)
+			{
+				tapLeft_Samples[j][i] = (unsigned int)(tapLeft_Pct[j][i] / 100.0*fixedDelay);
+				tapRight_Samples[j][i] = (unsigned int)(tapRight_Pct[j][i] / 100.0*fixedDelay);
+			}
+
+			// --- outer APF modulates down from its whole-sample delay by up to 0.3 mSec
+			outerDelay_Samples[i] = (double)(unsigned int)fmin(fmax(globalAPFMaxDelay*apfDelayWeight[2 * i] * samplesPerMSec, 0.0), maxDelay_Samples);
+			outerModulation_Samples[i] = fmin(0.3*samplesPerMSec, outerDelay_Samples[i]);
+			innerDelay_Samples[i] = (unsigned int)fmin(fmax(globalAPFMaxDelay*apfDelayWeight[2 * i + 1] * samplesPerMSec, 0.0), maxDelay_Samples);
+
+			lfoPhaseInc[i] = sampleRate > 0.0 ? lfoRate_Hz[i] / sampleRate : 0.0;
+		}
+
+		tapGain = parameters.density == reverbDensity::kThick ? 1.0 : 0.0;
+		lpf_g = parameters.lpf_g;
+		kRT = parameters.kRT;
 	}
 
+	/** one sample through the pre-delay and the branches; returns the left and right taps before the shelving filters */
+	inline void processTank(double monoXn, double& outL, double& outR)
+	{
+		const unsigned int w = writeIndex;
+		const unsigned int mask = delayMask;
+		double* preDelayLine = delayMemory.get();
+		double* fixedDelayBank = preDelayLine + delayLength;
+		double* outerAPFBank = fixedDelayBank + (size_t)delayLength*NUM_BRANCHES;
+		double* innerAPFBank = outerAPFBank + (size_t)delayLength*NUM_BRANCHES;
 
-private:
-	ReverbTankParameters parameters;				///< object parameters
+		// --- pre delay output (write first so that 0 samples passes through)
+		preDelayLine[w] = monoXn;
+		double preDelayOut = preDelayLine[(w - preDelay_Samples) & mask];
 
-	SimpleDelay  preDelay;							///< pre delay object
-	SimpleDelay  branchDelays[NUM_BRANCHES];		///< branch delay objects
-	NestedDelayAPF branchNestedAPFs[NUM_BRANCHES];	///< nested APFs for each branch
-	SimpleLPF  branchLPFs[NUM_BRANCHES];			///< LPFs in each branch
+		// --- fixed delay outputs; branch i is fed by branch i - 1, branch 0 by the last one (global feedback)
+		double delayOut[NUM_BRANCHES];
+		for (uint32_t i = 0; i < NUM_BRANCHES; i++)
+			delayOut[i] = fixedDelayBank[((w - 1 - fixedDelay_Samples[i]) & mask)*NUM_BRANCHES + i];
 
-	TwoBandShelvingFilter shelvingFilters[NUM_CHANNELS]; ///< shelving filters 0 = left; 1 = right
+		double input[NUM_BRANCHES];
+		input[0] = preDelayOut + kRT*delayOut[NUM_BRANCHES - 1];
+		for (uint32_t i = 1; i < NUM_BRANCHES; i++)
+			input[i] = preDelayOut + kRT*delayOut[i - 1];
 
-	// --- weighting values to make various and low-correlated APF delay values easily
-	double apfDelayWeight[NUM_BRANCHES * 2] = { 0.317, 0.873, 0.477, 0.291, 0.993, 0.757, 0.179, 0.575 };///< weighting values to make various and low-correlated APF delay values easily
-	double fixedDelayWeight[NUM_BRANCHES] = { 1.0, 0.873, 0.707, 0.667 };	///< weighting values to make various and fixed delay values easily
-	double sampleRate = 0.0;	///< current sample rate
+		// --- nested APFs, LPFs and the fixed delay writes, all branches at once
+		for (uint32_t i = 0; i < NUM_BRANCHES; i++)
+		{
+			// --- triangle LFO, +1 at phase 0 so an unmodulated branch sits at its full delay
+			double lfo = 2.0*fabs(2.0*lfoPhase[i] - 1.0) - 1.0;
+			lfoPhase[i] += lfoPhaseInc[i];
+			lfoPhase[i] -= lfoPhase[i] >= 1.0 ? 1.0 : 0.0;
+
+			// --- modulated, interpolated outer read: w(n-D)
+			double delay = outerDelay_Samples[i] - (0.5 - 0.5*lfo)*outerModulation_Samples[i];
+			unsigned int delayInt = (unsigned int)delay;
+			double fraction = delay - (double)delayInt;
+			double y1 = outerAPFBank[((w - 1 - delayInt) & mask)*NUM_BRANCHES + i];
+			double y2 = outerAPFBank[((w - 2 - delayInt) & mask)*NUM_BRANCHES + i];
+			double wnD = y1 + fraction*(y2 - y1);
+
+			// --- form w(n) = x(n) + gw(n-D) and run it through the inner APF
+			double wn = input[i] + outerAPF_g*wnD;
+			double innerWnD = innerAPFBank[((w - 1 - innerDelay_Samples[i]) & mask)*NUM_BRANCHES + i];
+			double innerWn = wn + innerAPF_g*innerWnD;
+			double innerYn = -innerAPF_g*innerWn + innerWnD;
+			innerAPFBank[w*NUM_BRANCHES + i] = innerWn;
+			outerAPFBank[w*NUM_BRANCHES + i] = innerYn;
+
+			// --- form y(n) = -gw(n) + w(n-D); flush underflow without a branch
+			double apfOut = -outerAPF_g*wn + wnD;
+			apfOut = fabs(apfOut) < kSmallestPositiveFloatValue ? 0.0 : apfOut;
+
+			// --- one pole LPF into the fixed delay
+			lpfState[i] = (1.0 - lpf_g)*apfOut + lpf_g*lpfState[i];
+			fixedDelayBank[w*NUM_BRANCHES + i] = lpfState[i];
+		}
+
+		// --- gather outputs after the writes
+		/*
+		There are 25 prime numbers between 1 and 100.
+		They are 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41,
+		43, 47, 53, 59, 61, 67, 71, 73, 79, 83, 89, and 97
+
+		we want 16 of them: 23, 29, 31, 37, 41,
+		43, 47, 53, 59, 61, 67, 71, 73, 79, 83, 89, and 97
+		*/
+		const double weight = 0.707;
+		double left = 0.0;
+		double right = 0.0;
+		for (uint32_t i = 0; i < NUM_BRANCHES; i++)
+		{
+			double sign = (i & 1) ? -weight : weight;
+			left += sign*(fixedDelayBank[((w - tapLeft_Samples[0][i]) & mask)*NUM_BRANCHES + i] +
+				tapGain*fixedDelayBank[((w - tapLeft_Samples[1][i]) & mask)*NUM_BRANCHES + i]);
+			right -= sign*(fixedDelayBank[((w - tapRight_Samples[0][i]) & mask)*NUM_BRANCHES + i] +
+				tapGain*fixedDelayBank[((w - tapRight_Samples[1][i]) & mask)*NUM_BRANCHES + i]);
+		}
+
+		writeIndex = (w + 1) & mask;
+		outL = left;
+		outR = right;
+	}
 };
 
 
+// --- true-peak detection: 4x oversampled, TRUE_PEAK_TAPS taps per phase
+const uint32_t TRUE_PEAK_OVERSAMPLING = 4;
+const uint32_t TRUE_PEAK_TAPS = 12;
+
+// --- longest PeakLimiter lookahead; the lookahead line is created once in reset( )
+const double PEAK_LIMITER_MAX_LOOKAHEAD_mSec = 5.0;
+
+/**
+\class TruePeakDetector
+\ingroup FX-Objects
+\brief
+The TruePeakDetector object estimates the inter-sample peaks of a signal: each sample interval is interpolated
+at TRUE_PEAK_OVERSAMPLING - 1 points with a Hann-windowed sinc, and the output is the largest magnitude found.
+
+- the estimate is getLatency( ) = TRUE_PEAK_TAPS/2 samples late (the interpolator is centred)
+- blocks are at most DYNAMICS_BLOCK_SIZE samples; the taps and phases are fixed-length loops
+
+Audio I/O:
+- Processes mono input to a (linear) peak magnitude output.
+
+\author Will Pirkle http://www.willpirkle.com
+\remark This object is included in Designing Audio Effects Plugins in C++ 2nd Ed. by Will Pirkle
+\version Revision : 1.0
+\date Date : 2018 / 09 / 7
+*/
+class TruePeakDetector
+{
+public:
+	TruePeakDetector()	/* C-TOR */
+	{
+		// --- phase p interpolates at centre + p/TRUE_PEAK_OVERSAMPLING; each phase has unity DC gain
+		const double centre = (double)(TRUE_PEAK_TAPS / 2 - 1);
+		const double halfWidth = (double)(TRUE_PEAK_TAPS / 2);
+		for (uint32_t p = 0; p < TRUE_PEAK_OVERSAMPLING - 1; p++)
+		{
+			double position = centre + (double)(p + 1) / (double)TRUE_PEAK_OVERSAMPLING;
+			double sum = 0.0;
+			for (uint32_t k = 0; k < TRUE_PEAK_TAPS; k++)
+			{
+				double t = position - (double)k;
+				double sinc = sin(kPi*t) / (kPi*t);
+				double window = 0.5*(1.0 + cos(kPi*t / halfWidth));
+				coeffs[p][k] = sinc*window;
+				sum += coeffs[p][k];
+			}
+			for (uint32_t k = 0; k < TRUE_PEAK_TAPS; k++)
+				coeffs[p][k] /= sum;
+		}
+	}
+	~TruePeakDetector() {}	/* D-TOR */
+
+	/** clear the interpolator history */
+	void reset() { memset(&history[0], 0, sizeof(history)); }
+
+	/** samples between an input peak and its estimate */
+	uint32_t getLatency() { return TRUE_PEAK_TAPS / 2; }
+
+	/** peak magnitude of each sample interval; blockSize <= DYNAMICS_BLOCK_SIZE, input and output may be the same buffer */
+	void processBlock(const double* input, double* output, uint32_t blockSize)
+	{
+		if (blockSize > DYNAMICS_BLOCK_SIZE)
+			blockSize = DYNAMICS_BLOCK_SIZE;
+
+		// --- history is [last TRUE_PEAK_TAPS - 1 samples | block]
+		for (uint32_t n = 0; n < blockSize; n++)
+			history[TRUE_PEAK_TAPS - 1 + n] = input[n];
+
+		for (uint32_t n = 0; n < blockSize; n++)
+		{
+			const double* x = &history[n];
+			double peak = fabs(x[TRUE_PEAK_TAPS / 2 - 1]);
+			for (uint32_t p = 0; p < TRUE_PEAK_OVERSAMPLING - 1; p++)
+			{
+				double y = 0.0;
+				for (uint32_t k = 0; k < TRUE_PEAK_TAPS; k++)
+					y += coeffs[p][k] * x[k];
+				peak = fmax(peak, fabs(y));
+			}
+			output[n] = peak;
+		}
+
+		for (uint32_t k = 0; k < TRUE_PEAK_TAPS - 1; k++)
+			history[k] = history[blockSize + k];
+	}
+
+private:
+	double coeffs[TRUE_PEAK_OVERSAMPLING - 1][TRUE_PEAK_TAPS] = { { 0.0 } };	///< interpolator phases
+	double history[TRUE_PEAK_TAPS - 1 + DYNAMICS_BLOCK_SIZE] = { 0.0 };		///< input history + block
+};
+
 /**
 \class PeakLimiter
 \ingroup FX-Objects
@@ -5003,10 +6287,15 @@ versio of the DynamicsProcessor
 
 Audio I/O:
 - Processes mono input to mono output.
+- processBlock( ) is the double block path: block detection, gain in the fast log2/exp2 domain, and the
+  optional lookahead and true-peak detection (these two apply to processBlock( ) only)
 
 Control I/F:
 - setThreshold_dB(double _threshold_dB) to adjust the limiter threshold
 - setMakeUpGain_dB(double _makeUpGain_dB) to adjust the makeup gain
+- setLookahead_mSec(double _lookahead_mSec) to delay the audio against its gain, up to PEAK_LIMITER_MAX_LOOKAHEAD_mSec
+- enableTruePeak(bool _truePeak) to detect the inter-sample peaks (see TruePeakDetector); the audio is
+  delayed by the detector latency as well so the gain stays aligned
 
 \author Will Pirkle http://www.willpirkle.com
 \remark This object is included in Designing Audio Effects Plugins in C++ 2nd Ed. by Will Pirkle
@@ -5033,6 +6322,12 @@ public:
 		detectorParams.detectMode = ENVELOPE_DETECT_MODE_PEAK;
 		detector.setParameters(detectorParams);
 
+		// --- lookahead line: longest lookahead plus the true-peak latency
+		sampleRate = _sampleRate;
+		lookaheadBuffer.createCircularBuffer((unsigned int)(PEAK_LIMITER_MAX_LOOKAHEAD_mSec*sampleRate / 1000.0) + truePeakDetector.getLatency() + 1);
+		truePeakDetector.reset();
+		updateLookahead();
+
 		return true;
 	}
 
@@ -5049,8 +6344,70 @@ public:
 		return dB2Raw(makeUpGain_dB)*xn*computeGain(detector.processAudioSample(xn));
 	}
 
+	/** process a block; the makeup gain is computed once */
+	virtual void processAudioBlock(const float* input, float* output, uint32_t blockSize)
+	{
+		double makeUpGain = dB2Raw(makeUpGain_dB);
+		for (uint32_t i = 0; i < blockSize; i++)
+		{
+			double xn = input[i];
+			output[i] = (float)(makeUpGain*xn*computeGain(detector.processAudioSample(xn)));
+		}
+	}
+
+	/** process a double block: detection, gain computer and DCA run as passes over DYNAMICS_BLOCK_SIZE chunks;
+	    input and output may be the same buffer */
+	/**
+	\param input input samples
+	\param output processed samples
+	\param blockSize number of samples
+	*/
+	void processBlock(const double* input, double* output, uint32_t blockSize)
+	{
+		for (uint32_t offset = 0; offset < blockSize; offset += DYNAMICS_BLOCK_SIZE)
+		{
+			uint32_t frames = blockSize - offset < DYNAMICS_BLOCK_SIZE ? blockSize - offset : DYNAMICS_BLOCK_SIZE;
+
+			// --- sample peaks, or the inter-sample peaks
+			if (truePeak)
+			{
+				truePeakDetector.processBlock(&input[offset], detectBlock, frames);
+				detector.processBlock(detectBlock, detectBlock, frames);
+			}
+			else
+				detector.processBlock(&input[offset], detectBlock, frames);
+
+			// --- makeup gain folded into the dB value; the conversion is a flat pass of its own
+			for (uint32_t i = 0; i < frames; i++)
+				gainBlock[i] = computeGainReduction_dB(detectBlock[i]) + makeUpGain_dB;
+			for (uint32_t i = 0; i < frames; i++)
+				gainBlock[i] = fastdB2Raw(gainBlock[i]);
+
+			if (lookaheadSamples == 0)
+			{
+				for (uint32_t i = 0; i < frames; i++)
+					output[offset + i] = input[offset + i] * gainBlock[i];
+				continue;
+			}
+
+			// --- lookahead: the audio is late, so the gain arrives ahead of the peak
+			for (uint32_t i = 0; i < frames; i++)
+			{
+				lookaheadBuffer.writeBuffer(input[offset + i]);
+				output[offset + i] = lookaheadBuffer.readBuffer((int)lookaheadSamples) * gainBlock[i];
+			}
+		}
+	}
+
 	/** compute the gain reductino value based on detected value in dB */
 	double computeGain(double detect_dB)
+	{
+		// --- convert difference between threshold and detected to raw
+		return  pow(10.0, computeGainReduction_dB(detect_dB) / 20.0);
+	}
+
+	/** the gain computer: gain reduction in dB for a detected value in dB */
+	inline double computeGainReduction_dB(double detect_dB)
 	{
 		double output_dB = 0.0;
 
@@ -5082,8 +6439,7 @@ public:
 				output_dB = threshold_dB;
 		}
 
-		// --- convert difference between threshold and detected to raw
-		return  pow(10.0, (output_dB - detect_dB) / 20.0);
+		return output_dB - detect_dB;
 	}
 
 	/** adjust threshold in dB */
@@ -5092,10 +6448,50 @@ public:
 	/** adjust makeup gain in dB*/
 	void setMakeUpGain_dB(double _makeUpGain_dB) { makeUpGain_dB = _makeUpGain_dB; }
 
+	/** adjust the lookahead in mSec; processBlock( ) only */
+	void setLookahead_mSec(double _lookahead_mSec)
+	{
+		lookahead_mSec = _lookahead_mSec;
+		updateLookahead();
+	}
+
+	/** detect inter-sample peaks; processBlock( ) only */
+	void enableTruePeak(bool _truePeak)
+	{
+		if (_truePeak && !truePeak)
+			truePeakDetector.reset();
+		truePeak = _truePeak;
+		updateLookahead();
+	}
+
+	/** total delay of processBlock( ) in samples (lookahead + true-peak latency) */
+	uint32_t getLatency() { return lookaheadSamples; }
+
+	/** place the lookahead line in an arena (see DelayMemoryArena) */
+	void setDelayMemoryArena(DelayMemoryArena* arena) { lookaheadBuffer.setDelayMemoryArena(arena); }
+
 protected:
 	AudioDetector detector;		///< the detector object
 	double threshold_dB = 0.0;	///< stored threshold (dB)
 	double makeUpGain_dB = 0.0;	///< stored makeup gain (dB)
+
+	// --- block path
+	double sampleRate = 0.0;			///< stored sample rate
+	double lookahead_mSec = 0.0;		///< stored lookahead (mSec)
+	bool truePeak = false;				///< inter-sample peak detection
+	uint32_t lookaheadSamples = 0;		///< audio delay in samples
+	CircularBuffer<double> lookaheadBuffer;	///< lookahead line
+	TruePeakDetector truePeakDetector;	///< inter-sample peak estimate
+	double detectBlock[DYNAMICS_BLOCK_SIZE] = { 0.0 };	///< detected level (dB)
+	double gainBlock[DYNAMICS_BLOCK_SIZE] = { 0.0 };	///< gain (raw)
+
+	/** lookahead in samples; the true-peak latency is added so the gain stays aligned with the audio */
+	void updateLookahead()
+	{
+		double lookahead = lookahead_mSec;
+		boundValue(lookahead, 0.0, PEAK_LIMITER_MAX_LOOKAHEAD_mSec);
+		lookaheadSamples = (uint32_t)(lookahead*sampleRate / 1000.0) + (truePeak ? truePeakDetector.getLatency() : 0);
+	}
 };
 
 
@@ -5229,21 +6625,36 @@ public:
 	*/
 	virtual double processAudioSample(double xn)
 	{
-		// --- with gain comp enabled, we reduce the input by
-		//     half the gain in dB at resonant peak
-		//     NOTE: you can change that logic here!
-		vaFilterAlgorithm filterAlgorithm = zvaFilterParameters.filterAlgorithm;
-		bool matchAnalogNyquistLPF = zvaFilterParameters.matchAnalogNyquistLPF;
+		return processFilter(xn*getInputGainComp(), pow(10.0, zvaFilterParameters.filterOutputGain_dB / 20.0));
+	}
+
+	/** process a block; the input gain compensation and output gain are computed once */
+	virtual void processAudioBlock(const float* input, float* output, uint32_t blockSize)
+	{
+		double inputGain = getInputGainComp();
+		double filterOutputGain = pow(10.0, zvaFilterParameters.filterOutputGain_dB / 20.0);
+		for (uint32_t i = 0; i < blockSize; i++)
+			output[i] = (float)processFilter(input[i] * inputGain, filterOutputGain);
+	}
 
+	/** with gain comp enabled, we reduce the input by half the gain in dB at resonant peak
+	    NOTE: you can change that logic here! */
+	double getInputGainComp()
+	{
 		if (zvaFilterParameters.enableGainComp)
 		{
 			double peak_dB = dBPeakGainFor_Q(zvaFilterParameters.Q);
 			if (peak_dB > 0.0)
-			{
-				double halfPeak_dBGain = dB2Raw(-peak_dB / 2.0);
-				xn *= halfPeak_dBGain;
-			}
+				return dB2Raw(-peak_dB / 2.0);
 		}
+		return 1.0;
+	}
+
+	/** the filter kernel: input is already gain-compensated */
+	inline double processFilter(double xn, double filterOutputGain)
+	{
+		vaFilterAlgorithm filterAlgorithm = zvaFilterParameters.filterAlgorithm;
+		bool matchAnalogNyquistLPF = zvaFilterParameters.matchAnalogNyquistLPF;
 
 		// --- for 1st order filters:
 		if (filterAlgorithm == vaFilterAlgorithm::kLPF1 ||
@@ -5306,8 +6717,6 @@ public:
 		integrator_z[0] = alpha*hpf + bpf;
 		integrator_z[1] = alpha*bpf + lpf;
 
-		double filterOutputGain = pow(10.0, zvaFilterParameters.filterOutputGain_dB / 20.0);
-
 		// return our selected type
 		if (filterAlgorithm == vaFilterAlgorithm::kSVF_LP)
 		{
@@ -8672,7 +10081,7 @@ protected:
 
 
 // ------------------------------------------------------------------ //
-// --- OBJECTS REQUIRING FFTW --------------------------------------- //
+// --- FFT OBJECTS (built-in FFT, FFTW optional) -------------------- //
 // ------------------------------------------------------------------ //
 
 /**
@@ -8746,15 +10155,15 @@ inline std::unique_ptr<double[]> makeWindow(unsigned int windowLength, unsigned
 	return windowBuffer;
 }
 
-// --- FFTW ---
-#ifdef HAVE_FFTW
-#include "fftw3.h"
+// --- FFT: built-in engine; define HAVE_FFTW to run the transforms with FFTW
+#include "fftengine.h"
 
 /**
 \class FastFFT
 \ingroup FFTW-Objects
 \brief
-The FastFFT provides a simple wrapper for the FFTW FFT operation - it is ultra-thin and simple to use.
+The FastFFT provides a simple wrapper for the FFT operation - it is ultra-thin and simple to use.
+The transforms run on the shared FFTEngine (FFTW if HAVE_FFTW is defined).
 
 Audio I/O:
 - processes mono inputs into FFT outputs.
@@ -8779,26 +10188,33 @@ public:
 	/** setup the FFT for a given framelength and window type*/
 	void initialize(unsigned int _frameLength, windowType _window);
 
-	/** destroy FFTW objects and plans */
+	/** destroy FFT arrays */
 	void destroyFFTW();
 
 	/** do the FFT and return real and imaginary arrays */
-	fftw_complex* doFFT(double* inputReal, double* inputImag = nullptr);
+	fftComplex* doFFT(double* inputReal, double* inputImag = nullptr);
 
 	/** do the IFFT and return real and imaginary arrays */
-	fftw_complex* doInverseFFT(double* inputReal, double* inputImag);
+	fftComplex* doInverseFFT(double* inputReal, double* inputImag);
+
+	/** do the FFT of real data and return the half spectrum: getNumBins( ) = N/2 + 1 bins */
+	fftComplex* doRealFFT(double* input);
+
+	/** do the IFFT of a half spectrum (N/2 + 1 bins) and return the N real points */
+	double* doInverseRealFFT(fftComplex* input);
 
 	/** get the current FFT length */
 	unsigned int getFrameLength() { return frameLength; }
 
+	/** get the number of bins in a half spectrum */
+	unsigned int getNumBins() { return frameLength / 2 + 1; }
+
 protected:
-	// --- setup FFTW
-	fftw_complex*	fft_input = nullptr;		///< array for FFT input
-	fftw_complex*	fft_result = nullptr;		///< array for FFT output
-	fftw_complex*	ifft_input = nullptr;		///< array for IFFT input
-	fftw_complex*	ifft_result = nullptr;		///< array for IFFT output
-	fftw_plan       plan_forward = nullptr;		///< FFTW plan for FFT
-	fftw_plan		plan_backward = nullptr;	///< FFTW plan for IFFT
+	// --- FFT arrays; the transforms run in place
+	fftComplex*		fft_result = nullptr;		///< array for FFT output
+	fftComplex*		ifft_result = nullptr;		///< array for IFFT output
+	double*			ifft_real_result = nullptr;	///< array for real IFFT output
+	FFTEngine		fftEngine;					///< FFT of frameLength, tables are shared
 
 	double* windowBuffer = nullptr;				///< buffer for window (naked)
 	double windowGainCorrection = 1.0;			///< window gain correction
@@ -8840,23 +10256,37 @@ public:
 	/** setup the FFT for a given framelength and window type*/
 	void initialize(unsigned int _frameLength, unsigned int _hopSize, windowType _window);
 
-	/** destroy FFTW objects and plans */
+	/** allocate for frames up to maxFrameLength, so initialize( ) within it does not allocate */
+	void reserve(unsigned int maxFrameLength);
+
+	/** clear the input and output timelines and restart the frame; keeps the frame setup */
+	void reset();
+
+	/** destroy FFT arrays */
 	void destroyFFTW();
 
 	/** process audio sample through vocode; check fftReady flag to access FFT output */
 	double processAudioSample(double input, bool& fftReady);
 
+	/** process a block of samples up to the next FFT; returns the number of samples processed,
+	    check fftReady flag to access FFT output */
+	unsigned int processAudioBlock(const double* input, double* output, unsigned int blockSize, bool& fftReady);
+
+	/** get the number of samples until the next FFT (blocks of this size or less end on it) */
+	unsigned int getSamplesToNextFFT() { return frameLength - fftCounter; }
+
 	/** add zero-padding without advancing output read location, for fast convolution */
 	bool addZeroPad(unsigned int count);
 
 	/** increment the FFT counter and do the FFT if it is ready */
 	bool advanceAndCheckFFT();
 
-	/** get FFT data for manipulation (yes, naked pointer so you can manipulate) */
-	fftw_complex* getFFTData() { return fft_result; }
+	/** get FFT data for manipulation (yes, naked pointer so you can manipulate); this is the
+	    half spectrum of the real input, getNumBins( ) = N/2 + 1 bins */
+	fftComplex* getFFTData() { return fft_result; }
 
-	/** get IFFT data for manipulation (yes, naked pointer so you can manipulate) */
-	fftw_complex* getIFFTData() { return ifft_result; }
+	/** get IFFT data for manipulation (yes, naked pointer so you can manipulate); N real points */
+	double* getIFFTData() { return ifft_result; }
 
 	/** do the inverse FFT (optional; will be called automatically if not used) */
 	void doInverseFFT();
@@ -8867,6 +10297,9 @@ public:
 	/** get current FFT length */
 	unsigned int getFrameLength() { return frameLength; }
 
+	/** get the number of bins in the FFT data */
+	unsigned int getNumBins() { return frameLength / 2 + 1; }
+
 	/** get current hop size ha = hs */
 	unsigned int getHopSize() { return hopSize; }
 
@@ -8879,12 +10312,14 @@ public:
 	void setOverlapAddOnly(bool b){ bool overlapAddOnly = b; }
 
 protected:
-	// --- setup FFTW
-	fftw_complex*	fft_input = nullptr;		///< array for FFT input
-	fftw_complex*	fft_result = nullptr;		///< array for FFT output
-	fftw_complex*	ifft_result = nullptr;		///< array for IFFT output
-	fftw_plan       plan_forward = nullptr;		///< FFTW plan for FFT
-	fftw_plan		plan_backward = nullptr;	///< FFTW plan for IFFT
+	/** (re)allocate every array for a frame length */
+	void allocateBuffers(unsigned int capacity);
+
+	// --- FFT arrays; audio is real so the spectrum is stored as N/2 + 1 bins (r2c/c2r)
+	double*			fft_input = nullptr;		///< array for FFT input (windowed frame)
+	fftComplex*		fft_result = nullptr;		///< array for FFT output
+	double*			ifft_result = nullptr;		///< array for IFFT output
+	FFTEngine		fftEngine;					///< FFT of frameLength, tables are shared
 
 	// --- linear buffer for window
 	double*			windowBuffer = nullptr;		///< array for window
@@ -8914,6 +10349,7 @@ protected:
 
 	// --- counters
 	unsigned int frameLength = 0;				///< current FFT length
+	unsigned int frameCapacity = 0;				///< allocated FFT length (>= frameLength)
 	unsigned int fftCounter = 0;				///< FFT sample counter
 
 	// --- hop-size and overlap (mathematically related)
@@ -8956,7 +10392,7 @@ public:
 			delete[] filterIR;
 
 		if (filterFFT)
-			fftw_free(filterFFT);
+			delete[] filterFFT;
 	}	/* D-TOR */
 
 	/** setup the FFT for a given IR length */
@@ -8981,11 +10417,11 @@ public:
 		filterIR = new double[filterImpulseLength * 2];
 		memset(&filterIR[0], 0, filterImpulseLength * 2 * sizeof(double));
 
-		// --- allocate the filter FFT arrays
+		// --- allocate the filter FFT arrays: half spectrum of the 2x length FFT
 		if(filterFFT)
-			fftw_free(filterFFT);
+			delete[] filterFFT;
 
-		 filterFFT = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * filterImpulseLength * 2);
+		 filterFFT = new fftComplex[filterImpulseLength + 1];
 
 		 // --- reset
 		 inputCount = 0;
@@ -9005,20 +10441,13 @@ public:
 			filterIR[i] = irBuffer[i];
 		}
 
-		// --- take FFT of the h(n)
-		fftw_complex* fftOfFilter = filterFastFFT.doFFT(&filterIR[0]);
+		// --- take FFT of the h(n); it is real so only the half spectrum is kept
+		fftComplex* fftOfFilter = filterFastFFT.doRealFFT(&filterIR[0]);
 
 		// --- copy the FFT into our local buffer for storage; also
 		//     we never want to hold a pointer to a FFT output
 		//     for more than one local function's worth
-		//     could replace with memcpy( )
-		for (int i = 0; i < 2; i++)
-		{
-			for (unsigned int j = 0; j < filterImpulseLength * 2; j++)
-			{
-				filterFFT[j][i] = fftOfFilter[j][i];
-			}
-		}
+		memcpy(&filterFFT[0][0], &fftOfFilter[0][0], (filterImpulseLength + 1) * sizeof(fftComplex));
 	}
 
 	/** process an input sample through convolver */
@@ -9034,13 +10463,11 @@ public:
 			if (fftReady) // should happen on time
 			{
 				// --- multiply our filter IR with the vocoder FFT
-				fftw_complex* signalFFT = vocoder.getFFTData();
+				fftComplex* signalFFT = vocoder.getFFTData();
 				if (signalFFT)
 				{
-					unsigned int fff = vocoder.getFrameLength();
-
-					// --- complex multiply with FFT of IR
-					for (unsigned int i = 0; i < filterImpulseLength * 2; i++)
+					// --- complex multiply with FFT of IR; both are half spectra
+					for (unsigned int i = 0; i < filterImpulseLength + 1; i++)
 					{
 						// --- get real/imag parts of each FFT
 						ComplexNumber signal(signalFFT[i][0], signalFFT[i][1]);
@@ -9076,76 +10503,48 @@ public:
 protected:
 	PhaseVocoder vocoder;				///< vocoder object
 	FastFFT filterFastFFT;				///< FastFFT object
-	fftw_complex* filterFFT = nullptr;	///< filterFFT output arrays
+	fftComplex* filterFFT = nullptr;	///< filterFFT output arrays
 	double* filterIR = nullptr;			///< filter IR
 	unsigned int inputCount = 0;		///< input sample counter
 	unsigned int filterImpulseLength = 0;///< IR length
 };
 
 // --- PSM Vocoder
-const unsigned int PSM_FFT_LEN = 4096;
+const unsigned int PSM_FFT_LEN = 4096;						///< largest (and default) frame
+const unsigned int PSM_MIN_FFT_LEN = 256;					///< smallest custom frame
+const unsigned int PSM_BLOCK_SIZE = 64;					///< internal chunk for block processing
+const unsigned int PSM_MAX_OUTPUT_LEN = PSM_FFT_LEN * 4;	///< resampled largest frame two octaves down
 
 /**
-\struct BinData
-\ingroup FFTW-Objects
+\enum psmVocoderQuality
+\ingroup Constants-Enums
 \brief
-Custom structure that holds information about each FFT bin. This includes all information
-needed to perform pitch shifting and time stretching with phase locking (optional)
-and peak tracking (optional).
+Use this strongly typed enum to set the frame and hop sizes of the PSMVocoder; the latency is one frame.
+
+- kHighQuality : 4096 / 1024 (93 mSec at 44.1kHz)
+- kNormal : 2048 / 512 (46 mSec)
+- kLowLatency : 1024 / 256 (23 mSec)
+- kCustom : PSMVocoderParameters::frameLength and hopSize
+
+- enum class psmVocoderQuality { kHighQuality, kNormal, kLowLatency, kCustom };
 
 \author Will Pirkle http://www.willpirkle.com
 \remark This object is included in Designing Audio Effects Plugins in C++ 2nd Ed. by Will Pirkle
 \version Revision : 1.0
 \date Date : 2018 / 09 / 7
 */
-struct BinData
-{
-	BinData() {}
-	/** all FXObjects parameter objects require overloaded= operator so remember to add new entries if you add new variables. */
-	BinData& operator=(const BinData& params)	// need this override for collections to work
-	{
-		if (this == &params)
-			return *this;
-
-		isPeak = params.isPeak;
-		magnitude = params.magnitude;
-		phi = params.phi;
-
-		psi = params.psi;
-		localPeakBin = params.localPeakBin;
-		previousPeakBin = params.previousPeakBin;
-		updatedPhase = params.updatedPhase;
-
-		return *this;
-	}
-
-	/** reset all variables to 0.0 */
-	void reset()
-	{
-		isPeak = false;
-		magnitude = 0.0;
-		phi = 0.0;
-
-		psi = 0.0;
-		localPeakBin = 0;
-		previousPeakBin = -1; // -1 is flag
-		updatedPhase = 0.0;
-	}
-
-	bool isPeak = false;	///< flag for peak bins
-	double magnitude = 0.0; ///< bin magnitude angle
-	double phi = 0.0;		///< bin phase angle
-	double psi = 0.0;		///< bin phase correction
-	unsigned int localPeakBin = 0; ///< index of peak-boss
-	int previousPeakBin = -1; ///< index of peak bin in previous FFT
-	double updatedPhase = 0.0; ///< phase update value
-};
+enum class psmVocoderQuality { kHighQuality, kNormal, kLowLatency, kCustom };
 
 /**
 \struct PSMVocoderParameters
 \ingroup FFTW-Objects
 \brief
-Custom parameter structure for the Biquad object. Default version defines the biquad structure used in the calculation.
+Custom parameter structure for the PSMVocoder object.
+
+- quality sets the frame and hop sizes; with kCustom, frameLength must be a power of 2 in
+  [PSM_MIN_FFT_LEN, PSM_FFT_LEN] and hopSize at most frameLength / 2
+- wetLevel_dB and dryLevel_dB mix the shifted signal with the input, delayed to line up; the
+  default is the shifted signal only
 
 \author Will Pirkle http://www.willpirkle.com
 \remark This object is included in Designing Audio Effects Plugins in C++ 2nd Ed. by Will Pirkle
@@ -9164,6 +10563,11 @@ struct PSMVocoderParameters
 		pitchShiftSemitones = params.pitchShiftSemitones;
 		enablePeakPhaseLocking = params.enablePeakPhaseLocking;
 		enablePeakTracking = params.enablePeakTracking;
+		quality = params.quality;
+		frameLength = params.frameLength;
+		hopSize = params.hopSize;
+		wetLevel_dB = params.wetLevel_dB;
+		dryLevel_dB = params.dryLevel_dB;
 
 		return *this;
 	}
@@ -9172,6 +10576,11 @@ struct PSMVocoderParameters
 	double pitchShiftSemitones = 0.0;	///< pitch shift in half-steps
 	bool enablePeakPhaseLocking = false;///< flag to enable phase lock
 	bool enablePeakTracking = false;	///< flag to enable peak tracking
+	psmVocoderQuality quality = psmVocoderQuality::kHighQuality; ///< frame/hop preset
+	unsigned int frameLength = PSM_FFT_LEN;	///< frame length for kCustom
+	unsigned int hopSize = PSM_FFT_LEN / 4;	///< hop size for kCustom
+	double wetLevel_dB = 0.0;			///< shifted signal level
+	double dryLevel_dB = -96.0;			///< input level; -96dB and below is off
 };
 
 /**
@@ -9182,11 +10591,23 @@ The PSMVocoder object implements a phase vocoder pitch shifter. Phase locking an
 are optional.
 
 Audio I/O:
-- Processes mono input to mono output.
+- Processes mono input to mono output, per sample or in blocks.
 
 Control I/F:
 - Use PSMVocoderParameters structure to get/set object params.
 
+Each frame is processed as flat loops over the N/2 + 1 bins (no per-bin structures):
+- magnitude/phase, then the unwrapped phase advance of every bin over the hop
+- peak picking is a branch-free compare against the two neighbours on each side (the magnitude
+  array has two zero guard bins at each end), followed by one pass that lists the peaks
+- peaks advance their phase (from the nearest peak of the last frame with tracking), and every bin
+  is locked to the peak of its region of influence: psi(k) = psi(peak) + phi(k) - phi(peak)
+
+The time-stretched frames are resampled by 1/alpha and overlap-added at the hop size; the
+synthesis gain is normalized so a steady tone comes out at its input level.
+
+Latency is one frame (see getLatency( )).
+
 \author Will Pirkle http://www.willpirkle.com
 \remark This object is included in Designing Audio Effects Plugins in C++ 2nd Ed. by Will Pirkle
 \version Revision : 1.0
@@ -9196,7 +10617,26 @@ class PSMVocoder : public IAudioSignalProcessor
 {
 public:
 	PSMVocoder() {
-		vocoder.initialize(PSM_FFT_LEN, PSM_FFT_LEN/4, windowType::kHannWindow);  // 75% overlap
+		// --- allocate once for the largest frame so that quality changes do not allocate
+		unsigned int maxBins = PSM_FFT_LEN / 2 + 1;
+		vocoder.reserve(PSM_FFT_LEN);
+		magnitudeBuffer.resize(maxBins + 4);
+		phase.resize(maxBins);
+		phi.resize(maxBins);
+		deltaPhi.resize(maxBins);
+		psi.resize(maxBins);
+		psiPrevious.resize(maxBins);
+		isPeak.resize(maxBins);
+		localPeakBin.resize(maxBins);
+		peakBins.resize(maxBins);
+		peakBinsPrevious.resize(maxBins);
+		dryDelay.resize(PSM_FFT_LEN);
+
+		outputBufferCapacity = PSM_MAX_OUTPUT_LEN;
+		windowBuff = new double[outputBufferCapacity];
+		outputBuff = new double[outputBufferCapacity];
+
+		setFrame(PSM_FFT_LEN, PSM_FFT_LEN / 4);  // 75% overlap
 	}		/* C-TOR */
 	~PSMVocoder() {
 		if (windowBuff) delete[] windowBuff;
@@ -9207,20 +10647,19 @@ public:
 	/** reset members to initialized state */
 	virtual bool reset(double _sampleRate)
 	{
-		memset(&phi[0], 0, sizeof(double)*PSM_FFT_LEN);
-		memset(&psi[0], 0, sizeof(double)* PSM_FFT_LEN);
+		// --- the vocoder's timelines hold the last frame's input and the overlap-add tail
+		vocoder.reset();
+
+		std::fill(phi.begin(), phi.end(), 0.0);
+		std::fill(psi.begin(), psi.end(), 0.0);
+		std::fill(psiPrevious.begin(), psiPrevious.end(), 0.0);
+		std::fill(dryDelay.begin(), dryDelay.end(), 0.0);
 		if(outputBuff)
 			memset(outputBuff, 0, sizeof(double)*outputBufferLength);
 
-		for (int i = 0; i < PSM_FFT_LEN; i++)
-		{
-			binData[i].reset();
-			binDataPrevious[i].reset();
-
-			peakBins[i] = -1;
-			peakBinsPrevious[i] = -1;
-		}
-
+		numPeaks = 0;
+		numPreviousPeaks = 0;
+		dryIndex = 0;
 		return true;
 	}
 
@@ -9232,7 +10671,7 @@ public:
 	{
 		// --- this is costly so only update when things changed
 		double newAlpha = pow(2.0, semitones / 12.0);
-		double newOutputBufferLength = round((1.0/newAlpha)*(double)PSM_FFT_LEN);
+		double newOutputBufferLength = round((1.0/newAlpha)*(double)frameLength);
 
 		// --- check for change
 		if (newOutputBufferLength == outputBufferLength)
@@ -9240,369 +10679,364 @@ public:
 
 		// --- new stuff
 		alphaStretchRatio = newAlpha;
-		ha = hs / alphaStretchRatio;
 
 		// --- set output resample buffer
 		outputBufferLength = newOutputBufferLength;
 
-		// --- create Hann window
-		if (windowBuff) delete[] windowBuff;
-		windowBuff = new double[outputBufferLength];
-		windowCorrection = 0.0;
+		// --- only a shift of more than two octaves down outgrows the buffers from the C-TOR
+		if (outputBufferLength > outputBufferCapacity)
+		{
+			if (windowBuff) delete[] windowBuff;
+			if (outputBuff) delete[] outputBuff;
+			outputBufferCapacity = outputBufferLength;
+			windowBuff = new double[outputBufferCapacity];
+			outputBuff = new double[outputBufferCapacity];
+		}
+
+		// --- create Hann window; the correction normalizes the overlap-add of the
+		//     (resampled) analysis window times this window at the hop size, and the
+		//     N of the unscaled IFFT
+		double windowPower = 0.0;
 		for (unsigned int i = 0; i < outputBufferLength; i++)
 		{
 			windowBuff[i] = 0.5 * (1.0 - cos((i*2.0*kPi) / (outputBufferLength)));
-			windowCorrection += windowBuff[i];
+			windowPower += windowBuff[i] * windowBuff[i];
 		}
-		windowCorrection = 1.0 / windowCorrection;
+		windowCorrection = (double)hopSize / ((double)frameLength * windowPower);
 
-		// --- create output buffer
-		if (outputBuff) delete[] outputBuff;
-		outputBuff = new double[outputBufferLength];
+		// --- clear output buffer
 		memset(outputBuff, 0, sizeof(double)*outputBufferLength);
 	}
 
-	/** find bin index of nearest peak bin in previous FFT frame */
-	int findPreviousNearestPeak(int peakIndex)
+	/** process input sample through PSM vocoder */
+	/**
+	\param xn input
+	\return the processed sample
+	*/
+	virtual double processAudioSample(double input)
 	{
-		if (peakBinsPrevious[0] == -1) // first run, there is no peak
-			return -1;
+		double output = 0.0;
+		processBlock(&input, &output, 1);
+		return output;
+	}
 
-		int delta = -1;
-		int previousPeak = -1;
-		for (int i = 0; i < PSM_FFT_LEN; i++)
+	/** process a block through the PSM vocoder; input and output may be the same array */
+	void processBlock(const double* input, double* output, uint32_t blockSize)
+	{
+		double wet[PSM_BLOCK_SIZE];
+		uint32_t done = 0;
+		while (done < blockSize)
 		{
-			if (peakBinsPrevious[i] < 0)
-				break;
-
-			int dist = abs(peakIndex - peakBinsPrevious[i]);
-			if (dist > PSM_FFT_LEN/4)
+			// --- chunks end at the next frame so it is processed before the following samples
+			uint32_t count = blockSize - done < PSM_BLOCK_SIZE ? blockSize - done : PSM_BLOCK_SIZE;
+			bool fftReady = false;
+			count = vocoder.processAudioBlock(&input[done], &wet[0], count, fftReady);
+			if (count == 0)
 				break;
 
-			if (i == 0)
+			// --- mix; the dry signal is delayed by one frame to line up with the wet
+			const double* x = &input[done];
+			double* y = &output[done];
+			if (dryGain == 0.0)
 			{
-				previousPeak = i;
-				delta = dist;
+				for (uint32_t i = 0; i < count; i++)
+					y[i] = wetGain*wet[i];
 			}
-			else if (dist < delta)
+			else
 			{
-				previousPeak = i;
-				delta = dist;
+				for (uint32_t i = 0; i < count; i++)
+				{
+					double dry = dryDelay[dryIndex];
+					dryDelay[dryIndex] = x[i];
+					dryIndex = (dryIndex + 1) & dryMask;
+					y[i] = wetGain*wet[i] + dryGain*dry;
+				}
 			}
-		}
 
-		return previousPeak;
+			if (fftReady)
+				processFrame();
+
+			done += count;
+		}
 	}
 
-	/** identify peak bins and tag their respective regions of influence */
-	void findPeaksAndRegionsOfInfluence()
+	/** process a block of floats, see IAudioSignalProcessor */
+	virtual void processAudioBlock(const float* input, float* output, uint32_t blockSize)
 	{
-		// --- FIND PEAKS --- //
-		//
-		// --- find local maxima in 4-sample window
-		double localWindow[4] = { 0.0 };
-		int m = 0;
-		for (int i = 0; i < PSM_FFT_LEN; i++)
+		double buffer[PSM_BLOCK_SIZE];
+		uint32_t done = 0;
+		while (done < blockSize)
 		{
-			if (i == 0)
-			{
-				localWindow[0] = 0.0;
-				localWindow[1] = 0.0;
-				localWindow[2] = binData[i + 1].magnitude;
-				localWindow[3] = binData[i + 2].magnitude;
-			}
-			else  if (i == 1)
-			{
-				localWindow[0] = 0.0;
-				localWindow[1] = binData[i - 1].magnitude;
-				localWindow[2] = binData[i + 1].magnitude;
-				localWindow[3] = binData[i + 2].magnitude;
-			}
-			else  if (i == PSM_FFT_LEN - 1)
-			{
-				localWindow[0] = binData[i - 2].magnitude;
-				localWindow[1] = binData[i - 1].magnitude;
-				localWindow[2] = 0.0;
-				localWindow[3] = 0.0;
-			}
-			else  if (i == PSM_FFT_LEN - 2)
-			{
-				localWindow[0] = binData[i - 2].magnitude;
-				localWindow[1] = binData[i - 1].magnitude;
-				localWindow[2] = binData[i + 1].magnitude;
-				localWindow[3] = 0.0;
-			}
-			else
-			{
-				localWindow[0] = binData[i - 2].magnitude;
-				localWindow[1] = binData[i - 1].magnitude;
-				localWindow[2] = binData[i + 1].magnitude;
-				localWindow[3] = binData[i + 2].magnitude;
-			}
+			uint32_t count = blockSize - done < PSM_BLOCK_SIZE ? blockSize - done : PSM_BLOCK_SIZE;
+			for (uint32_t i = 0; i < count; i++)
+				buffer[i] = input[done + i];
 
-			// --- found peak bin!
-			if (binData[i].magnitude > 0.00001 &&
-				binData[i].magnitude > localWindow[0]
-				&& binData[i].magnitude > localWindow[1]
-				&& binData[i].magnitude > localWindow[2]
-				&& binData[i].magnitude > localWindow[3])
-			{
-				binData[i].isPeak = true;
-				peakBins[m++] = i;
+			processBlock(&buffer[0], &buffer[0], count);
 
-				// --- for peak bins, assume that it is part of a previous, moving peak
-				if (parameters.enablePeakTracking)
-					binData[i].previousPeakBin = findPreviousNearestPeak(i);
-				else
-					binData[i].previousPeakBin = -1;
-			}
+			for (uint32_t i = 0; i < count; i++)
+				output[done + i] = (float)buffer[i];
+			done += count;
 		}
+	}
 
-		// --- assign peak bosses
-		if (m > 0)
-		{
-			int n = 0;
-			int bossPeakBin = peakBins[n];
-			double nextPeak = peakBins[++n];
-			int midBoundary = (nextPeak - (double)bossPeakBin) / 2.0 + bossPeakBin;
+	/** get the latency in samples (one frame) */
+	unsigned int getLatency() { return frameLength; }
 
-			if (nextPeak >= 0)
-			{
-				for (int i = 0; i < PSM_FFT_LEN; i++)
-				{
-					if (i <= bossPeakBin)
-					{
-						binData[i].localPeakBin = bossPeakBin;
-					}
-					else if (i < midBoundary)
-					{
-						binData[i].localPeakBin = bossPeakBin;
-					}
-					else // > boundary, calc next set
-					{
-						bossPeakBin = nextPeak;
-						nextPeak = peakBins[++n];
-						if (nextPeak > bossPeakBin)
-							midBoundary = (nextPeak - (double)bossPeakBin) / 2.0 + bossPeakBin;
-						else // nextPeak == -1
-							midBoundary = PSM_FFT_LEN;
-
-						binData[i].localPeakBin = bossPeakBin;
-					}
-				}
-			}
-		}
+	/** get parameters: note use of custom structure for passing param data */
+	/**
+	\return PSMVocoderParameters custom data structure
+	*/
+	PSMVocoderParameters getParameters()
+	{
+		return parameters;
 	}
 
-	/** process input sample through PSM vocoder */
+	/** set parameters: note use of custom structure for passing param data */
 	/**
-	\param xn input
-	\return the processed sample
+	\param PSMVocoderParameters custom data structure
+	NOTE: a change of frame or hop size restarts the vocoder; the arrays are allocated for the largest frame
 	*/
-	virtual double processAudioSample(double input)
+	void setParameters(const PSMVocoderParameters& params)
 	{
-			bool fftReady = false;
-			double output = 0.0;
+		unsigned int newFrameLength = PSM_FFT_LEN;
+		unsigned int newHopSize = PSM_FFT_LEN / 4;
+		switch (params.quality)
+		{
+		case psmVocoderQuality::kNormal:
+			newFrameLength = 2048; newHopSize = 512;
+			break;
+		case psmVocoderQuality::kLowLatency:
+			newFrameLength = 1024; newHopSize = 256;
+			break;
+		case psmVocoderQuality::kCustom:
+			if (isPowerOfTwo(params.frameLength) && params.frameLength >= PSM_MIN_FFT_LEN && params.frameLength <= PSM_FFT_LEN &&
+				params.hopSize > 0 && params.hopSize <= params.frameLength / 2)
+			{
+				newFrameLength = params.frameLength;
+				newHopSize = params.hopSize;
+			}
+			break;
+		default:
+			break;
+		}
 
-			// --- normal processing
-			output = vocoder.processAudioSample(input, fftReady);
+		if (newFrameLength != frameLength || newHopSize != hopSize)
+		{
+			setFrame(newFrameLength, newHopSize);
+			if (params.pitchShiftSemitones != 0.0)
+				setPitchShift(params.pitchShiftSemitones);
+		}
+		else if (params.pitchShiftSemitones != parameters.pitchShiftSemitones)
+		{
+			setPitchShift(params.pitchShiftSemitones);
+		}
 
-			// --- if FFT is here, GO!
-			if (fftReady)
-			{
-			// --- get the FFT data
-			fftw_complex* fftData = vocoder.getFFTData();
+		wetGain = dB2Raw(params.wetLevel_dB);
+		dryGain = params.dryLevel_dB <= -96.0 ? 0.0 : dB2Raw(params.dryLevel_dB);
 
-			if (parameters.enablePeakPhaseLocking)
-			{
-				// --- get the magnitudes for searching
-				for (int i = 0; i < PSM_FFT_LEN; i++)
-				{
-					binData[i].reset();
-					peakBins[i] = -1;
+		// --- save
+		parameters = params;
+	}
 
-					// --- store mag and phase
-					binData[i].magnitude = getMagnitude(fftData[i][0], fftData[i][1]);
-					binData[i].phi = getPhase(fftData[i][0], fftData[i][1]);
-				}
+protected:
+	PSMVocoderParameters parameters;	///< object parameters
+	PhaseVocoder vocoder;				///< vocoder to perform PSM
+	double alphaStretchRatio = 1.0;		///< alpha stretch ratio = synthesis hop / analysis hop
+
+	// --- frame
+	unsigned int frameLength = 0;		///< N
+	unsigned int hopSize = 0;			///< analysis hop; 75% overlap = N/4
+	unsigned int numBins = 0;			///< N/2 + 1
+
+	// --- per-bin arrays (SoA)
+	std::vector<double> magnitudeBuffer;///< magnitudes with two zero guard bins at each end
+	double* magnitude = nullptr;		///< &magnitudeBuffer[2]
+	std::vector<double> phase;			///< phase of this frame
+	std::vector<double> phi;			///< phase of the last frame
+	std::vector<double> deltaPhi;		///< unwrapped phase advance over the hop
+	std::vector<double> psi;			///< synthesis phase of this frame
+	std::vector<double> psiPrevious;	///< synthesis phase of the last frame
+	std::vector<uint8_t> isPeak;		///< peak flags
+	std::vector<uint32_t> localPeakBin;	///< peak-boss of each bin
+
+	// --- peak lists, ascending
+	std::vector<uint32_t> peakBins;		///< peaks of this frame
+	std::vector<uint32_t> peakBinsPrevious;	///< peaks of the last frame
+	uint32_t numPeaks = 0;				///< peaks in this frame
+	uint32_t numPreviousPeaks = 0;		///< peaks in the last frame
+
+	// --- dry path
+	std::vector<double> dryDelay;		///< one frame of input
+	uint32_t dryIndex = 0;				///< dry delay index
+	uint32_t dryMask = 0;				///< dry delay wrap mask
+	double wetGain = 1.0;				///< wet level
+	double dryGain = 0.0;				///< dry level
 
-				findPeaksAndRegionsOfInfluence();
+	double* windowBuff = nullptr;			///< buffer for window
+	double* outputBuff = nullptr;			///< buffer for resampled output
+	double windowCorrection = 0.0;			///< window correction value
+	unsigned int outputBufferLength = 0;	///< lenght of resampled output array; 0 = no shift
+	unsigned int outputBufferCapacity = 0;	///< allocated length of the window and output buffers
+
+	/** set a frame and hop size (up to PSM_FFT_LEN) and restart; the resampler is rebuilt by setPitchShift( ) */
+	void setFrame(unsigned int _frameLength, unsigned int _hopSize)
+	{
+		frameLength = _frameLength;
+		hopSize = _hopSize;
+		numBins = frameLength / 2 + 1;
+		vocoder.initialize(frameLength, hopSize, windowType::kHannWindow);
+
+		// --- the arrays are sized for PSM_FFT_LEN in the C-TOR; only this frame's part is used
+		std::fill_n(magnitudeBuffer.begin(), numBins + 4, 0.0);
+		magnitude = &magnitudeBuffer[2];
+		std::fill_n(phase.begin(), numBins, 0.0);
+		std::fill_n(phi.begin(), numBins, 0.0);
+		std::fill_n(deltaPhi.begin(), numBins, 0.0);
+		std::fill_n(psi.begin(), numBins, 0.0);
+		std::fill_n(psiPrevious.begin(), numBins, 0.0);
+		std::fill_n(isPeak.begin(), numBins, 0);
+		std::fill_n(localPeakBin.begin(), numBins, 0);
+		std::fill_n(peakBins.begin(), numBins, 0);
+		std::fill_n(peakBinsPrevious.begin(), numBins, 0);
+		numPeaks = 0;
+		numPreviousPeaks = 0;
+
+		std::fill_n(dryDelay.begin(), frameLength, 0.0);
+		dryIndex = 0;
+		dryMask = frameLength - 1;
+
+		// --- no shift until setPitchShift( ): plain overlap-add in the vocoder
+		outputBufferLength = 0;
+		alphaStretchRatio = 1.0;
+	}
+
+	/** list the local maxima over +/-2 bins and tag the region of influence of each */
+	void findPeaksAndRegionsOfInfluence()
+	{
+		// --- flags first: branch-free so the loop vectorizes
+		const double threshold = 0.00001;
+		const double* m = magnitude;
+		for (int k = 0; k < (int)numBins; k++)
+		{
+			isPeak[k] = (uint8_t)((m[k] > threshold) & (m[k] > m[k - 2]) & (m[k] > m[k - 1]) &
+								  (m[k] > m[k + 1]) & (m[k] > m[k + 2]));
+		}
 
-				// --- each bin data should now know its local boss-peak
-				//
-				// --- now propagate phases accordingly
-				//
-				//     FIRST: set PSI angles of bosses
-				for (int i = 0; i < PSM_FFT_LEN; i++)
-				{
-					double mag_k = binData[i].magnitude;
-					double phi_k = binData[i].phi;
+		numPeaks = 0;
+		for (uint32_t k = 0; k < numBins; k++)
+		{
+			if (isPeak[k])
+				peakBins[numPeaks++] = k;
+		}
 
-					// --- horizontal phase propagation
-					//
-					// --- omega_k = bin frequency(k)
-					double omega_k = kTwoPi*i / PSM_FFT_LEN;
+		if (numPeaks == 0)
+			return;
 
-					// --- phase deviation is actual - expected phase
-					//     = phi_k -(phi(last frame) + wk*ha
-					double phaseDev = phi_k - phi[i] - omega_k*ha;
+		// --- each bin belongs to the nearest peak; the boundary is the midpoint between peaks
+		uint32_t start = 0;
+		for (uint32_t p = 0; p < numPeaks; p++)
+		{
+			uint32_t end = p + 1 < numPeaks ? (peakBins[p] + peakBins[p + 1] + 1) / 2 : numBins;
+			for (uint32_t k = start; k < end; k++)
+				localPeakBin[k] = peakBins[p];
+			start = end;
+		}
+	}
 
-					// --- unwrapped phase increment
-					double deltaPhi = omega_k*ha + principalArg(phaseDev);
+	/** modify the phases of the FFT frame, take the IFFT and overlap-add the resampled result */
+	void processFrame()
+	{
+		// --- get the FFT data
+		fftComplex* fftData = vocoder.getFFTData();
 
-					// --- save for next frame
-					phi[i] = phi_k;
+		// --- magnitude and phase
+		for (uint32_t k = 0; k < numBins; k++)
+		{
+			magnitude[k] = getMagnitude(fftData[k][0], fftData[k][1]);
+			phase[k] = getPhase(fftData[k][0], fftData[k][1]);
+		}
 
-					// --- if peak, assume it could have hopped from a different bin
-					if (binData[i].isPeak)
-					{
-						// --- calculate new phase based on stretch factor; save phase for next time
-						if(binData[i].previousPeakBin < 0)
-							psi[i] = principalArg(psi[i] + deltaPhi * alphaStretchRatio);
-						else
-							psi[i] = principalArg(psi[binDataPrevious[i].previousPeakBin] + deltaPhi * alphaStretchRatio);
-					}
+		// --- horizontal phase propagation: the frames are hopSize apart, so bin k is expected
+		//     to advance omega_k*hopSize; the deviation from that is the bin's frequency offset
+		const double omegaHop = kTwoPi*(double)hopSize / (double)frameLength;
+		for (uint32_t k = 0; k < numBins; k++)
+		{
+			double expected = omegaHop*(double)k;
+			deltaPhi[k] = expected + principalArg(phase[k] - phi[k] - expected);
+			phi[k] = phase[k];
+		}
 
-					// --- save peak PSI (new angle)
-					binData[i].psi = psi[i];
+		// --- time-stretch by alpha: the synthesis hop is alpha*hopSize
+		for (uint32_t k = 0; k < numBins; k++)
+			psi[k] = principalArg(psiPrevious[k] + deltaPhi[k] * alphaStretchRatio);
 
-					// --- for IFFT
-					binData[i].updatedPhase = binData[i].psi;
-				}
+		if (parameters.enablePeakPhaseLocking)
+		{
+			findPeaksAndRegionsOfInfluence();
 
-				// --- now set non-peaks
-				for (int i = 0; i < PSM_FFT_LEN; i++)
+			if (numPeaks > 0)
+			{
+				// --- peaks continue the nearest peak of the last frame, if it is close enough
+				if (parameters.enablePeakTracking && numPreviousPeaks > 0)
 				{
-					if (!binData[i].isPeak)
+					const uint32_t trackRange = frameLength / 256;
+					uint32_t q = 0;
+					for (uint32_t p = 0; p < numPeaks; p++)
 					{
-						int myPeakBin = binData[i].localPeakBin;
-
-						double PSI_kp = binData[myPeakBin].psi;
-						double phi_kp = binData[myPeakBin].phi;
+						uint32_t k = peakBins[p];
+						while (q + 1 < numPreviousPeaks && peakBinsPrevious[q + 1] <= k)
+							q++;
 
-						// --- save for next frame
-						// phi[i] = binData[myPeakBin].phi;
+						uint32_t source = peakBinsPrevious[q];
+						if (q + 1 < numPreviousPeaks && peakBinsPrevious[q + 1] - k < (source > k ? source - k : k - source))
+							source = peakBinsPrevious[q + 1];
 
-						// --- calculate new phase, locked to boss peak
-						psi[i] = principalArg(PSI_kp - phi_kp - binData[i].phi);
-						binData[i].updatedPhase = psi[i];// principalArg(PSI_kp - phi_kp - binData[i].phi);
+						uint32_t distance = source > k ? source - k : k - source;
+						if (distance <= trackRange)
+							psi[k] = principalArg(psiPrevious[source] + deltaPhi[k] * alphaStretchRatio);
 					}
 				}
 
-				for (int i = 0; i < PSM_FFT_LEN; i++)
-				{
-					double mag_k = binData[i].magnitude;
-
-					// --- convert back
-					fftData[i][0] = mag_k*cos(binData[i].updatedPhase);
-					fftData[i][1] = mag_k*sin(binData[i].updatedPhase);
-
-					// --- save for next frame
-					binDataPrevious[i] = binData[i];
-					peakBinsPrevious[i] = peakBins[i];
-
-				}
-			}// end if peak locking
-
-			else // ---> old school
-			{
-				for (int i = 0; i < PSM_FFT_LEN; i++)
+				// --- identity phase locking: every bin keeps its phase offset to its peak
+				for (uint32_t k = 0; k < numBins; k++)
 				{
-					double mag_k = getMagnitude(fftData[i][0], fftData[i][1]);
-					double phi_k = getPhase(fftData[i][0], fftData[i][1]);
-
-					// --- horizontal phase propagation
-					//
-					// --- omega_k = bin frequency(k)
-					double omega_k = kTwoPi*i / PSM_FFT_LEN;
-
-					// --- phase deviation is actual - expected phase
-					//     = phi_k -(phi(last frame) + wk*ha
-					double phaseDev = phi_k - phi[i] - omega_k*ha;
-
-					// --- unwrapped phase increment
-					double deltaPhi = omega_k*ha + principalArg(phaseDev);
-
-					// --- save for next frame
-					phi[i] = phi_k;
-
-					// --- calculate new phase based on stretch factor; save phase for next time
-					psi[i] = principalArg(psi[i] + deltaPhi * alphaStretchRatio);
-
-					// --- convert back
-					fftData[i][0] = mag_k*cos(psi[i]);
-					fftData[i][1] = mag_k*sin(psi[i]);
+					uint32_t peak = localPeakBin[k];
+					psi[k] = psi[peak] + phase[k] - phase[peak];
 				}
 			}
 
+			// --- save the peaks for tracking
+			peakBins.swap(peakBinsPrevious);
+			numPreviousPeaks = numPeaks;
+		}
 
-			// --- manually so the IFFT (OPTIONAL)
-			vocoder.doInverseFFT();
-
-			// --- can get the iFFT buffers
-			fftw_complex* inv_fftData = vocoder.getIFFTData();
-
-			// --- make copy (can speed this up)
-			double ifft[PSM_FFT_LEN] = { 0.0 };
-			for (int i = 0; i < PSM_FFT_LEN; i++)
-				ifft[i] = inv_fftData[i][0];
-
-			// --- resample the audio as if it were stretched
-			resample(&ifft[0], outputBuff, PSM_FFT_LEN, outputBufferLength, interpolation::kLinear, windowCorrection, windowBuff);
-
-			// --- overlap-add the interpolated buffer to complete the operation
-			vocoder.doOverlapAdd(&outputBuff[0], outputBufferLength);
-			}
-
-			return output;
-	}
-
-	/** get parameters: note use of custom structure for passing param data */
-	/**
-	\return PSMVocoderParameters custom data structure
-	*/
-	PSMVocoderParameters getParameters()
-	{
-		return parameters;
-	}
-
-	/** set parameters: note use of custom structure for passing param data */
-	/**
-	\param PSMVocoderParameters custom data structure
-	*/
-	void setParameters(const PSMVocoderParameters& params)
-	{
-		if (params.pitchShiftSemitones != parameters.pitchShiftSemitones)
+		// --- convert back
+		for (uint32_t k = 0; k < numBins; k++)
 		{
-			setPitchShift(params.pitchShiftSemitones);
+			fftData[k][0] = magnitude[k] * cos(psi[k]);
+			fftData[k][1] = magnitude[k] * sin(psi[k]);
 		}
+		psi.swap(psiPrevious);
 
-		// --- save
-		parameters = params;
-	}
-
-protected:
-	PSMVocoderParameters parameters;	///< object parameters
-	PhaseVocoder vocoder;				///< vocoder to perform PSM
-	double alphaStretchRatio = 1.0;		///< alpha stretch ratio = hs/ha
+		// --- manually so the IFFT (OPTIONAL)
+		vocoder.doInverseFFT();
 
-	// --- FFT is 4096 with 75% overlap
-	const double hs = PSM_FFT_LEN / 4;	///< hs = N/4 --- 75% overlap
-	double ha = PSM_FFT_LEN / 4;		///< ha = N/4 --- 75% overlap
-	double phi[PSM_FFT_LEN] = { 0.0 };	///< array of phase values for classic algorithm
-	double psi[PSM_FFT_LEN] = { 0.0 };	///< array of phase correction values for classic algorithm
+		// --- can get the iFFT buffer; it is real valued
+		double* inv_fftData = vocoder.getIFFTData();
 
-	// --- for peak-locking
-	BinData binData[PSM_FFT_LEN];			///< array of BinData structures for current FFT frame
-	BinData binDataPrevious[PSM_FFT_LEN];	///< array of BinData structures for previous FFT frame
+		// --- no shift set: plain overlap-add of the IFFT
+		if (outputBufferLength == 0)
+		{
+			vocoder.doOverlapAdd();
+			return;
+		}
 
-	int peakBins[PSM_FFT_LEN] = { -1 };		///< array of current peak bin index values (-1 = not peak)
-	int peakBinsPrevious[PSM_FFT_LEN] = { -1 }; ///< array of previous peak bin index values (-1 = not peak)
+		// --- resample the audio as if it were stretched
+		resample(&inv_fftData[0], outputBuff, frameLength, outputBufferLength, interpolation::kLinear, windowCorrection, windowBuff);
 
-	double* windowBuff = nullptr;			///< buffer for window
-	double* outputBuff = nullptr;			///< buffer for resampled output
-	double windowCorrection = 0.0;			///< window correction value
-	unsigned int outputBufferLength = 0;	///< lenght of resampled output array
+		// --- overlap-add the interpolated buffer to complete the operation
+		vocoder.doOverlapAdd(&outputBuff[0], outputBufferLength);
+	}
 };
 
 // --- sample rate conversion
@@ -9739,7 +11173,7 @@ inline double** decomposeFilter(double* filterIR, unsigned int FIRLength, unsign
 	}
 
 	int m = 0;
-	for (int i = 0; i < subBandLength; i++)
+	for (unsigned int i = 0; i < subBandLength; i++)
 	{
 		for (int j = ratio - 1; j >= 0; j--)
 		{
@@ -9995,5 +11429,3 @@ protected:
 	bool polyphase = true;									///< enable polyphase decomposition
 	FastConvolver polyPhaseConvolvers[maxSamplingRatio];	///< a set of sub-band convolvers for polyphase operation
 };
-
-#endif
@@ -0,0 +1,475 @@
+#ifndef __masterFXChain_h__
+#define __masterFXChain_h__
+
+// --- includes
+#include "synthdefs.h"
+#include "fxobjects.h"
+#include "partitionedconvolver.h"
+
+#include <chrono>
+
+// --- number of slots in the chain; each processor type can be used once
+const uint32_t MAX_MASTER_FX_SLOTS = 6;
+
+// --- longest AudioDelay time; the buffers are created once in reset( )
+const double MASTER_FX_MAX_DELAY_MSEC = 2000.0;
+
+// --- the stereo-linked dynamics detector runs over blocks of at most this size
+const uint32_t MASTER_FX_BLOCK_SIZE = 64;
+
+/**
+\enum masterFXType
+\ingroup SynthDefs
+\brief The fxobjects.h processors that can be placed in a MasterFXChain slot; kNone is an empty slot
+
+- kReverbTank : ReverbTank, stereo
+- kAudioDelay : AudioDelay, stereo (kNormal or kPingPong)
+- kModulatedDelay : ModulatedDelay (chorus/flanger/vibrato), stereo
+- kPhaseShifter : PhaseShifter, one per channel
+- kDynamicsProcessor : DynamicsProcessor, one per channel; optionally stereo-linked
+- kPeakLimiter : PeakLimiter, one per channel
+- kConvolver : PartitionedConvolver (cabinet/body/reverb IRs), see SynthEngine::setMasterFXImpulseResponse( )
+- kPitchShifter : PSMVocoder, one per channel; a harmonizer with PSMVocoderParameters::dryLevel_dB
+*/
+enum class masterFXType { kNone, kReverbTank, kAudioDelay, kModulatedDelay, kPhaseShifter, kDynamicsProcessor, kPeakLimiter, kConvolver, kPitchShifter };
+const uint32_t NUM_MASTER_FX_TYPES = 9;
+
+/**
+\struct MasterFXParameters
+\ingroup SynthStructures
+\brief Parameters for the master FX chain: the slot order, per-slot bypass and the settings for each processor.
+
+- slotType[] : processing order, slot 0 first; a type that appears in an earlier slot is ignored
+- slotBypass[] : bypassed slots are dropped from the chain (not visited at all)
+- enableCPUTiming : measure each active slot once per block (see MasterFXSlotTiming); off by default.
+  Single-frame calls (SynthEngine::renderAudioOutput( )) are not measured
+- linkDynamics : both channels of the dynamics processor follow max(|L|, |R|) via the sidechain
+- limiterLookahead_mSec : delay of the limited audio against its gain, up to PEAK_LIMITER_MAX_LOOKAHEAD_mSec
+- limiterTruePeak : the limiter detects inter-sample peaks (adds TruePeakDetector::getLatency( ) of delay)
+*/
+struct MasterFXParameters
+{
+	MasterFXParameters() {}
+	MasterFXParameters& operator=(const MasterFXParameters& params)	// need this override for collections to work
+	{
+		if (this == &params)
+			return *this;
+
+		for (uint32_t i = 0; i < MAX_MASTER_FX_SLOTS; i++)
+		{
+			slotType[i] = params.slotType[i];
+			slotBypass[i] = params.slotBypass[i];
+		}
+		enableCPUTiming = params.enableCPUTiming;
+
+		reverbParameters = params.reverbParameters;
+		delayParameters = params.delayParameters;
+		modDelayParameters = params.modDelayParameters;
+		phaserParameters = params.phaserParameters;
+		dynamicsParameters = params.dynamicsParameters;
+		linkDynamics = params.linkDynamics;
+		limiterThreshold_dB = params.limiterThreshold_dB;
+		limiterMakeUpGain_dB = params.limiterMakeUpGain_dB;
+		limiterLookahead_mSec = params.limiterLookahead_mSec;
+		limiterTruePeak = params.limiterTruePeak;
+		convolverParameters = params.convolverParameters;
+		pitchShifterParameters = params.pitchShifterParameters;
+		return *this;
+	}
+
+	// --- chain layout
+	masterFXType slotType[MAX_MASTER_FX_SLOTS] = { masterFXType::kNone, masterFXType::kNone, masterFXType::kNone,
+												   masterFXType::kNone, masterFXType::kNone, masterFXType::kNone };
+	bool slotBypass[MAX_MASTER_FX_SLOTS] = { false };
+	bool enableCPUTiming = false;
+
+	// --- processor parameters
+	ReverbTankParameters reverbParameters;
+	AudioDelayParameters delayParameters;
+	ModulatedDelayParameters modDelayParameters;
+	PhaseShifterParameters phaserParameters;
+	DynamicsProcessorParameters dynamicsParameters;
+	bool linkDynamics = true;
+	double limiterThreshold_dB = -3.0;
+	double limiterMakeUpGain_dB = 0.0;
+	double limiterLookahead_mSec = 0.0;
+	bool limiterTruePeak = false;
+	PartitionedConvolverParameters convolverParameters;
+	PSMVocoderParameters pitchShifterParameters;
+};
+
+/**
+\struct MasterFXSlotTiming
+\ingroup SynthStructures
+\brief CPU time spent in one slot of the chain, measured only while MasterFXParameters::enableCPUTiming is set
+
+- lastBlock_uSec : time for the most recent block
+- load : average time / real time of the audio processed since the last resetTiming( ); 0.01 = 1% of a core
+*/
+struct MasterFXSlotTiming
+{
+	double lastBlock_uSec = 0.0;
+	double load = 0.0;
+	double totalTime_Sec = 0.0;
+	uint64_t totalFrames = 0;
+};
+
+/**
+\class MasterFXChain
+\ingroup SynthClasses
+\brief Post-engine FX chain on the engine's own stereo bus, built from the fxobjects.h processors.
+
+- one instance of each processor is created with the chain and its buffers are allocated in reset( ),
+  so changing the slot order never allocates
+- setParameters( ) compiles the active slots into a flat list; bypassed and empty slots are not in it, so
+  they cost nothing in processBlock( ) (and no parameter updates either)
+- a slot that comes out of bypass is reset first so it does not play a stale tail
+- the mono-only processors run one instance per channel
+- every processor runs its double block path directly on the bus, with no float conversion and no virtual
+  calls (the dynamics stereo link is a block of max(|L|, |R|))
+- the convolver builds its stages off the audio thread (setConvolverImpulseResponse( ) and its own builder
+  thread) and crossfades to them; the pitch shifter is allocated for its largest frame, so a quality change
+  does not allocate
+- the reverb, delay and limiter lookahead lines live in one DelayMemoryArena that is laid out in reset( ); resetting a single
+  processor afterwards reuses its view, so the delay processors do not allocate after reset( )
+
+\author Will Pirkle
+\version Revision : 1.0
+\date Date : 2018 / 09 / 24
+*/
+class MasterFXChain
+{
+public:
+	MasterFXChain()
+	{
+		reverb.setDelayMemoryArena(&delayArena);
+		delay.setDelayMemoryArena(&delayArena);
+		modDelay.setDelayMemoryArena(&delayArena);
+		limiter[0].setDelayMemoryArena(&delayArena);
+		limiter[1].setDelayMemoryArena(&delayArena);
+	}
+	~MasterFXChain() { }
+
+	// --- create the buffers and reset every processor
+	bool reset(double _sampleRate)
+	{
+		sampleRate = _sampleRate;
+
+		// --- the delay processors register their line sizes, then the arena places them in one block
+		delayArena.beginReset();
+		reverb.reset(sampleRate);
+		delay.reset(sampleRate);
+		delay.createDelayBuffers(sampleRate, MASTER_FX_MAX_DELAY_MSEC);
+		modDelay.reset(sampleRate);
+		for (uint32_t ch = 0; ch < 2; ch++)
+		{
+			phaser[ch].reset(sampleRate);
+			dynamics[ch].reset(sampleRate);
+			limiter[ch].reset(sampleRate);
+		}
+		convolver.reset(sampleRate);
+		pitchShifter[0].reset(sampleRate);
+		pitchShifter[1].reset(sampleRate);
+		delayArena.commit();
+
+		// --- the delay-time based processors need the sample rate
+		for (uint32_t i = 0; i < activeSlotCount; i++)
+			updateProcessor(activeSlots[i]);
+
+		resetTiming();
+		return true;
+	}
+
+	// --- compile the active slot list and update the active processors
+	void setParameters(const MasterFXParameters& params)
+	{
+		parameters = params;
+
+		bool wasActive[NUM_MASTER_FX_TYPES] = { false };
+		for (uint32_t i = 0; i < activeSlotCount; i++)
+			wasActive[(uint32_t)activeSlots[i]] = true;
+
+		compileChain();
+
+		for (uint32_t i = 0; i < activeSlotCount; i++)
+		{
+			if (!wasActive[(uint32_t)activeSlots[i]] && sampleRate > 0.0)
+				resetProcessor(activeSlots[i]);
+
+			updateProcessor(activeSlots[i]);
+		}
+	}
+
+	// --- false when every slot is empty or bypassed
+	bool isActive() { return activeSlotCount > 0; }
+
+	// --- process the stereo bus in place
+	void processBlock(double* left, double* right, uint32_t blockSize)
+	{
+		if (activeSlotCount == 0 || blockSize == 0)
+			return;
+
+		// --- the clock is read twice per slot, so only blocks are timed
+		if (!parameters.enableCPUTiming || blockSize == 1)
+		{
+			for (uint32_t i = 0; i < activeSlotCount; i++)
+				processSlot(activeSlots[i], left, right, blockSize);
+			return;
+		}
+
+		for (uint32_t i = 0; i < activeSlotCount; i++)
+		{
+			auto start = std::chrono::steady_clock::now();
+			processSlot(activeSlots[i], left, right, blockSize);
+			auto end = std::chrono::steady_clock::now();
+
+			MasterFXSlotTiming& timing = slotTiming[activeSlotIndex[i]];
+			double elapsed_Sec = std::chrono::duration<double>(end - start).count();
+			timing.lastBlock_uSec = 1000000.0*elapsed_Sec;
+			timing.totalTime_Sec += elapsed_Sec;
+			timing.totalFrames += blockSize;
+			timing.load = timing.totalTime_Sec*sampleRate / (double)timing.totalFrames;
+		}
+	}
+
+	// --- total delay of the active slots in samples: limiter lookahead (with its true-peak detector),
+	//     convolver head block (0 until an IR plays) and pitch shifter frame
+	uint32_t getLatency()
+	{
+		uint32_t latency = 0;
+		for (uint32_t i = 0; i < activeSlotCount; i++)
+		{
+			switch (activeSlots[i])
+			{
+			case masterFXType::kPeakLimiter:
+				latency += limiter[0].getLatency();
+				break;
+			case masterFXType::kConvolver:
+				latency += convolver.getLatency();
+				break;
+			case masterFXType::kPitchShifter:
+				latency += pitchShifter[0].getLatency();
+				break;
+			default:
+				break;
+			}
+		}
+		return latency;
+	}
+
+	// --- timing for a slot (by slot index, not by active position)
+	MasterFXSlotTiming getSlotTiming(uint32_t slot)
+	{
+		if (slot >= MAX_MASTER_FX_SLOTS)
+			return MasterFXSlotTiming();
+		return slotTiming[slot];
+	}
+
+	// --- load one path of the convolver's routing matrix (see PartitionedConvolver::setImpulseResponse( ))
+	//     NOTE: allocates and transforms the IR on the calling thread; call off the audio thread, the convolver
+	//           fades to the new IR on its next block
+	void setConvolverImpulseResponse(uint32_t input, uint32_t output, const double* ir, uint32_t length)
+	{
+		convolver.setImpulseResponse(input, output, ir, length);
+	}
+
+	// --- clear the timing accumulators
+	void resetTiming()
+	{
+		for (uint32_t i = 0; i < MAX_MASTER_FX_SLOTS; i++)
+			slotTiming[i] = MasterFXSlotTiming();
+	}
+
+protected:
+	MasterFXParameters parameters;
+	double sampleRate = 0.0;
+
+	// --- delay memory of the reverb and delays; declared before them so that it outlives their views
+	DelayMemoryArena delayArena;
+
+	// --- the processors
+	ReverbTank reverb;
+	AudioDelay delay;
+	ModulatedDelay modDelay;
+	PhaseShifter phaser[2];
+	DynamicsProcessor dynamics[2];
+	PeakLimiter limiter[2];
+	PartitionedConvolver convolver;
+	PSMVocoder pitchShifter[2];
+
+	// --- compiled chain: processor type and owning slot, in processing order
+	masterFXType activeSlots[MAX_MASTER_FX_SLOTS] = { masterFXType::kNone };
+	uint32_t activeSlotIndex[MAX_MASTER_FX_SLOTS] = { 0 };
+	uint32_t activeSlotCount = 0;
+
+	MasterFXSlotTiming slotTiming[MAX_MASTER_FX_SLOTS];
+
+	// --- stereo-linked dynamics detector input
+	double sidechain[MASTER_FX_BLOCK_SIZE] = { 0.0 };
+
+	// --- flatten the slots; skip empty, bypassed and repeated types
+	void compileChain()
+	{
+		bool used[NUM_MASTER_FX_TYPES] = { false };
+		activeSlotCount = 0;
+
+		for (uint32_t i = 0; i < MAX_MASTER_FX_SLOTS; i++)
+		{
+			masterFXType type = parameters.slotType[i];
+			if (type == masterFXType::kNone || used[(uint32_t)type])
+				continue;
+
+			used[(uint32_t)type] = true;
+			if (parameters.slotBypass[i])
+				continue;
+
+			activeSlots[activeSlotCount] = type;
+			activeSlotIndex[activeSlotCount] = i;
+			activeSlotCount++;
+		}
+	}
+
+	// --- clear one processor's state
+	void resetProcessor(masterFXType type)
+	{
+		switch (type)
+		{
+		case masterFXType::kReverbTank:
+			reverb.reset(sampleRate);
+			break;
+		case masterFXType::kAudioDelay:
+			delay.reset(sampleRate);	// --- same rate: flushes the buffers
+			break;
+		case masterFXType::kModulatedDelay:
+			modDelay.reset(sampleRate);
+			break;
+		case masterFXType::kPhaseShifter:
+			phaser[0].reset(sampleRate);
+			phaser[1].reset(sampleRate);
+			break;
+		case masterFXType::kDynamicsProcessor:
+			dynamics[0].reset(sampleRate);
+			dynamics[1].reset(sampleRate);
+			break;
+		case masterFXType::kPeakLimiter:
+			limiter[0].reset(sampleRate);
+			limiter[1].reset(sampleRate);
+			break;
+		case masterFXType::kConvolver:
+			convolver.reset(sampleRate);
+			break;
+		case masterFXType::kPitchShifter:
+			pitchShifter[0].reset(sampleRate);	// --- clears the vocoder timelines too
+			pitchShifter[1].reset(sampleRate);
+			break;
+		default:
+			break;
+		}
+	}
+
+	// --- push the parameters for one processor
+	void updateProcessor(masterFXType type)
+	{
+		switch (type)
+		{
+		case masterFXType::kReverbTank:
+			reverb.setParameters(parameters.reverbParameters);
+			break;
+		case masterFXType::kAudioDelay:
+		{
+			AudioDelayParameters delayParams = parameters.delayParameters;
+			boundValue(delayParams.leftDelay_mSec, 0.0, MASTER_FX_MAX_DELAY_MSEC);
+			boundValue(delayParams.rightDelay_mSec, 0.0, MASTER_FX_MAX_DELAY_MSEC);
+			delay.setParameters(delayParams);
+			break;
+		}
+		case masterFXType::kModulatedDelay:
+			modDelay.setParameters(parameters.modDelayParameters);
+			break;
+		case masterFXType::kPhaseShifter:
+			phaser[0].setParameters(parameters.phaserParameters);
+			phaser[1].setParameters(parameters.phaserParameters);
+			break;
+		case masterFXType::kDynamicsProcessor:
+		{
+			DynamicsProcessorParameters dynamicsParams = parameters.dynamicsParameters;
+			dynamicsParams.enableSidechain = parameters.linkDynamics;
+			dynamics[0].setParameters(dynamicsParams);
+			dynamics[1].setParameters(dynamicsParams);
+			break;
+		}
+		case masterFXType::kPeakLimiter:
+			for (uint32_t ch = 0; ch < 2; ch++)
+			{
+				limiter[ch].setThreshold_dB(parameters.limiterThreshold_dB);
+				limiter[ch].setMakeUpGain_dB(parameters.limiterMakeUpGain_dB);
+				limiter[ch].setLookahead_mSec(parameters.limiterLookahead_mSec);
+				limiter[ch].enableTruePeak(parameters.limiterTruePeak);
+			}
+			break;
+		case masterFXType::kConvolver:
+			convolver.setParameters(parameters.convolverParameters);	// --- a change of sizes or mode is re-partitioned on the convolver's builder thread
+			break;
+		case masterFXType::kPitchShifter:
+			pitchShifter[0].setParameters(parameters.pitchShifterParameters);	// --- restarts only when the frame size changes
+			pitchShifter[1].setParameters(parameters.pitchShifterParameters);
+			break;
+		default:
+			break;
+		}
+	}
+
+	// --- run one processor over the block
+	void processSlot(masterFXType type, double* left, double* right, uint32_t blockSize)
+	{
+		switch (type)
+		{
+		case masterFXType::kReverbTank:
+			reverb.processBlock(left, right, blockSize);
+			break;
+		case masterFXType::kAudioDelay:
+			delay.processBlock(left, right, blockSize);
+			break;
+		case masterFXType::kModulatedDelay:
+			modDelay.processBlock(left, right, blockSize);
+			break;
+		case masterFXType::kPhaseShifter:
+			phaser[0].processBlock(left, left, blockSize);
+			phaser[1].processBlock(right, right, blockSize);
+			break;
+		case masterFXType::kDynamicsProcessor:
+			if (parameters.linkDynamics)
+			{
+				for (uint32_t offset = 0; offset < blockSize; offset += MASTER_FX_BLOCK_SIZE)
+				{
+					uint32_t frames = blockSize - offset < MASTER_FX_BLOCK_SIZE ? blockSize - offset : MASTER_FX_BLOCK_SIZE;
+					for (uint32_t n = 0; n < frames; n++)
+						sidechain[n] = fmax(fabs(left[offset + n]), fabs(right[offset + n]));
+					dynamics[0].processBlock(&left[offset], sidechain, &left[offset], frames);
+					dynamics[1].processBlock(&right[offset], sidechain, &right[offset], frames);
+				}
+			}
+			else
+			{
+				dynamics[0].processBlock(left, nullptr, left, blockSize);
+				dynamics[1].processBlock(right, nullptr, right, blockSize);
+			}
+			break;
+		case masterFXType::kPeakLimiter:
+			limiter[0].processBlock(left, left, blockSize);
+			limiter[1].processBlock(right, right, blockSize);
+			break;
+		case masterFXType::kConvolver:
+			convolver.processBlock(left, right, blockSize);
+			break;
+		case masterFXType::kPitchShifter:
+			pitchShifter[0].processBlock(left, left, blockSize);
+			pitchShifter[1].processBlock(right, right, blockSize);
+			break;
+		default:
+			break;
+		}
+	}
+};
+
+#endif /* defined(__masterFXChain_h__) */
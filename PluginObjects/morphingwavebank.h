@@ -0,0 +1,270 @@
+#ifndef __morphingWaveBank_h__
+#define __morphingWaveBank_h__
+
+// --- includes
+#include "synthdefs.h"
+
+// --- wavetable objects and structs
+#include "wavetable.h"
+
+// --- max frames in a morphing bank; one frame per bank table
+const uint32_t MAX_MORPHING_FRAMES = 32;
+
+/**
+\class MorphingWaveBank
+\ingroup SynthClasses
+\brief Treats the tables of a high-resolution bank as the frames of one morphing wavetable.
+
+- every frame is decoded ONCE (hex/encrypted hex/decimal -> double) and pre-scaled by its outputComp
+- the per-note band-limiting of the source tables is kept, so each MIDI note (mipmap) has its own set of frames
+- all frames for a note share one length and are stored contiguously with one guard sample at the end
+  so the read kernel never needs to wrap the second interpolation index
+- the oscillator picks a frame pair + fraction at update time; the per-sample read is two linear reads blended
+
+\author Will Pirkle
+\version Revision : 1.0
+\date Date : 2018 / 09 / 24
+*/
+class MorphingWaveBank : public IMorphingWaveBank
+{
+public:
+	MorphingWaveBank() {
+		memset(morphTableSets, 0, MAX_WAVE_TABLES * sizeof(const double**));
+		memset(morphTableLengths, 0, MAX_WAVE_TABLES * sizeof(uint32_t));
+	}
+
+	virtual ~MorphingWaveBank() { destroyMorphingTables(); }
+
+	// --- IMorphingWaveBank
+	//
+	// --- add a set of frame pointers for one MIDI note; morph_0 must hold getMorphingTableCount() pointers
+	//     NOTE: the table length for the note is set with the frames (see initializeWithHiResWTBank)
+	virtual void addMorphingTable(const double** morph_0, uint32_t midiNoteNumber)
+	{
+		if (midiNoteNumber >= MAX_WAVE_TABLES)
+			return;
+
+		morphTableSets[midiNoteNumber] = morph_0;
+	}
+
+	// --- fill in the empty note slots with the closest neighbor above (no aliasing), or below at the top
+	virtual bool initMorphingTables()
+	{
+		int lastIndex = -1;
+		for (int i = MAX_WAVE_TABLES - 1; i >= 0; i--)
+		{
+			if (morphTableSets[i])
+			{
+				lastIndex = i;
+				break;
+			}
+		}
+
+		// --- no tables :(
+		if (lastIndex < 0)
+			return false;
+
+		for (int i = MAX_WAVE_TABLES - 1; i > lastIndex; i--)
+		{
+			morphTableSets[i] = morphTableSets[lastIndex];
+			morphTableLengths[i] = morphTableLengths[lastIndex];
+		}
+
+		for (int i = lastIndex - 1; i >= 0; i--)
+		{
+			if (!morphTableSets[i])
+			{
+				morphTableSets[i] = morphTableSets[i + 1];
+				morphTableLengths[i] = morphTableLengths[i + 1];
+			}
+		}
+
+		enabled = true;
+		return true;
+	}
+
+	// --- select the set of frames for a note; the note number is bounded on return
+	virtual const double** selectMorphingTableSet(uint32_t& midiNoteNumber)
+	{
+		if (midiNoteNumber >= MAX_WAVE_TABLES)
+			midiNoteNumber = MAX_WAVE_TABLES - 1;
+
+		currentTableLength = morphTableLengths[midiNoteNumber];
+		return morphTableSets[midiNoteNumber];
+	}
+
+	// --- length of the currently selected frame set
+	virtual uint32_t getTableLength() { return currentTableLength; }
+
+	// --- number of frames
+	virtual uint32_t getMorphingTableCount() { return morphingTableCount; }
+
+	// --- decode a high-res bank into frames; each HiResWTSet in the bank becomes one frame
+	//     NOTE: call once, off the audio thread (see WaveTableData::initMorphingWaveBanks)
+	bool initializeWithHiResWTBank(BankDescriptor bankDesc)
+	{
+		destroyMorphingTables();
+
+		morphingTableCount = bankDesc.tablePtrsCount;
+		if (morphingTableCount > MAX_MORPHING_FRAMES)
+			morphingTableCount = MAX_MORPHING_FRAMES;
+
+		// --- need at least a pair to morph
+		if (morphingTableCount < 2)
+			return false;
+
+		// --- the first table drives the note -> table mapping; shared pointers in the
+		//     source set mean shared frames here, so we only decode each unique table once
+		HiResWTSet* masterSet = bankDesc.tablePtrs[0];
+		const void* lastSourceTable = nullptr;
+
+		for (uint32_t note = 0; note < MAX_WAVE_TABLES; note++)
+		{
+			const void* sourceTable = getSourceTable(masterSet, note);
+			if (!sourceTable)
+				continue;
+
+			// --- same source table as the note below: share the frames
+			if (sourceTable == lastSourceTable && note > 0 && morphTableSets[note - 1])
+			{
+				addMorphingTable(morphTableSets[note - 1], note);
+				morphTableLengths[note] = morphTableLengths[note - 1];
+				continue;
+			}
+			lastSourceTable = sourceTable;
+
+			uint32_t tableLength = masterSet->tableLengths[note];
+			if (tableLength == 0)
+				continue;
+
+			// --- one contiguous block for all frames of this note, each with a guard sample
+			uint32_t stride = tableLength + 1;
+			double* frameBlock = new double[morphingTableCount * stride];
+			const double** frameSet = new const double*[morphingTableCount];
+
+			for (uint32_t f = 0; f < morphingTableCount; f++)
+			{
+				double* frame = &frameBlock[f * stride];
+				decodeFrame(bankDesc.tablePtrs[f], note, frame, tableLength);
+
+				// --- guard sample = first sample; read kernel never wraps
+				frame[tableLength] = frame[0];
+				frameSet[f] = frame;
+			}
+
+			frameBlocks.push_back(frameBlock);
+			frameSets.push_back(frameSet);
+
+			addMorphingTable(frameSet, note);
+			morphTableLengths[note] = tableLength;
+		}
+
+		return initMorphingTables();
+	}
+
+	// --- the read kernel: one linear read on each frame of the pair, then crossfade
+	//     frameA/frameB are adjacent frames, morphFrac is [0, 1) between them
+	//     NOTE: readIndex must already be wrapped to [0, tableLength)
+	inline static double readMorphingTable(const double* frameA, const double* frameB, double morphFrac, double readIndex)
+	{
+		int intReadIndex = (int)readIndex;
+		double frac = readIndex - intReadIndex;
+
+		double a0 = frameA[intReadIndex];
+		double b0 = frameB[intReadIndex];
+
+		// --- blend the frames first so we only interpolate across the table once
+		double y0 = a0 + morphFrac*(b0 - a0);
+		double y1 = frameA[intReadIndex + 1] + morphFrac*(frameB[intReadIndex + 1] - frameA[intReadIndex + 1]);
+
+		return y0 + frac*(y1 - y0);
+	}
+
+	// --- state
+	bool isEnabled() { return enabled; }
+
+	// --- name of this bank
+	std::string getWaveBankName() { return bankName; }
+	void setWaveBankName(std::string _bankName) { bankName = _bankName; }
+
+protected:
+	// --- name of this bank
+	std::string bankName;
+
+	// --- one set of frame pointers per MIDI note
+	const double** morphTableSets[MAX_WAVE_TABLES];
+	uint32_t morphTableLengths[MAX_WAVE_TABLES];
+
+	// --- owned storage
+	std::vector<double*> frameBlocks;
+	std::vector<const double**> frameSets;
+
+	uint32_t morphingTableCount = 0;
+	uint32_t currentTableLength = 0;
+	bool enabled = false;
+
+	// --- get the raw table pointer for a note, regardless of type
+	inline const void* getSourceTable(HiResWTSet* set, uint32_t note)
+	{
+		if (!set)
+			return nullptr;
+		if (set->isHexTable && set->pp_uHexTableSet)
+			return set->pp_uHexTableSet[note];
+		if (set->pp_dDecimalTableSet)
+			return set->pp_dDecimalTableSet[note];
+		return nullptr;
+	}
+
+	// --- decode one frame into the destination; if the source length differs from the
+	//     master length, it is linearly resampled so all frames line up sample-for-sample
+	inline void decodeFrame(HiResWTSet* set, uint32_t note, double* dest, uint32_t destLength)
+	{
+		const void* source = getSourceTable(set, note);
+		uint32_t sourceLength = source ? set->tableLengths[note] : 0;
+
+		if (!source || sourceLength == 0)
+		{
+			memset(dest, 0, destLength * sizeof(double));
+			return;
+		}
+
+		for (uint32_t i = 0; i < destLength; i++)
+		{
+			double readIndex = (double)i * (double)sourceLength / (double)destLength;
+			uint32_t intIndex = (uint32_t)readIndex;
+			uint32_t nextIndex = intIndex + 1 >= sourceLength ? 0 : intIndex + 1;
+			double frac = readIndex - intIndex;
+
+			dest[i] = doLinearInterpolation(0.0, 1.0, decodeSample(set, source, intIndex), decodeSample(set, source, nextIndex), frac) * set->outputComp;
+		}
+	}
+
+	// --- decode one sample
+	inline double decodeSample(HiResWTSet* set, const void* source, uint32_t index)
+	{
+		if (set->tableDataType == wtDataType::decimal)
+			return ((const double*)source)[index];
+		else if (set->isEncrypted)
+			return uint64ToDouble(set->encryptionKey ^ ((const uint64_t*)source)[index]);
+
+		return uint64ToDouble(((const uint64_t*)source)[index]);
+	}
+
+	inline void destroyMorphingTables()
+	{
+		for (size_t i = 0; i < frameBlocks.size(); i++)
+			delete[] frameBlocks[i];
+		for (size_t i = 0; i < frameSets.size(); i++)
+			delete[] frameSets[i];
+
+		frameBlocks.clear();
+		frameSets.clear();
+
+		memset(morphTableSets, 0, MAX_WAVE_TABLES * sizeof(const double**));
+		memset(morphTableLengths, 0, MAX_WAVE_TABLES * sizeof(uint32_t));
+		currentTableLength = 0;
+		enabled = false;
+	}
+};
+
+#endif /* defined(__morphingWaveBank_h__) */
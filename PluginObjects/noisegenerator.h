@@ -0,0 +1,214 @@
+#ifndef __noiseGenerator_h__
+#define __noiseGenerator_h__
+
+// --- includes
+#include "synthdefs.h"
+
+// --- block size for the noise oscillator
+const uint32_t NOISE_BLOCK_SIZE = 64;
+
+/**
+\class NoiseGenerator
+\ingroup SynthClasses
+\brief Counter-based pseudo random number generator for noise and sample-and-hold sources.
+
+Each value is a pure function of (key, counter): the key is hashed from a seed and a stream number, the
+counter is the sample index. There is no global state (unlike rand( )/srand( )) so every voice and
+component gets its own reproducible stream, and a block of values has no loop-carried dependency
+other than the counter.
+
+- the mixer is the SplitMix64 finalizer on a Weyl sequence (key + counter * golden ratio)
+- uniform output is [-1, +1), gaussian output is Box-Muller (pairs) with unit variance
+- reset( ) rewinds the stream so a render restarts identically
+
+\author Will Pirkle
+\version Revision : 1.0
+\date Date : 2018 / 09 / 24
+*/
+class NoiseGenerator
+{
+public:
+	NoiseGenerator() { setSeed(0, 0); }
+	~NoiseGenerator() { }
+
+	// --- choose the stream; the counter is rewound
+	inline void setSeed(uint64_t seed, uint64_t stream)
+	{
+		key = mix64(seed ^ mix64(stream + kGolden));
+		counter = 0;
+	}
+
+	// --- rewind the stream
+	inline void reset() { counter = 0; }
+
+	// --- jump to a position in the stream
+	inline void seek(uint64_t _counter) { counter = _counter; }
+	uint64_t getCounter() { return counter; }
+
+	// --- raw 32 bits
+	inline uint32_t nextUint32() { return (uint32_t)(bitsAt(counter++) >> 32); }
+
+	// --- one uniform value [-1, +1)
+	inline double uniform() { return toBipolar(bitsAt(counter++)); }
+
+	// --- one gaussian value; draws a full pair and discards the second
+	inline double gaussian()
+	{
+		double output[2] = { 0.0 };
+		gaussianPair(counter, output);
+		counter += 2;
+		return output[0];
+	}
+
+	// --- block of uniform values [-1, +1)
+	inline void uniformBlock(double* output, uint32_t count)
+	{
+		const uint64_t start = counter;
+		for (uint32_t i = 0; i < count; i++)
+			output[i] = toBipolar(bitsAt(start + i));
+
+		counter += count;
+	}
+
+	// --- block of gaussian values; an odd count still uses a whole pair for the last value
+	inline void gaussianBlock(double* output, uint32_t count)
+	{
+		uint32_t pairs = count / 2;
+		for (uint32_t i = 0; i < pairs; i++)
+			gaussianPair(counter + 2 * i, &output[2 * i]);
+
+		counter += 2 * pairs;
+
+		if (count & 1)
+			output[count - 1] = gaussian();
+	}
+
+protected:
+	uint64_t key = 0;
+	uint64_t counter = 0;
+
+	static const uint64_t kGolden = 0x9E3779B97F4A7C15ULL;
+
+	// --- SplitMix64 finalizer
+	inline static uint64_t mix64(uint64_t z)
+	{
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		return z ^ (z >> 31);
+	}
+
+	// --- the generator: value n of this stream
+	inline uint64_t bitsAt(uint64_t n) { return mix64(key + n * kGolden); }
+
+	// --- top 53 bits -> [-1, +1)
+	inline static double toBipolar(uint64_t bits)
+	{
+		return (double)(bits >> 11) * (2.0 / 9007199254740992.0) - 1.0;
+	}
+
+	// --- Box-Muller on values n and n + 1
+	inline void gaussianPair(uint64_t n, double* output)
+	{
+		// --- u1 in (0, 1] so the log is finite
+		double u1 = (double)((bitsAt(n) >> 11) + 1) * (1.0 / 9007199254740992.0);
+		double u2 = (double)(bitsAt(n + 1) >> 11) * (1.0 / 9007199254740992.0);
+
+		double r = sqrt(-2.0*log(u1));
+		output[0] = r*cos(kTwoPi*u2);
+		output[1] = r*sin(kTwoPi*u2);
+	}
+};
+
+// --- noise oscillator types
+enum class noiseOscType { kWhite, kGaussian };
+
+/**
+\struct NoiseOscParameters
+\ingroup SynthStructures
+\brief Parameters for the voice noise source; outputAmplitude = 0 turns it off
+*/
+struct NoiseOscParameters
+{
+	NoiseOscParameters() {}
+	NoiseOscParameters& operator=(const NoiseOscParameters& params)	// need this override for collections to work
+	{
+		if (this == &params)
+			return *this;
+
+		type = params.type;
+		outputAmplitude = params.outputAmplitude;
+		return *this;
+	}
+
+	// --- individual parameters
+	noiseOscType type = noiseOscType::kWhite;
+	double outputAmplitude = 0.0;	// --- off by default
+};
+
+/**
+\class NoiseOscillator
+\ingroup SynthClasses
+\brief Per-voice noise source: renders NOISE_BLOCK_SIZE values at a time from a NoiseGenerator, one read per sample.
+
+Gaussian noise is scaled by 1/3 so its peaks are mostly in [-1, +1] like the white noise.
+
+\author Will Pirkle
+\version Revision : 1.0
+\date Date : 2018 / 09 / 24
+*/
+class NoiseOscillator
+{
+public:
+	NoiseOscillator(std::shared_ptr<NoiseOscParameters> _parameters)
+		: parameters(_parameters)
+	{
+		if (!parameters)
+			parameters = std::make_shared<NoiseOscParameters>();
+	}
+	~NoiseOscillator() { }
+
+	// --- rewind the stream and the block
+	void reset()
+	{
+		noise.reset();
+		readIndex = NOISE_BLOCK_SIZE;
+	}
+
+	// --- choose the stream (see NoiseGenerator::setSeed)
+	void setSeed(uint64_t seed, uint64_t stream)
+	{
+		noise.setSeed(seed, stream);
+		readIndex = NOISE_BLOCK_SIZE;
+	}
+
+	bool isActive() { return parameters->outputAmplitude > 0.0; }
+
+	// --- one sample, scaled by the output amplitude
+	inline double renderAudioOutput()
+	{
+		if (readIndex >= NOISE_BLOCK_SIZE)
+		{
+			if (parameters->type == noiseOscType::kGaussian)
+			{
+				noise.gaussianBlock(&noiseBlock[0], NOISE_BLOCK_SIZE);
+				for (uint32_t i = 0; i < NOISE_BLOCK_SIZE; i++)
+					noiseBlock[i] *= (1.0 / 3.0);
+			}
+			else
+				noise.uniformBlock(&noiseBlock[0], NOISE_BLOCK_SIZE);
+
+			readIndex = 0;
+		}
+
+		return parameters->outputAmplitude * noiseBlock[readIndex++];
+	}
+
+protected:
+	std::shared_ptr<NoiseOscParameters> parameters = nullptr;
+	NoiseGenerator noise;
+
+	double noiseBlock[NOISE_BLOCK_SIZE] = { 0.0 };
+	uint32_t readIndex = NOISE_BLOCK_SIZE;
+};
+
+#endif /* defined(__noiseGenerator_h__) */
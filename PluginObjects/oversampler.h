@@ -0,0 +1,212 @@
+#ifndef __oversampler_h__
+#define __oversampler_h__
+
+// --- includes
+#include "synthdefs.h"
+
+// --- max ratio and FIR length; the tables are the 128-point LPFs in filters.h
+const uint32_t MAX_OVERSAMPLING_RATIO = 4;
+const uint32_t OVERSAMPLER_FIR_LENGTH = FILTER_TAP_128;
+
+/**
+\class Oversampler
+\ingroup SynthClasses
+\brief Polyphase decimator for the oversampled oscillator render of a voice.
+
+The oscillators render directly at the oversampled rate, so only the way back down to fs is filtered.
+Unlike the FFTW-based Decimator in fxobjects.h, this is a direct-form FIR on the 128-point filters.h tables:
+for short FIRs that is cheaper than FFT convolution, has no block latency and needs no external library.
+
+- the history is stored twice (mirrored) so the FIR is one contiguous dot product with no wrapping
+- ratio 1 is a pass-through
+- the FIR only runs at the output (low) rate, once per downsample( ) call
+
+\author Will Pirkle
+\version Revision : 1.0
+\date Date : 2018 / 09 / 24
+*/
+class Oversampler
+{
+public:
+	Oversampler() { }
+	~Oversampler() { }
+
+	// --- setup for ratio (1, 2 or 4) at the base sample rate
+	//     NOTE: only 44.1k-family rates get the _882/_1764 tables, everything else uses the _96/_192 set;
+	//           the designs are relative to fs so either set works at other rates
+	inline bool initialize(uint32_t _ratio, double _sampleRate)
+	{
+		if (_ratio != 2 && _ratio != 4)
+			_ratio = 1;
+
+		ratio = _ratio;
+		sampleRate = _sampleRate;
+		reset();
+
+		if (ratio == 1)
+			return true;
+
+		bool is441Family = fmod(sampleRate, 11025.0) == 0.0;
+		const double* filterTable = nullptr;
+		if (ratio == 2)
+			filterTable = is441Family ? &LPF128_882[0] : &LPF128_96[0];
+		else
+			filterTable = is441Family ? &LPF128_1764[0] : &LPF128_192[0];
+
+		memcpy(&filterIR[0], filterTable, OVERSAMPLER_FIR_LENGTH * sizeof(double));
+
+		return true;
+	}
+
+	// --- clear the history
+	inline void reset()
+	{
+		memset(&downHistory[0], 0, 2 * OVERSAMPLER_FIR_LENGTH * sizeof(double));
+		downWriteIndex = 0;
+	}
+
+	uint32_t getRatio() { return ratio; }
+
+	// --- one output sample from ratio input samples (input[0] is the earliest)
+	inline double downsample(const double* input)
+	{
+		if (ratio == 1)
+			return input[0];
+
+		// --- push ratio samples into the history; only filter once
+		for (uint32_t k = 0; k < ratio; k++)
+		{
+			downWriteIndex = downWriteIndex == 0 ? OVERSAMPLER_FIR_LENGTH - 1 : downWriteIndex - 1;
+			downHistory[downWriteIndex] = input[k];
+			downHistory[downWriteIndex + OVERSAMPLER_FIR_LENGTH] = input[k];
+		}
+
+		const double* x = &downHistory[downWriteIndex];
+		double output = 0.0;
+		for (uint32_t i = 0; i < OVERSAMPLER_FIR_LENGTH; i++)
+			output += filterIR[i] * x[i];
+
+		return output;
+	}
+
+protected:
+	uint32_t ratio = 1;					///< 1, 2 or 4
+	double sampleRate = 44100.0;		///< base (output) sample rate
+
+	double filterIR[OVERSAMPLER_FIR_LENGTH] = { 0.0 };	///< full-length anti-aliasing LPF
+
+	// --- mirrored history
+	double downHistory[2 * OVERSAMPLER_FIR_LENGTH] = { 0.0 };
+	uint32_t downWriteIndex = 0;
+};
+
+// --- half-band FIR: 4k + 3 taps so the centre tap falls on the odd phase
+const uint32_t HALFBAND_LENGTH = 47;
+const uint32_t HALFBAND_PHASE_LENGTH = (HALFBAND_LENGTH + 1) / 2;	///< non-zero taps off the centre (the even taps)
+const uint32_t HALFBAND_CENTER_DELAY = (HALFBAND_LENGTH - 3) / 4;	///< centre tap delay in base-rate samples
+
+/**
+\class HalfBand2xOversampler
+\ingroup SynthClasses
+\brief Fixed 2x up/down pair on a Blackman-windowed half-band FIR, for non-linear processing inside a component.
+
+Every other tap of a half-band filter is zero and the centre tap is 0.5, so each phase is either a
+24-tap dot product or a plain delay:
+- upsample: 24 MACs for one output, a delayed copy of the input for the other
+- downsample: 24 MACs on one phase + one multiply for the centre tap, run only at the base rate
+
+Total latency is HALFBAND_LENGTH - 1 samples at 2x (23 base-rate samples).
+
+\author Will Pirkle
+\version Revision : 1.0
+\date Date : 2018 / 09 / 24
+*/
+class HalfBand2xOversampler
+{
+public:
+	HalfBand2xOversampler()
+	{
+		// --- windowed sinc at fc = fs/4 (of the 2x rate)
+		const int center = (HALFBAND_LENGTH - 1) / 2;
+		double sum = 0.0;
+		for (uint32_t j = 0; j < HALFBAND_PHASE_LENGTH; j++)
+		{
+			int n = 2 * j;
+			double t = 0.5*(double)(n - center);
+			double sinc = sin(kPi*t) / (kPi*t);
+			double window = 0.42 - 0.5*cos(kTwoPi*n / (HALFBAND_LENGTH - 1)) + 0.08*cos(2.0*kTwoPi*n / (HALFBAND_LENGTH - 1));
+			evenTaps[j] = 0.5*sinc*window;
+			sum += evenTaps[j];
+		}
+
+		// --- normalize for unity DC gain: even taps + centre tap (0.5) = 1
+		for (uint32_t j = 0; j < HALFBAND_PHASE_LENGTH; j++)
+			evenTaps[j] *= 0.5 / sum;
+
+		reset();
+	}
+	~HalfBand2xOversampler() { }
+
+	// --- clear the histories
+	inline void reset()
+	{
+		memset(&upHistory[0], 0, 2 * HALFBAND_PHASE_LENGTH * sizeof(double));
+		memset(&downHistory[0], 0, 2 * HALFBAND_PHASE_LENGTH * sizeof(double));
+		memset(&downCenterHistory[0], 0, (HALFBAND_CENTER_DELAY + 1) * sizeof(double));
+		upWriteIndex = 0;
+		downWriteIndex = 0;
+		downCenterIndex = 0;
+	}
+
+	// --- one input sample -> two output samples (output[0] is the earlier)
+	inline void upsample(double xn, double* output)
+	{
+		upWriteIndex = upWriteIndex == 0 ? HALFBAND_PHASE_LENGTH - 1 : upWriteIndex - 1;
+		upHistory[upWriteIndex] = xn;
+		upHistory[upWriteIndex + HALFBAND_PHASE_LENGTH] = xn;
+
+		// --- even phase; the zero-stuffing gain of 2 is applied here
+		const double* x = &upHistory[upWriteIndex];
+		double y = 0.0;
+		for (uint32_t j = 0; j < HALFBAND_PHASE_LENGTH; j++)
+			y += evenTaps[j] * x[j];
+
+		output[0] = 2.0*y;
+
+		// --- odd phase: centre tap only, 2 * 0.5 = 1
+		output[1] = x[HALFBAND_CENTER_DELAY];
+	}
+
+	// --- two input samples (input[0] is the earlier) -> one output sample
+	inline double downsample(const double* input)
+	{
+		// --- the earlier samples only meet the centre tap
+		downCenterIndex = downCenterIndex == 0 ? HALFBAND_CENTER_DELAY : downCenterIndex - 1;
+		downCenterHistory[downCenterIndex] = input[0];
+		uint32_t oldest = downCenterIndex == 0 ? HALFBAND_CENTER_DELAY : downCenterIndex - 1;
+
+		downWriteIndex = downWriteIndex == 0 ? HALFBAND_PHASE_LENGTH - 1 : downWriteIndex - 1;
+		downHistory[downWriteIndex] = input[1];
+		downHistory[downWriteIndex + HALFBAND_PHASE_LENGTH] = input[1];
+
+		const double* x = &downHistory[downWriteIndex];
+		double y = 0.0;
+		for (uint32_t j = 0; j < HALFBAND_PHASE_LENGTH; j++)
+			y += evenTaps[j] * x[j];
+
+		return y + 0.5*downCenterHistory[oldest];
+	}
+
+protected:
+	double evenTaps[HALFBAND_PHASE_LENGTH] = { 0.0 };
+
+	// --- mirrored histories for the dot products; plain ring for the centre tap
+	double upHistory[2 * HALFBAND_PHASE_LENGTH] = { 0.0 };
+	double downHistory[2 * HALFBAND_PHASE_LENGTH] = { 0.0 };
+	double downCenterHistory[HALFBAND_CENTER_DELAY + 1] = { 0.0 };
+	uint32_t upWriteIndex = 0;
+	uint32_t downWriteIndex = 0;
+	uint32_t downCenterIndex = 0;
+};
+
+#endif /* defined(__oversampler_h__) */
@@ -0,0 +1,866 @@
+#ifndef __partitionedConvolver_h__
+#define __partitionedConvolver_h__
+
+// --- includes
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "synthdefs.h"
+#include "fxobjects.h"
+
+// --- partition (block) size limits; the head partition size is the latency
+const uint32_t MIN_CONVOLVER_PARTITION = 16;
+const uint32_t MAX_CONVOLVER_PARTITION = 16384;
+
+// --- inputs and outputs of the routing matrix
+const uint32_t MAX_CONVOLVER_CHANNELS = 2;
+
+// --- the convolver moves audio through its stages at most this many samples at a time
+const uint32_t CONVOLVER_CHUNK_SIZE = 64;
+
+// --- a new IR or partitioning fades in over this many samples
+const uint32_t CONVOLVER_CROSSFADE_SAMPLES = 1024;
+
+/**
+\enum convolverMode
+\ingroup SynthDefs
+\brief Routing of the PartitionedConvolver
+
+- kMono : (L + R)/2 through IR [0][0] to both outputs
+- kStereo : L through IR [0][0] to L, R through IR [1][1] to R
+- kTrueStereo : all four paths, IR [input][output]
+*/
+enum class convolverMode { kMono, kStereo, kTrueStereo };
+
+/**
+\struct PartitionedConvolverParameters
+\ingroup SynthStructures
+\brief Parameters for the PartitionedConvolver
+
+- partitionSize : head partition size in samples (power of two); this is the latency
+- tailPartitionSize : 0 = uniform partitions; otherwise a second stage with this (larger) partition size
+  takes over the IR after the first (tailPartitionSize - partitionSize) samples
+- wetLevel_dB, dryLevel_dB : output mix; the dry signal is delayed by the latency so it stays aligned
+*/
+struct PartitionedConvolverParameters
+{
+	PartitionedConvolverParameters() {}
+	PartitionedConvolverParameters& operator=(const PartitionedConvolverParameters& params)	// need this override for collections to work
+	{
+		if (this == &params)
+			return *this;
+
+		mode = params.mode;
+		partitionSize = params.partitionSize;
+		tailPartitionSize = params.tailPartitionSize;
+		wetLevel_dB = params.wetLevel_dB;
+		dryLevel_dB = params.dryLevel_dB;
+		return *this;
+	}
+
+	// --- individual parameters
+	convolverMode mode = convolverMode::kStereo;
+	uint32_t partitionSize = 256;
+	uint32_t tailPartitionSize = 0;
+	double wetLevel_dB = 0.0;
+	double dryLevel_dB = -96.0;		///< -96dB and below is off
+};
+
+/**
+\class ConvolutionStage
+\ingroup SynthClasses
+\brief One uniformly partitioned overlap-save convolver over a segment of the impulse responses.
+
+- block size B, FFT size 2B; every IR partition of B samples is stored as a half spectrum (B + 1 bins)
+- the input spectra go into a frequency-domain delay line (FDL), one per input, so each block costs one
+  real forward FFT per input, one real inverse FFT per output and (paths x partitions) complex multiply-adds
+  (the FFTs run on the shared FFTEngine)
+- the 1/N of the inverse FFT is folded into the stored IR spectra
+- latency is B samples; the stage output for the block is read out during the next block
+
+\author Will Pirkle
+\version Revision : 1.0
+\date Date : 2018 / 09 / 24
+*/
+class ConvolutionStage
+{
+public:
+	ConvolutionStage() { }
+	~ConvolutionStage() { }
+
+	// --- allocate for a block size and a segment of the IR: [_irOffset, _irOffset + _segmentLength)
+	//     NOTE: allocates; call off the audio thread
+	bool initialize(uint32_t _blockSize, uint32_t _irOffset, uint32_t _segmentLength, uint32_t _numInputs, uint32_t _numOutputs)
+	{
+		blockSize = _blockSize;
+		fftSize = 2 * blockSize;
+		numBins = blockSize + 1;
+		irOffset = _irOffset;
+		numInputs = _numInputs;
+		numOutputs = _numOutputs;
+		numPartitions = (_segmentLength + blockSize - 1) / blockSize;
+		if (numPartitions < 1)
+			numPartitions = 1;
+
+		// --- real FFT of 2B; the tables are shared with other users of this size
+		if (!fftEngine.initialize(fftSize))
+			return false;
+
+		// --- spectra: IR [input][output][partition][bin], FDL [input][partition][bin]
+		uint32_t spectrumSize = numPartitions * numBins;
+		for (uint32_t i = 0; i < MAX_CONVOLVER_CHANNELS; i++)
+		{
+			for (uint32_t o = 0; o < MAX_CONVOLVER_CHANNELS; o++)
+			{
+				irReal[i][o].assign(spectrumSize, 0.0);
+				irImag[i][o].assign(spectrumSize, 0.0);
+				pathEnabled[i][o] = false;
+			}
+
+			fdlReal[i].assign(spectrumSize, 0.0);
+			fdlImag[i].assign(spectrumSize, 0.0);
+			inputHistory[i].assign(fftSize, 0.0);
+			outputBlock[i].assign(blockSize, 0.0);
+		}
+
+		workTime.assign(fftSize, 0.0);
+		accReal.assign(numBins, 0.0);
+		accImag.assign(numBins, 0.0);
+
+		reset();
+		return true;
+	}
+
+	// --- clear the signal state; the IR spectra are kept
+	void reset()
+	{
+		for (uint32_t i = 0; i < MAX_CONVOLVER_CHANNELS; i++)
+		{
+			std::fill(fdlReal[i].begin(), fdlReal[i].end(), 0.0);
+			std::fill(fdlImag[i].begin(), fdlImag[i].end(), 0.0);
+			std::fill(inputHistory[i].begin(), inputHistory[i].end(), 0.0);
+			std::fill(outputBlock[i].begin(), outputBlock[i].end(), 0.0);
+		}
+		fdlIndex = 0;
+		position = 0;
+	}
+
+	// --- transform this stage's segment of an IR into partition spectra; ir = nullptr clears the path
+	//     NOTE: call off the audio thread
+	void setImpulseResponse(uint32_t input, uint32_t output, const double* ir, uint32_t length)
+	{
+		if (input >= numInputs || output >= numOutputs || irReal[input][output].empty())
+			return;
+
+		pathEnabled[input][output] = false;
+		const double scale = 1.0 / (double)fftSize;
+		for (uint32_t p = 0; p < numPartitions; p++)
+		{
+			// --- B samples of the IR, zero-padded to 2B
+			std::fill(workTime.begin(), workTime.end(), 0.0);
+			bool nonZero = false;
+			for (uint32_t n = 0; n < blockSize; n++)
+			{
+				uint32_t index = irOffset + p*blockSize + n;
+				if (ir && index < length)
+				{
+					workTime[n] = ir[index] * scale;
+					nonZero = nonZero || ir[index] != 0.0;
+				}
+			}
+
+			if (nonZero)
+				pathEnabled[input][output] = true;
+
+			fftEngine.forwardReal(&workTime[0], &irReal[input][output][p*numBins], &irImag[input][output][p*numBins]);
+		}
+	}
+
+	uint32_t getBlockSize() { return blockSize; }
+	uint32_t getPosition() { return position; }
+
+	// --- samples into the current block for one input
+	inline void write(uint32_t input, const double* samples, uint32_t count)
+	{
+		memcpy(&inputHistory[input][blockSize + position], samples, count * sizeof(double));
+	}
+
+	// --- accumulate count samples of one output from the last block
+	inline void read(uint32_t output, double* samples, uint32_t count)
+	{
+		const double* y = &outputBlock[output][position];
+		for (uint32_t n = 0; n < count; n++)
+			samples[n] += y[n];
+	}
+
+	// --- move on; runs the block at the boundary
+	//     NOTE: write( ) and read( ) must not cross the boundary (count <= blockSize - getPosition( ))
+	inline void advance(uint32_t count)
+	{
+		position += count;
+		if (position < blockSize)
+			return;
+
+		processPartitions();
+		position = 0;
+	}
+
+protected:
+	uint32_t blockSize = 0;
+	uint32_t fftSize = 0;
+	uint32_t numBins = 0;
+	uint32_t numPartitions = 0;
+	uint32_t irOffset = 0;
+	uint32_t numInputs = 0;
+	uint32_t numOutputs = 0;
+
+	// --- IR spectra and routing
+	std::vector<double> irReal[MAX_CONVOLVER_CHANNELS][MAX_CONVOLVER_CHANNELS];
+	std::vector<double> irImag[MAX_CONVOLVER_CHANNELS][MAX_CONVOLVER_CHANNELS];
+	bool pathEnabled[MAX_CONVOLVER_CHANNELS][MAX_CONVOLVER_CHANNELS] = { { false } };
+
+	// --- frequency-domain delay lines; fdlIndex is the newest partition
+	std::vector<double> fdlReal[MAX_CONVOLVER_CHANNELS];
+	std::vector<double> fdlImag[MAX_CONVOLVER_CHANNELS];
+	uint32_t fdlIndex = 0;
+
+	// --- time domain: [last block | this block] per input, and the output of the last block
+	std::vector<double> inputHistory[MAX_CONVOLVER_CHANNELS];
+	std::vector<double> outputBlock[MAX_CONVOLVER_CHANNELS];
+	uint32_t position = 0;
+
+	// --- FFT and work buffers
+	FFTEngine fftEngine;
+	std::vector<double> workTime;
+	std::vector<double> accReal;
+	std::vector<double> accImag;
+
+	// --- one block: FFT the inputs into the FDL, multiply-add all partitions, IFFT the outputs
+	void processPartitions()
+	{
+		fdlIndex = fdlIndex == 0 ? numPartitions - 1 : fdlIndex - 1;
+
+		for (uint32_t i = 0; i < numInputs; i++)
+		{
+			fftEngine.forwardReal(&inputHistory[i][0], &fdlReal[i][fdlIndex*numBins], &fdlImag[i][fdlIndex*numBins]);
+
+			// --- slide the history: this block becomes the last block
+			memcpy(&inputHistory[i][0], &inputHistory[i][blockSize], blockSize * sizeof(double));
+		}
+
+		for (uint32_t o = 0; o < numOutputs; o++)
+		{
+			std::fill(accReal.begin(), accReal.end(), 0.0);
+			std::fill(accImag.begin(), accImag.end(), 0.0);
+
+			bool active = false;
+			for (uint32_t i = 0; i < numInputs; i++)
+			{
+				if (!pathEnabled[i][o])
+					continue;
+				active = true;
+
+				for (uint32_t p = 0; p < numPartitions; p++)
+				{
+					// --- partition p of the IR meets the input from p blocks ago
+					uint32_t slot = fdlIndex + p;
+					if (slot >= numPartitions)
+						slot -= numPartitions;
+
+					const double* xr = &fdlReal[i][slot*numBins];
+					const double* xi = &fdlImag[i][slot*numBins];
+					const double* hr = &irReal[i][o][p*numBins];
+					const double* hi = &irImag[i][o][p*numBins];
+					for (uint32_t k = 0; k < numBins; k++)
+					{
+						accReal[k] += xr[k] * hr[k] - xi[k] * hi[k];
+						accImag[k] += xr[k] * hi[k] + xi[k] * hr[k];
+					}
+				}
+			}
+
+			if (!active)
+			{
+				std::fill(outputBlock[o].begin(), outputBlock[o].end(), 0.0);
+				continue;
+			}
+
+			fftEngine.inverseReal(&accReal[0], &accImag[0], &workTime[0]);
+
+			// --- overlap-save: the second half is the valid linear convolution
+			memcpy(&outputBlock[o][0], &workTime[blockSize], blockSize * sizeof(double));
+		}
+	}
+};
+
+/**
+\struct ConvolverStageSet
+\ingroup SynthStructures
+\brief One complete partitioning of the IRs: the head and tail stages, the routing and the dry delay.
+The PartitionedConvolver keeps two so a new set can be built while the other one plays.
+
+- hasIR : false = no IR is loaded for the routing; the set passes the input through unchanged
+*/
+struct ConvolverStageSet
+{
+	ConvolutionStage head;
+	ConvolutionStage tail;
+	bool tailEnabled = false;
+	bool hasIR = false;
+	uint32_t headBlockSize = MIN_CONVOLVER_PARTITION;
+	uint32_t numInputs = 1;
+	uint32_t numOutputs = 1;
+
+	// --- the dry path is delayed by the latency; it runs in step with the head block position
+	std::vector<double> dryDelay[MAX_CONVOLVER_CHANNELS];
+
+	// --- clear the signal state
+	void reset()
+	{
+		head.reset();
+		tail.reset();
+		for (uint32_t ch = 0; ch < MAX_CONVOLVER_CHANNELS; ch++)
+			std::fill(dryDelay[ch].begin(), dryDelay[ch].end(), 0.0);
+	}
+};
+
+/**
+\class PartitionedConvolver
+\ingroup SynthClasses
+\brief Low-latency FFT convolver for long impulse responses (cabinets, body resonances, reverbs) in mono,
+stereo or true-stereo; for short zero-latency FIRs ImpulseConvolver is still the simpler choice.
+
+- uniform mode: one ConvolutionStage with partitionSize blocks; latency = partitionSize
+- two-stage (non-uniform) mode: the head stage covers the first (tailPartitionSize - partitionSize) samples
+  of the IR and a tail stage with tailPartitionSize blocks covers the rest; the tail's own latency lines up
+  exactly with the head's, so no extra delay is needed. The tail runs its FFTs on its own (rarer) block
+  boundaries, so the CPU load per host block is less even than in uniform mode
+- the IRs are kept in the time domain so a change of partition sizes can re-partition them
+- until an IR is loaded the convolver passes its input through
+
+Double-buffered stage sets: the audio thread plays the active set while a new one is built in the other:
+- setImpulseResponse( ) builds on the calling thread (never the audio thread)
+- setParameters( ) is realtime safe: a change of mode or partition sizes is only posted; the builder thread
+  re-partitions in the background
+- the builder thread is started by the first setImpulseResponse( ) (until then there is nothing to re-partition)
+  and sleeps on a condition variable until it is handed work; the audio thread only wakes it when it can take
+  the mutex without blocking, and otherwise retries at its next block
+- a finished set is published with an atomic flag; the audio thread picks it up at the start of its next block
+  and crossfades to it over CONVOLVER_CROSSFADE_SAMPLES, then the old set is free for the next build
+
+\author Will Pirkle
+\version Revision : 1.0
+\date Date : 2018 / 09 / 24
+*/
+class PartitionedConvolver : public IAudioSignalProcessor
+{
+public:
+	PartitionedConvolver()
+	{
+		// --- the first set is the pass-through; the builder thread starts with the first IR
+		requestedMode = (uint32_t)parameters.mode;
+		requestedPartitionSize = parameters.partitionSize;
+		requestedTailPartitionSize = parameters.tailPartitionSize;
+		buildStageSet(stageSet[0]);
+	}
+	~PartitionedConvolver()
+	{
+		{
+			std::lock_guard<std::mutex> lock(builderMutex);
+			stopBuilder = true;
+		}
+		builderWake.notify_one();
+		if (builderThread.joinable())
+			builderThread.join();
+	}
+
+	// --- IAudioSignalProcessor; a set that is waiting or fading in is switched to at once
+	virtual bool reset(double _sampleRate)
+	{
+		if (fading)
+			finishCrossfade();
+		else if (swapState.load(std::memory_order_acquire) == kSwapReady)
+		{
+			uint32_t expected = kSwapReady;
+			if (swapState.compare_exchange_strong(expected, kSwapFading, std::memory_order_acq_rel))
+			{
+				fadeSet = 1 - activeSet.load(std::memory_order_relaxed);
+				finishCrossfade();
+			}
+		}
+
+		stageSet[activeSet.load(std::memory_order_relaxed)].reset();
+		return true;
+	}
+
+	virtual bool canProcessAudioFrame() { return true; }
+
+	// --- mono in, mono out (output 0)
+	virtual double processAudioSample(double xn)
+	{
+		double inputs[MAX_CONVOLVER_CHANNELS] = { xn, xn };
+		double outputs[MAX_CONVOLVER_CHANNELS] = { 0.0 };
+		processFrame(inputs, outputs);
+		return outputs[0];
+	}
+
+	virtual bool processAudioFrame(const float* inputFrame, float* outputFrame, uint32_t inputChannels, uint32_t outputChannels)
+	{
+		if (inputChannels == 0 || outputChannels == 0)
+			return false;
+
+		double inputs[MAX_CONVOLVER_CHANNELS] = { inputFrame[0], inputChannels > 1 ? inputFrame[1] : inputFrame[0] };
+		double outputs[MAX_CONVOLVER_CHANNELS] = { 0.0 };
+		processFrame(inputs, outputs);
+
+		outputFrame[0] = (float)outputs[0];
+		if (outputChannels > 1)
+			outputFrame[1] = (float)outputs[1];
+		return true;
+	}
+
+	virtual void processAudioBlock(const float* input, float* output, uint32_t blockSize)
+	{
+		processFloatBlock(input, input, output, nullptr, blockSize);
+	}
+
+	virtual bool processStereoAudioBlock(const float* inputLeft, const float* inputRight,
+										 float* outputLeft, float* outputRight,
+										 uint32_t blockSize)
+	{
+		processFloatBlock(inputLeft, inputRight, outputLeft, outputRight, blockSize);
+		return true;
+	}
+
+	// --- stereo block on the engine's double buffers, in place
+	void processBlock(double* left, double* right, uint32_t blockSize)
+	{
+		checkForNewStages();
+
+		uint32_t done = 0;
+		while (done < blockSize)
+		{
+			uint32_t count = getChunkSize(blockSize - done);
+			processChunk(&left[done], &right[done], &left[done], &right[done], count);
+			done += count;
+		}
+	}
+
+	// --- parameters; realtime safe: a change of mode or partition sizes is re-partitioned by the builder thread
+	PartitionedConvolverParameters getParameters() { return parameters; }
+	void setParameters(const PartitionedConvolverParameters& params)
+	{
+		bool rebuild = params.mode != parameters.mode || params.partitionSize != parameters.partitionSize ||
+			params.tailPartitionSize != parameters.tailPartitionSize;
+
+		parameters = params;
+		wetGain = dB2Raw(parameters.wetLevel_dB);
+		dryGain = parameters.dryLevel_dB <= -96.0 ? 0.0 : dB2Raw(parameters.dryLevel_dB);
+
+		if (rebuild)
+		{
+			requestedMode = (uint32_t)parameters.mode;
+			requestedPartitionSize = parameters.partitionSize;
+			requestedTailPartitionSize = parameters.tailPartitionSize;
+			rebuildRequested.store(true);
+			builderWakePending = true;
+			wakeBuilder();
+		}
+	}
+
+	// --- one path of the routing matrix (see convolverMode); ir = nullptr or length = 0 clears it
+	//     NOTE: allocates and transforms on the calling thread; do not call from the audio thread
+	void setImpulseResponse(uint32_t input, uint32_t output, const double* ir, uint32_t length)
+	{
+		if (input >= MAX_CONVOLVER_CHANNELS || output >= MAX_CONVOLVER_CHANNELS)
+			return;
+
+		std::lock_guard<std::mutex> lock(builderMutex);
+		if (ir && length > 0)
+			impulseResponse[input][output].assign(ir, ir + length);
+		else
+			impulseResponse[input][output].clear();
+
+		startBuilder();
+		rebuildRequested.store(true);
+		buildPendingStages();
+	}
+
+	// --- the same IR on the direct paths ([0][0] and [1][1]); clears the cross paths
+	//     NOTE: allocates and transforms on the calling thread; do not call from the audio thread
+	void setImpulseResponse(const double* ir, uint32_t length)
+	{
+		std::lock_guard<std::mutex> lock(builderMutex);
+		for (uint32_t i = 0; i < MAX_CONVOLVER_CHANNELS; i++)
+		{
+			for (uint32_t o = 0; o < MAX_CONVOLVER_CHANNELS; o++)
+			{
+				if (i == o && ir && length > 0)
+					impulseResponse[i][o].assign(ir, ir + length);
+				else
+					impulseResponse[i][o].clear();
+			}
+		}
+
+		startBuilder();
+		rebuildRequested.store(true);
+		buildPendingStages();
+	}
+
+	// --- latency in samples of the playing set; 0 while it passes through (no IR)
+	uint32_t getLatency()
+	{
+		ConvolverStageSet& set = stageSet[activeSet.load(std::memory_order_acquire)];
+		return set.hasIR ? set.headBlockSize : 0;
+	}
+
+protected:
+	PartitionedConvolverParameters parameters;
+
+	// --- double-buffered stage sets; the audio thread owns the active one (and the fading one)
+	ConvolverStageSet stageSet[2];
+	std::atomic<uint32_t> activeSet{ 0 };
+
+	// --- swap handshake: kSwapReady is set by the builder, kSwapFading and kSwapIdle by the audio thread
+	enum { kSwapIdle, kSwapReady, kSwapFading };
+	std::atomic<uint32_t> swapState{ kSwapIdle };
+
+	// --- crossfade; audio thread only
+	bool fading = false;
+	uint32_t fadeSet = 0;
+	uint32_t fadePosition = 0;
+
+	// --- partitioning posted by setParameters( ) for the builder
+	std::atomic<uint32_t> requestedMode{ 0 };
+	std::atomic<uint32_t> requestedPartitionSize{ 0 };
+	std::atomic<uint32_t> requestedTailPartitionSize{ 0 };
+	std::atomic<bool> rebuildRequested{ false };
+
+	// --- builder thread; builderMutex also guards the IRs
+	std::thread builderThread;
+	std::mutex builderMutex;
+	std::condition_variable builderWake;
+	bool stopBuilder = false;
+	bool builderWakePending = false;	///< audio thread: a posted rebuild the builder has not been woken for
+
+	// --- time-domain IRs [input][output]; only touched with builderMutex held
+	std::vector<double> impulseResponse[MAX_CONVOLVER_CHANNELS][MAX_CONVOLVER_CHANNELS];
+
+	// --- wet/dry
+	double wetGain = 1.0;
+	double dryGain = 0.0;
+
+	// --- power of two in [MIN_CONVOLVER_PARTITION, MAX_CONVOLVER_PARTITION]
+	static uint32_t boundPartitionSize(uint32_t size)
+	{
+		uint32_t bounded = MIN_CONVOLVER_PARTITION;
+		while (bounded < size && bounded < MAX_CONVOLVER_PARTITION)
+			bounded *= 2;
+		return bounded;
+	}
+
+	static bool isPathUsed(convolverMode mode, uint32_t input, uint32_t output)
+	{
+		if (mode == convolverMode::kTrueStereo)
+			return true;
+		return input == output;
+	}
+
+	// --- start the builder thread once. NOTE: builderMutex must be held
+	void startBuilder()
+	{
+		if (!builderThread.joinable())
+			builderThread = std::thread(&PartitionedConvolver::builderLoop, this);
+	}
+
+	// --- service posted partitioning changes until the convolver is destroyed; sleeps until a rebuild is
+	//     posted and the audio thread is not fading (setParameters( ) and finishCrossfade( ) wake it)
+	void builderLoop()
+	{
+		std::unique_lock<std::mutex> lock(builderMutex);
+		while (!stopBuilder)
+		{
+			builderWake.wait(lock, [this] { return stopBuilder ||
+				(rebuildRequested.load() && swapState.load() != kSwapFading); });
+			if (!stopBuilder)
+				buildPendingStages();
+		}
+	}
+
+	// --- audio thread: wake the builder for a posted rebuild without blocking; the builder only sleeps with
+	//     builderMutex released, so once we hold it the builder sees the request. If the mutex is busy the
+	//     wake stays pending for the next block
+	inline void wakeBuilder()
+	{
+		std::unique_lock<std::mutex> lock(builderMutex, std::try_to_lock);
+		if (!lock.owns_lock())
+			return;
+
+		builderWakePending = false;
+		lock.unlock();
+		builderWake.notify_one();
+	}
+
+	// --- build the free set and publish it; false if the audio thread is still fading (the request stays
+	//     posted and the builder thread retries). NOTE: builderMutex must be held
+	bool buildPendingStages()
+	{
+		uint32_t state = swapState.load();
+		if (state == kSwapFading)
+			return false;
+
+		// --- take back a set the audio thread has not picked up yet
+		if (state == kSwapReady && !swapState.compare_exchange_strong(state, kSwapIdle, std::memory_order_acq_rel))
+			return false;
+
+		rebuildRequested.store(false, std::memory_order_release);
+		buildStageSet(stageSet[1 - activeSet.load(std::memory_order_acquire)]);
+		swapState.store(kSwapReady, std::memory_order_release);
+		return true;
+	}
+
+	// --- repartition the stored IRs for the posted mode and sizes
+	void buildStageSet(ConvolverStageSet& set)
+	{
+		convolverMode mode = (convolverMode)requestedMode.load(std::memory_order_acquire);
+		uint32_t partitionSize = requestedPartitionSize.load(std::memory_order_acquire);
+		uint32_t tailPartitionSize = requestedTailPartitionSize.load(std::memory_order_acquire);
+
+		set.numInputs = mode == convolverMode::kMono ? 1 : 2;
+		set.numOutputs = mode == convolverMode::kMono ? 1 : 2;
+
+		uint32_t irLength = 0;
+		for (uint32_t i = 0; i < set.numInputs; i++)
+		{
+			for (uint32_t o = 0; o < set.numOutputs; o++)
+			{
+				if (isPathUsed(mode, i, o) && impulseResponse[i][o].size() > irLength)
+					irLength = (uint32_t)impulseResponse[i][o].size();
+			}
+		}
+
+		set.hasIR = irLength > 0;
+		set.headBlockSize = boundPartitionSize(partitionSize);
+		uint32_t tailBlockSize = tailPartitionSize > set.headBlockSize ? boundPartitionSize(tailPartitionSize) : 0;
+
+		// --- the tail starts where its latency matches the head's
+		uint32_t tailOffset = tailBlockSize - set.headBlockSize;
+		set.tailEnabled = tailBlockSize > set.headBlockSize && irLength > tailOffset;
+
+		set.head.initialize(set.headBlockSize, 0, set.tailEnabled ? tailOffset : irLength, set.numInputs, set.numOutputs);
+		if (set.tailEnabled)
+			set.tail.initialize(tailBlockSize, tailOffset, irLength - tailOffset, set.numInputs, set.numOutputs);
+
+		for (uint32_t i = 0; i < set.numInputs; i++)
+		{
+			for (uint32_t o = 0; o < set.numOutputs; o++)
+			{
+				if (!isPathUsed(mode, i, o) || impulseResponse[i][o].empty())
+					continue;
+
+				set.head.setImpulseResponse(i, o, &impulseResponse[i][o][0], (uint32_t)impulseResponse[i][o].size());
+				if (set.tailEnabled)
+					set.tail.setImpulseResponse(i, o, &impulseResponse[i][o][0], (uint32_t)impulseResponse[i][o].size());
+			}
+		}
+
+		for (uint32_t ch = 0; ch < MAX_CONVOLVER_CHANNELS; ch++)
+			set.dryDelay[ch].assign(set.headBlockSize, 0.0);
+	}
+
+	// --- audio thread: start fading to a published set
+	inline void checkForNewStages()
+	{
+		if (builderWakePending)
+			wakeBuilder();
+
+		if (fading || swapState.load(std::memory_order_acquire) != kSwapReady)
+			return;
+
+		uint32_t expected = kSwapReady;
+		if (!swapState.compare_exchange_strong(expected, kSwapFading, std::memory_order_acq_rel))
+			return;
+
+		fadeSet = 1 - activeSet.load(std::memory_order_relaxed);
+		fadePosition = 0;
+		fading = true;
+	}
+
+	// --- audio thread: the faded-in set becomes the active one; the old one goes back to the builder
+	//     (a rebuild that was posted during the fade is handed to the builder now)
+	void finishCrossfade()
+	{
+		activeSet.store(fadeSet, std::memory_order_release);
+		fading = false;
+		swapState.store(kSwapIdle);
+
+		if (rebuildRequested.load())
+		{
+			builderWakePending = true;
+			wakeBuilder();
+		}
+	}
+
+	// --- largest chunk that stays inside the current head block of every playing set (the tail boundaries
+	//     are head boundaries too) and inside the crossfade
+	inline uint32_t getChunkSize(uint32_t remaining)
+	{
+		uint32_t count = remaining < CONVOLVER_CHUNK_SIZE ? remaining : CONVOLVER_CHUNK_SIZE;
+		count = limitChunkSize(stageSet[activeSet.load(std::memory_order_relaxed)], count);
+		if (fading)
+		{
+			count = limitChunkSize(stageSet[fadeSet], count);
+			if (count > CONVOLVER_CROSSFADE_SAMPLES - fadePosition)
+				count = CONVOLVER_CROSSFADE_SAMPLES - fadePosition;
+		}
+		return count;
+	}
+
+	inline uint32_t limitChunkSize(ConvolverStageSet& set, uint32_t count)
+	{
+		if (!set.hasIR)
+			return count;
+		uint32_t blockRemaining = set.headBlockSize - set.head.getPosition();
+		return count < blockRemaining ? count : blockRemaining;
+	}
+
+	// --- one chunk; outputs may alias the inputs
+	inline void processChunk(const double* inputLeft, const double* inputRight, double* outputLeft, double* outputRight, uint32_t count)
+	{
+		if (!fading)
+		{
+			processStageSet(stageSet[activeSet.load(std::memory_order_relaxed)], inputLeft, inputRight, outputLeft, outputRight, count);
+			return;
+		}
+
+		// --- both sets hear the input; equal-gain linear crossfade from the old to the new
+		double oldLeft[CONVOLVER_CHUNK_SIZE];
+		double oldRight[CONVOLVER_CHUNK_SIZE];
+		double newLeft[CONVOLVER_CHUNK_SIZE];
+		double newRight[CONVOLVER_CHUNK_SIZE];
+		processStageSet(stageSet[activeSet.load(std::memory_order_relaxed)], inputLeft, inputRight, oldLeft, oldRight, count);
+		processStageSet(stageSet[fadeSet], inputLeft, inputRight, newLeft, newRight, count);
+
+		const double fadeInc = 1.0 / (double)CONVOLVER_CROSSFADE_SAMPLES;
+		for (uint32_t n = 0; n < count; n++)
+		{
+			double fade = (double)(fadePosition + n + 1)*fadeInc;
+			outputLeft[n] = oldLeft[n] + fade*(newLeft[n] - oldLeft[n]);
+			outputRight[n] = oldRight[n] + fade*(newRight[n] - oldRight[n]);
+		}
+
+		fadePosition += count;
+		if (fadePosition >= CONVOLVER_CROSSFADE_SAMPLES)
+			finishCrossfade();
+	}
+
+	// --- one chunk through one set, inside its head block; outputs may alias the inputs
+	inline void processStageSet(ConvolverStageSet& set, const double* inputLeft, const double* inputRight, double* outputLeft, double* outputRight, uint32_t count)
+	{
+		// --- no IR yet: pass through
+		if (!set.hasIR)
+		{
+			if (outputLeft != inputLeft)
+				memcpy(outputLeft, inputLeft, count * sizeof(double));
+			if (outputRight != inputRight)
+				memcpy(outputRight, inputRight, count * sizeof(double));
+			return;
+		}
+
+		double wet[MAX_CONVOLVER_CHANNELS][CONVOLVER_CHUNK_SIZE];
+		double dry[MAX_CONVOLVER_CHANNELS][CONVOLVER_CHUNK_SIZE];
+		const double* inputs[MAX_CONVOLVER_CHANNELS] = { inputLeft, inputRight };
+
+		// --- dry path: read the delayed samples, write the new ones
+		for (uint32_t ch = 0; ch < MAX_CONVOLVER_CHANNELS; ch++)
+		{
+			double* delay = &set.dryDelay[ch][set.head.getPosition()];
+			for (uint32_t n = 0; n < count; n++)
+			{
+				dry[ch][n] = delay[n];
+				delay[n] = inputs[ch][n];
+			}
+		}
+
+		// --- mono mode sums to one input
+		if (set.numInputs == 1)
+		{
+			for (uint32_t n = 0; n < count; n++)
+				wet[0][n] = 0.5*(inputLeft[n] + inputRight[n]);
+			set.head.write(0, wet[0], count);
+			if (set.tailEnabled)
+				set.tail.write(0, wet[0], count);
+		}
+		else
+		{
+			for (uint32_t i = 0; i < set.numInputs; i++)
+			{
+				set.head.write(i, inputs[i], count);
+				if (set.tailEnabled)
+					set.tail.write(i, inputs[i], count);
+			}
+		}
+
+		for (uint32_t o = 0; o < set.numOutputs; o++)
+		{
+			memset(&wet[o][0], 0, count * sizeof(double));
+			set.head.read(o, wet[o], count);
+			if (set.tailEnabled)
+				set.tail.read(o, wet[o], count);
+		}
+
+		set.head.advance(count);
+		if (set.tailEnabled)
+			set.tail.advance(count);
+
+		// --- mono mode feeds both outputs
+		const double* wetRight = set.numOutputs > 1 ? wet[1] : wet[0];
+		for (uint32_t n = 0; n < count; n++)
+		{
+			outputLeft[n] = wetGain*wet[0][n] + dryGain*dry[0][n];
+			outputRight[n] = wetGain*wetRight[n] + dryGain*dry[1][n];
+		}
+	}
+
+	// --- single frame
+	inline void processFrame(const double* inputs, double* outputs)
+	{
+		checkForNewStages();
+		processChunk(&inputs[0], &inputs[1], &outputs[0], &outputs[1], 1);
+	}
+
+	// --- float blocks through a double chunk; outputRight may be nullptr (mono)
+	void processFloatBlock(const float* inputLeft, const float* inputRight, float* outputLeft, float* outputRight, uint32_t blockSize)
+	{
+		double left[CONVOLVER_CHUNK_SIZE];
+		double right[CONVOLVER_CHUNK_SIZE];
+
+		checkForNewStages();
+
+		uint32_t done = 0;
+		while (done < blockSize)
+		{
+			uint32_t count = getChunkSize(blockSize - done);
+
+			for (uint32_t n = 0; n < count; n++)
+			{
+				left[n] = inputLeft[done + n];
+				right[n] = inputRight[done + n];
+			}
+
+			processChunk(left, right, left, right, count);
+
+			for (uint32_t n = 0; n < count; n++)
+				outputLeft[done + n] = (float)left[n];
+			if (outputRight)
+			{
+				for (uint32_t n = 0; n < count; n++)
+					outputRight[done + n] = (float)right[n];
+			}
+			done += count;
+		}
+	}
+};
+
+#endif /* defined(__partitionedConvolver_h__) */
@@ -11,6 +11,7 @@ SynthVoice::SynthVoice(const std::shared_ptr<MidiInputData> _midiInputData,
 , midiInputData(_midiInputData)		//<- set our midi dat interface value
 , midiOutputData(_midiOutputData)
 , parameters(_parameters)	//<- set our parameters
+, waveTableData(_waveTableData)
 {
 	if (!midiInputData)
 		;// --- throw exceptuion, etc...
@@ -27,6 +28,17 @@ SynthVoice::SynthVoice(const std::shared_ptr<MidiInputData> _midiInputData,
 	osc2.reset(new SynthOsc(midiInputData, parameters->osc2Parameters, _waveTableData));
 	osc3.reset(new SynthOsc(midiInputData, parameters->osc3Parameters, _waveTableData));
 	osc4.reset(new SynthOsc(midiInputData, parameters->osc4Parameters, _waveTableData));
+
+	noiseOsc.reset(new NoiseOscillator(parameters->noiseOscParameters));
+
+	// --- the unison layout is shared by all four oscillators
+	osc1->setUnisonParameters(parameters->unisonParameters);
+	osc2->setUnisonParameters(parameters->unisonParameters);
+	osc3->setUnisonParameters(parameters->unisonParameters);
+	osc4->setUnisonParameters(parameters->unisonParameters);
+
+	// --- the oscillators are also the FM operators
+	fmMatrix.setOperators(osc1.get(), osc2.get(), osc3.get(), osc4.get());
 	
 	lfo1.reset(new SynthLFO(midiInputData, parameters->lfo1Parameters));
 
@@ -36,6 +48,11 @@ SynthVoice::SynthVoice(const std::shared_ptr<MidiInputData> _midiInputData,
 
 	dca.reset(new DCA(midiInputData, parameters->dcaParameters));
 
+	filter1.reset(new TwinMoogFilters(midiInputData, parameters->filter1Parameters));
+
+	// --- same parameters and modulation as filter1
+	filter1Right.reset(new TwinMoogFilters(midiInputData, parameters->filter1Parameters));
+	filter1Right->setModulators(filter1->getModulators());
 }
 
 SynthVoice::~SynthVoice()
@@ -87,8 +104,9 @@ std::vector<std::string> SynthVoice::getBankNames(uint32_t oscIndex)
 // --- NOTE: parameters.dllFolderPath MUST be set before this call!!
 bool SynthVoice::initialize(PluginInfo pluginInfo)
 {
-	// --- use this to setup morphing wave table osc
-	// add your code here
+	// --- setup morphing wave table osc; the data is shared so only the first voice does the work
+	if (waveTableData)
+		waveTableData->initMorphingWaveBanks();
 
 	return true;
 }
@@ -98,6 +116,7 @@ bool SynthVoice::reset(double _sampleRate)
 {
 	// --- clear output array
 	synthOutputData.clear();
+	sampleRate = _sampleRate;
 
 	// --- reset sub objects
 	osc1->reset(_sampleRate);
@@ -105,6 +124,9 @@ bool SynthVoice::reset(double _sampleRate)
 	osc3->reset(_sampleRate);
 	osc4->reset(_sampleRate);
 
+	noiseOsc->reset();
+	fmMatrix.reset();
+
 	lfo1->reset(_sampleRate);
 	lfo2->reset(_sampleRate);
 
@@ -112,10 +134,22 @@ bool SynthVoice::reset(double _sampleRate)
 
 	dca->reset(_sampleRate);
 
+	filter1->reset(_sampleRate);
+	filter1Right->reset(_sampleRate);
+	stereoOutput = false;
+	preFilterRight = 0.0;
+
 	// --- reset grain count
 	updateGranularity = 64; // update every 128 render-cycles
 	granularityCounter = -1;
 
+	// --- filter cutoff ramps between updates
+	filter1->setCoefficientRampLength(updateGranularity);
+	filter1Right->setCoefficientRampLength(updateGranularity);
+
+	// --- so does the DCA gain
+	dca->setGainRampLength(updateGranularity);
+
 	// --- clear modulator output arrays
 	lfo1Output.clear();
 	lfo2Output.clear();
@@ -127,9 +161,134 @@ bool SynthVoice::reset(double _sampleRate)
 	// --- init the source and destination array's of modulator pointers
 	initModMatrix();
 
+	// --- setup (or clear) the oversampler
+	currentOversamplingRatio = 0;
+	updateOversampling();
+
 	return true;
 }
 
+void SynthVoice::updateOversampling()
+{
+	if (parameters->oversamplingRatio == currentOversamplingRatio)
+		return;
+
+	currentOversamplingRatio = parameters->oversamplingRatio;
+	oversampler.initialize(currentOversamplingRatio, sampleRate);
+	oversamplerRight.initialize(currentOversamplingRatio, sampleRate);
+
+	// --- the oversampler bounds the ratio to 1, 2 or 4
+	currentOversamplingRatio = oversampler.getRatio();
+	osc1->setOversamplingRatio(currentOversamplingRatio);
+	osc2->setOversamplingRatio(currentOversamplingRatio);
+	osc3->setOversamplingRatio(currentOversamplingRatio);
+	osc4->setOversamplingRatio(currentOversamplingRatio);
+}
+
+double SynthVoice::renderOscillatorBlend(double& right)
+{
+	double blend = 0.0;
+
+	// --- FM: the operator matrix renders the oscillators in dependency order and mixes the carriers
+	if (fmMatrix.isEnabled())
+	{
+		blend = fmMatrix.renderAudioOutput();
+
+		osc1Output.outputs[0] = fmMatrix.getOperatorOutput(0);
+		osc2Output.outputs[0] = fmMatrix.getOperatorOutput(1);
+		osc3Output.outputs[0] = fmMatrix.getOperatorOutput(2);
+		osc4Output.outputs[0] = fmMatrix.getOperatorOutput(3);
+		right = blend;
+	}
+	else
+	{
+		// --- render Oscillators (add more here)
+		osc1Output = osc1->renderAudioOutput();
+		osc2Output = osc2->renderAudioOutput();
+		osc3Output = osc3->renderAudioOutput();
+		osc4Output = osc4->renderAudioOutput();
+
+		// --- blend oscillator outputs
+		blend = parameters->vectorJSData.vectorA * osc1Output.outputs[0]
+			+ parameters->vectorJSData.vectorB * osc2Output.outputs[0]
+			+ parameters->vectorJSData.vectorC * osc3Output.outputs[0]
+			+ parameters->vectorJSData.vectorD * osc4Output.outputs[0]; // +... add more oscillator outputs here
+
+		// --- spread unison stacks: same blend on the right outputs
+		if (stereoOutput)
+			right = parameters->vectorJSData.vectorA * osc1Output.outputs[1]
+				+ parameters->vectorJSData.vectorB * osc2Output.outputs[1]
+				+ parameters->vectorJSData.vectorC * osc3Output.outputs[1]
+				+ parameters->vectorJSData.vectorD * osc4Output.outputs[1];
+		else
+			right = blend;
+	}
+
+	// --- noise is outside the vector mix
+	if (noiseOsc->isActive())
+	{
+		double noise = noiseOsc->renderAudioOutput();
+		blend += noise;
+		right += noise;
+	}
+
+	return blend;
+}
+
+// --- streams: one block of 8 per voice, so adding sources later does not shift the others
+void SynthVoice::setNoiseSeed(uint64_t seed, uint32_t voiceIndex)
+{
+	uint64_t stream = 8 * (uint64_t)voiceIndex;
+	lfo1->setNoiseSeed(seed, stream);
+	lfo2->setNoiseSeed(seed, stream + 1);
+	noiseOsc->setSeed(seed, stream + 2);
+	osc1->setNoiseSeed(seed, stream + 3);
+	osc2->setNoiseSeed(seed, stream + 4);
+	osc3->setNoiseSeed(seed, stream + 5);
+	osc4->setNoiseSeed(seed, stream + 6);
+}
+
+// --- only compute the LFO outputs that are routed somewhere; the derived (inverted/unipolar)
+//     outputs are not mod sources in this voice
+void SynthVoice::updateLFORouting()
+{
+	bool lfo1QuadPhase = false;
+	bool lfo2QuadPhase = false;
+
+	if (modDestinationColumns)
+	{
+		for (int col = 0; col < kNumModDestinations; col++)
+		{
+			const ModDestination& destination = modDestinationColumns->at(col);
+			lfo1QuadPhase |= destination.channelEnable[kLFO1_QuadPhase] != 0;
+			lfo2QuadPhase |= destination.channelEnable[kLFO2_QuadPhase] != 0;
+		}
+	}
+
+	lfo1->setRoutedOutputs(lfo1QuadPhase, false);
+	lfo2->setRoutedOutputs(lfo2QuadPhase, false);
+}
+
+void SynthVoice::renderLFOOutput(SynthLFO* lfo, LFOBlockData& block, LFOBlockData* sharedBlock, ModOutputData& output, bool updateAllModRoutings)
+{
+	// --- free-running LFO computed once by the engine; a block render reads ahead of its read index
+	if (sharedBlock && sharedBlock->enabled && lfo->isFreeRunning())
+	{
+		lfo->writeOutputs(output, *sharedBlock, sharedBlock->readIndex + sharedLFOFrame);
+		return;
+	}
+
+	// --- the LFO only changes frequency on full updates, so a block per update is exact;
+	//     a run-out block (e.g. just switched from the shared LFO) is re-rendered
+	if (updateAllModRoutings || block.readIndex >= block.blockSize)
+	{
+		lfo->update(true);
+		lfo->renderModulatorBlock(block, updateGranularity);
+	}
+
+	lfo->writeOutputs(output, block, block.readIndex++);
+}
+
 // --- run the matrix
 void SynthVoice::runModulationMatrix(bool updateAllModRoutings)
 {
@@ -174,16 +333,26 @@ void SynthVoice::runModulationMatrix(bool updateAllModRoutings)
 }
 
 const SynthRenderData SynthVoice::renderAudioOutput()
+{
+	// --- do the filtering
+	double filterOutput = filter1->processAudioSample(renderPreFilter());
+	double filterOutputRight = stereoOutput ? filter1Right->processAudioSample(preFilterRight) : filterOutput;
+
+	return renderPostFilter(filterOutput, filterOutputRight);
+}
+
+// --- everything up to the filter: modulators, mod matrix, component updates and the oscillator blend
+double SynthVoice::renderPreFilter()
 {
 	// --- run the granularity counter
 	bool updateAllModRoutings = needsComponentUpdate();
 
-	// --- update/render (add more here)
-	lfo1->update(updateAllModRoutings);
-	lfo1Output = lfo1->renderModulatorOutput();
+	// --- LFOs render a block on each component update; we read one sample per render
+	if (updateAllModRoutings)
+		updateLFORouting();
 
-	lfo2->update(updateAllModRoutings);
-	lfo2Output = lfo2->renderModulatorOutput();
+	renderLFOOutput(lfo1.get(), lfo1Block, sharedLFO1Block.get(), lfo1Output, updateAllModRoutings);
+	renderLFOOutput(lfo2.get(), lfo2Block, sharedLFO2Block.get(), lfo2Output, updateAllModRoutings);
 	
 	// --- update/render (add more here)
 	ampEG->update(updateAllModRoutings);
@@ -198,39 +367,104 @@ const SynthRenderData SynthVoice::renderAudioOutput()
 	osc3->update(updateAllModRoutings);
 	osc4->update(updateAllModRoutings);
 	dca->update(updateAllModRoutings);
+	filter1->update(updateAllModRoutings);
 
-	// --- render Oscillators (add more here)
-	osc1Output = osc1->renderAudioOutput();
-	osc2Output = osc2->renderAudioOutput();
-	osc3Output = osc3->renderAudioOutput();
-	osc4Output = osc4->renderAudioOutput();
+	// --- FM routing changes at control rate
+	if (updateAllModRoutings)
+		fmMatrix.setParameters(*parameters->fmParameters);
 
-	// --- blend oscillator outputs
-	//add the outputs here with 0.25 scaling obviously
-	//double oscOut = 0.25 * osc1Output.outputs[0]
-	//					+ 0.25 * osc2Output.outputs[0] 
-	//					+ 0.25 * osc3Output.outputs[0]
-	//					+ 0.25 * osc4Output.outputs[0]; // +... add more oscillator outputs here
+	// --- a spread unison stack makes the voice stereo up to the DCA; FM operators stay mono
+	if (updateAllModRoutings)
+	{
+		bool stereo = !fmMatrix.isEnabled() &&
+			(osc1->isStereo() || osc2->isStereo() || osc3->isStereo() || osc4->isStereo());
 
-	double oscOut = parameters->vectorJSData.vectorA * osc1Output.outputs[0]
-		+ parameters->vectorJSData.vectorB * osc2Output.outputs[0]
-		+ parameters->vectorJSData.vectorC * osc3Output.outputs[0]
-		+ parameters->vectorJSData.vectorD * osc4Output.outputs[0]; // +... add more oscillator outputs here
+		// --- the right channel path starts clean
+		if (stereo && !stereoOutput)
+		{
+			filter1Right->reset(sampleRate);
+			oversamplerRight.reset();
+		}
+		stereoOutput = stereo;
+	}
 
+	if (stereoOutput)
+		filter1Right->update(updateAllModRoutings);
 
-	// --- do the filtering
-	// add more here
+	// --- render and blend the oscillators; in oversampled mode they run N times and
+	//     the decimator brings the blend back down to fs
+	if (updateAllModRoutings)
+		updateOversampling();
+
+	double oscOut = 0.0;
+	if (currentOversamplingRatio > 1)
+	{
+		for (uint32_t i = 0; i < currentOversamplingRatio; i++)
+			oversampledBuffer[i] = renderOscillatorBlend(oversampledBufferRight[i]);
+
+		oscOut = oversampler.downsample(&oversampledBuffer[0]);
+		if (stereoOutput)
+			preFilterRight = oversamplerRight.downsample(&oversampledBufferRight[0]);
+	}
+	else
+		oscOut = renderOscillatorBlend(preFilterRight);
+
+	return oscOut;
+}
 
-	// --- this voice is MONO up to this point
+// --- multi-voice filter path: advance this voice's cutoff ramp and export both ladders
+twinFilterConfig SynthVoice::getFilterLaneCoeffs(LadderLaneCoeffs& coeffs1, LadderLaneCoeffs& coeffs2)
+{
+	twinFilterConfig config = filter1->getFilterConfiguration();
+	if (config == twinFilterConfig::kBypass)
+		return config;
+
+	filter1->advanceCoefficientRamp();
+	filter1->getLadderLaneCoeffs(0, coeffs1);
+	filter1->getLadderLaneCoeffs(1, coeffs2);
+	return config;
+}
+
+// --- everything after the filter: DCA and the note-off/steal check
+//     NOTE: a mono voice passes the same value for both channels
+const SynthRenderData SynthVoice::renderPostFilter(double filterOutputLeft, double filterOutputRight)
+{
+	// --- this voice is MONO up to this point, unless the unison stack is spread
 	SynthProcessorData audioData;
-	audioData.numInputChannels = 1; // mono in
+	audioData.numInputChannels = 2; // stereo in (identical when mono)
 	audioData.numOutputChannels = 2;// stereo out
-	audioData.inputs[0] = oscOut;
+	audioData.inputs[0] = filterOutputLeft;
+	audioData.inputs[1] = filterOutputRight;
 	
 	// --- dca will make stereo and pan
 	dca->processSynthAudio(&audioData);
 
 	// --- check for note off condition
+	updateVoiceState();
+
+	// --- transfer int our output - note that this gives the voice a chance to 
+	//     relocate, pan, modify, etc.. all of its oscillator outputs
+	//
+	// --- this voice generates two output channels
+	synthOutputData.channelCount = 2;
+
+	// --- summation for the simple core
+	synthOutputData.synthOutputs[0] = audioData.outputs[0];
+	synthOutputData.synthOutputs[1] = audioData.outputs[1];
+
+	///test the oscillators output
+
+	//synthOutputData.synthOutputs[0] =
+	//	lfo1Output.modulationOutputs[kLFONormalOutput];
+	//synthOutputData.synthOutputs[1] =
+	//	lfo2Output.modulationOutputs[kLFONormalOutput];
+
+	return synthOutputData;
+}
+
+// --- once the amp EG is off: start the stolen note or shut the voice down
+void SynthVoice::updateVoiceState()
+{
 	if (voiceIsRunning)
 	{
 		if (ampEG->getState() == egState::kOff)
@@ -254,25 +488,42 @@ const SynthRenderData SynthVoice::renderAudioOutput()
 				voiceIsRunning = false;
 		}
 	}
+}
 
-	// --- transfer int our output - note that this gives the voice a chance to 
-	//     relocate, pan, modify, etc.. all of its oscillator outputs
-	//
-	// --- this voice generates two output channels
-	synthOutputData.channelCount = 2;
+// --- block render: everything from renderAudioOutput( ) up to the DCA runs per frame into the voice buffers;
+//     the DCA then runs in segments that end where it gets new targets (component updates)
+void SynthVoice::renderAudioBlock(double* busLeft, double* busRight, uint32_t blockSize, double busGain)
+{
+	if (blockSize > MAX_RENDER_BLOCK_SIZE)
+		blockSize = MAX_RENDER_BLOCK_SIZE;
 
-	// --- summation for the simple core
-	synthOutputData.synthOutputs[0] = audioData.outputs[0];
-	synthOutputData.synthOutputs[1] = audioData.outputs[1];
+	uint32_t segmentStart = 0;
+	uint32_t blockEnd = 0;
+	for (uint32_t n = 0; n < blockSize && voiceIsRunning; n++)
+	{
+		// --- the DCA is retargeted during this frame's update; flush what it has so far
+		if (willUpdateComponents() && n > segmentStart)
+		{
+			dca->processBlock(&voiceBlockLeft[segmentStart], &voiceBlockRight[segmentStart],
+				&busLeft[segmentStart], &busRight[segmentStart], n - segmentStart, busGain);
+			segmentStart = n;
+		}
 
-	///test the oscillators output
+		// --- the engine keeps the shared LFO blocks' read index at the start of this block
+		sharedLFOFrame = n;
 
-	//synthOutputData.synthOutputs[0] =
-	//	lfo1Output.modulationOutputs[kLFONormalOutput];
-	//synthOutputData.synthOutputs[1] =
-	//	lfo2Output.modulationOutputs[kLFONormalOutput];
+		double filterOutput = filter1->processAudioSample(renderPreFilter());
+		voiceBlockLeft[n] = filterOutput;
+		voiceBlockRight[n] = stereoOutput ? filter1Right->processAudioSample(preFilterRight) : filterOutput;
 
-	return synthOutputData;
+		updateVoiceState();
+		blockEnd = n + 1;
+	}
+	sharedLFOFrame = 0;
+
+	if (blockEnd > segmentStart)
+		dca->processBlock(&voiceBlockLeft[segmentStart], &voiceBlockRight[segmentStart],
+			&busLeft[segmentStart], &busRight[segmentStart], blockEnd - segmentStart, busGain);
 }
 
 bool SynthVoice::doNoteOn(midiEvent& event)
@@ -408,7 +659,7 @@ SynthEngine::SynthEngine()
 
 	// --- EG2 -> Filter 1 (and 2) Fc ??
 
-	// --- EG3 -> Wave Morph??
+	// --- EG3 -> Wave Morph?? (see kOsc1_WaveMorph - kOsc4_WaveMorph)
 
 	// --- set amp mod default value to prevent silence accidentally
 	parameters.setMM_DestDefaultValue(kDCA_AmpMod, 1.0);
@@ -423,7 +674,17 @@ SynthEngine::SynthEngine()
 
 		// --- pass safe pointer to voices to share the common matrix core
 		synthVoices[i]->setModMatrixPtrs(parameters.modSourceData, parameters.modDestinationData);
+
+		// --- and the shared free-running LFOs
+		synthVoices[i]->setSharedLFOBlocks(sharedLFO1Block, sharedLFO2Block);
 	}
+
+	// --- shared free-running LFOs use the voice LFO parameters, with no modulation
+	sharedLFO1.reset(new SynthLFO(midiInputData, parameters.voiceParameters->lfo1Parameters));
+	sharedLFO2.reset(new SynthLFO(midiInputData, parameters.voiceParameters->lfo2Parameters));
+
+	// --- from the startup master volume above
+	updateMasterVolume();
 }
 
 /**
@@ -443,10 +704,26 @@ bool SynthEngine::reset(double _sampleRate)
 	{
 		// --- smart poitner access looks normal (->) 
 		synthVoices[i]->reset(_sampleRate); // this calls reset() on the smart-pointers underlying naked pointer
+
+		// --- deterministic noise per voice
+		synthVoices[i]->setNoiseSeed(parameters.noiseSeed, i);
 	}
 
-	// --- create FX
-	// add more here
+	// --- shared LFOs restart; blocks are re-rendered on the next pass
+	sharedLFO1->reset(_sampleRate);
+	sharedLFO2->reset(_sampleRate);
+	sharedLFO1->setNoiseSeed(parameters.noiseSeed, 8 * MAX_VOICES);
+	sharedLFO2->setNoiseSeed(parameters.noiseSeed, 8 * MAX_VOICES + 1);
+	sharedLFO1Block->blockSize = 0;
+	sharedLFO1Block->readIndex = 0;
+	sharedLFO2Block->blockSize = 0;
+	sharedLFO2Block->readIndex = 0;
+
+	// --- per-voice chorus lines
+	voiceChorus.reset(_sampleRate);
+
+	// --- FX buffers are created here
+	masterFXChain.reset(_sampleRate);
 
 	return true;
 }
@@ -494,6 +771,19 @@ std::vector<std::string> SynthEngine::getBankNames(uint32_t voiceIndex, uint32_t
 }
 
 const SynthRenderData SynthEngine::renderAudioOutput()
+{
+	renderVoicesFrame();
+
+	// --- master FX, as a one-frame block
+	if (masterFXChain.isActive())
+		masterFXChain.processBlock(&synthOutputData.synthOutputs[LEFT_CHANNEL], &synthOutputData.synthOutputs[RIGHT_CHANNEL], 1);
+
+	// --- note that this is const, and therefore read-only
+	return synthOutputData;
+}
+
+// --- everything in renderAudioOutput( ) up to the master FX
+void SynthEngine::renderVoicesFrame()
 {
 	// --- clear accumumlators
 	synthOutputData.clear();
@@ -502,12 +792,28 @@ const SynthRenderData SynthEngine::renderAudioOutput()
 	SynthRenderData voiceRender;
 
 	// --- -12dB per active channel to avoid clipping
+	//     unison: the stack scales each copy by 1/sqrt(N), so the default four copies play at
+	//     0.25 x 0.5 = 0.125 each, the same -18dB per copy as the old four-voice unison
 	double gainFactor = 0.25; 
-	if (parameters.mode == synthMode::kUnison)
-		gainFactor = 0.125;
 
-	// --- loop through voices and render/accumulate them
+	// --- free-running LFOs: once for all voices
+	renderSharedLFOs();
+
+	// --- each voice's scaled frame; idle voices stay at 0.0
 	for (unsigned int i = 0; i < MAX_VOICES; i++)
+	{
+		voiceFrameLeft[i] = 0.0;
+		voiceFrameRight[i] = 0.0;
+	}
+
+	// --- multi-voice filter kernel renders all voices
+	bool multiVoiceFilter = parameters.enableMultiVoiceFilter;
+	if (multiVoiceFilter)
+		renderVoicesMultiVoiceFilter(gainFactor);
+	lastRenderWasMultiVoice = multiVoiceFilter;
+
+	// --- loop through voices and render them
+	for (unsigned int i = 0; i < MAX_VOICES && !multiVoiceFilter; i++)
 	{
 		// --- blend active voices
 		if (synthVoices[i]->isVoiceActive())
@@ -518,26 +824,267 @@ const SynthRenderData SynthEngine::renderAudioOutput()
 			// --- render the voice
 			voiceRender = synthVoices[i]->renderAudioOutput();
 
-			// --- accumulate results
-			synthOutputData.synthOutputs[LEFT_CHANNEL] += gainFactor * voiceRender.synthOutputs[0];
-			synthOutputData.synthOutputs[RIGHT_CHANNEL] += gainFactor * voiceRender.synthOutputs[1];
+			voiceFrameLeft[i] = gainFactor * voiceRender.synthOutputs[0];
+			voiceFrameRight[i] = gainFactor * voiceRender.synthOutputs[1];
 		}
 	}
 
+	// --- sum the voices, through their choruses if enabled
+	if (voiceChorus.isEnabled())
+		voiceChorus.processFrame(&voiceFrameLeft[0], &voiceFrameRight[0], synthOutputData.synthOutputs[LEFT_CHANNEL], synthOutputData.synthOutputs[RIGHT_CHANNEL]);
+	else
+	{
+		for (unsigned int i = 0; i < MAX_VOICES; i++)
+		{
+			synthOutputData.synthOutputs[LEFT_CHANNEL] += voiceFrameLeft[i];
+			synthOutputData.synthOutputs[RIGHT_CHANNEL] += voiceFrameRight[i];
+		}
+	}
+
+	// --- next shared LFO sample
+	if (sharedLFO1Block->enabled)
+		sharedLFO1Block->readIndex++;
+	if (sharedLFO2Block->enabled)
+		sharedLFO2Block->readIndex++;
+
 	// --- apply master volume
-	//     globalMIDIData[kMIDIMasterVolume] = 0 -> 16383
-	//	   mapping to -60dB(0.001) to +12dB(4.0)
-	double masterVol = midi14_bitToDouble(midiInputData->globalMIDIData[kMIDIMasterVolumeLSB], midiInputData->globalMIDIData[kMIDIMasterVolumeMSB], 0.001, 4.0);
-			
-	// --- apply master volume
-	synthOutputData.synthOutputs[LEFT_CHANNEL] *= masterVol;
-	synthOutputData.synthOutputs[RIGHT_CHANNEL] *= masterVol;
+	synthOutputData.synthOutputs[LEFT_CHANNEL] *= masterVolumeGain;
+	synthOutputData.synthOutputs[RIGHT_CHANNEL] *= masterVolumeGain;
+}
 
-	// --- note that this is const, and therefore read-only
-	return synthOutputData;
+/**
+\brief Renders a block of frames: each active voice renders its frames and its DCA accumulates them straight
+into the output bus, then the master volume and the master FX chain are applied once over the block.
+With the per-voice chorus enabled, the voices render into their own buses and the chorus sums them.
+
+With the shared free-running LFOs, the sub-blocks end where the shared LFO blocks do: each voice reads its
+frames of the current shared block and the engine advances the read index once per sub-block.
+
+The multi-voice filter needs every voice on the same frame, so its voices are rendered frame by frame;
+the master FX still run once over the block.
+
+NOTE: there must be no MIDI events inside the block; split the block at the events
+
+\param outputLeft left channel bus, blockSize frames; overwritten
+\param outputRight right channel bus, blockSize frames; overwritten
+\param blockSize number of frames
+*/
+void SynthEngine::renderAudioBlock(double* outputLeft, double* outputRight, uint32_t blockSize)
+{
+	// --- lockstep mode
+	if (parameters.enableMultiVoiceFilter)
+	{
+		for (uint32_t n = 0; n < blockSize; n++)
+		{
+			renderVoicesFrame();
+			outputLeft[n] = synthOutputData.synthOutputs[LEFT_CHANNEL];
+			outputRight[n] = synthOutputData.synthOutputs[RIGHT_CHANNEL];
+		}
+
+		masterFXChain.processBlock(outputLeft, outputRight, blockSize);
+		return;
+	}
+
+	memset(outputLeft, 0, blockSize * sizeof(double));
+	memset(outputRight, 0, blockSize * sizeof(double));
+
+	// --- -12dB per active channel to avoid clipping; same as renderAudioOutput( )
+	double gainFactor = 0.25;
+
+	lastRenderWasMultiVoice = false;
+
+	// --- voices accumulate into the bus, MAX_RENDER_BLOCK_SIZE frames at a time
+	bool chorus = voiceChorus.isEnabled();
+	double* laneLeft[MAX_VOICES] = { 0 };
+	double* laneRight[MAX_VOICES] = { 0 };
+	for (unsigned int i = 0; i < MAX_VOICES; i++)
+	{
+		laneLeft[i] = &voiceBusLeft[i][0];
+		laneRight[i] = &voiceBusRight[i][0];
+	}
+
+	uint32_t frames = 0;
+	for (uint32_t offset = 0; offset < blockSize; offset += frames)
+	{
+		frames = blockSize - offset < MAX_RENDER_BLOCK_SIZE ? blockSize - offset : MAX_RENDER_BLOCK_SIZE;
+
+		// --- free-running LFOs: the next shared block if needed; stop the sub-block at its end
+		renderSharedLFOs();
+		if (sharedLFO1Block->enabled && sharedLFO1Block->blockSize - sharedLFO1Block->readIndex < frames)
+			frames = sharedLFO1Block->blockSize - sharedLFO1Block->readIndex;
+		if (sharedLFO2Block->enabled && sharedLFO2Block->blockSize - sharedLFO2Block->readIndex < frames)
+			frames = sharedLFO2Block->blockSize - sharedLFO2Block->readIndex;
+
+		for (unsigned int i = 0; i < MAX_VOICES; i++)
+		{
+			// --- with the chorus, every voice has its own bus (idle voices stay silent)
+			if (chorus)
+			{
+				memset(laneLeft[i], 0, frames * sizeof(double));
+				memset(laneRight[i], 0, frames * sizeof(double));
+				if (synthVoices[i]->isVoiceActive())
+					synthVoices[i]->renderAudioBlock(laneLeft[i], laneRight[i], frames, gainFactor);
+			}
+			else if (synthVoices[i]->isVoiceActive())
+				synthVoices[i]->renderAudioBlock(&outputLeft[offset], &outputRight[offset], frames, gainFactor);
+		}
+
+		// --- all voices' choruses in one pass, summed into the bus
+		if (chorus)
+			voiceChorus.processBlock(laneLeft, laneRight, &outputLeft[offset], &outputRight[offset], frames);
+
+		// --- past this sub-block's shared LFO samples
+		if (sharedLFO1Block->enabled)
+			sharedLFO1Block->readIndex += frames;
+		if (sharedLFO2Block->enabled)
+			sharedLFO2Block->readIndex += frames;
+	}
+
+	// --- master stage, once per block
+	for (uint32_t n = 0; n < blockSize; n++)
+	{
+		outputLeft[n] *= masterVolumeGain;
+		outputRight[n] *= masterVolumeGain;
+	}
+
+	// --- master FX over the whole block
+	masterFXChain.processBlock(outputLeft, outputRight, blockSize);
+}
+
+/**
+\brief Decodes the master volume from the global MIDI data;
+globalMIDIData[kMIDIMasterVolume] = 0 -> 16383 maps to -60dB(0.001) to +12dB(4.0)
+*/
+void SynthEngine::updateMasterVolume()
+{
+	masterVolumeGain = midi14_bitToDouble(midiInputData->globalMIDIData[kMIDIMasterVolumeLSB], midiInputData->globalMIDIData[kMIDIMasterVolumeMSB], 0.001, 4.0);
+}
+
+
+
+/**
+\brief Renders the engine-level free-running LFOs one block at a time; the voices read the block
+in place of their own LFO when the LFO is in kFreeRun mode (see SynthVoice::renderLFOOutput)
+*/
+void SynthEngine::renderSharedLFOs()
+{
+	sharedLFO1Block->enabled = parameters.enableSharedFreeRunLFO && sharedLFO1->isFreeRunning();
+	sharedLFO2Block->enabled = parameters.enableSharedFreeRunLFO && sharedLFO2->isFreeRunning();
+
+	if (sharedLFO1Block->enabled && sharedLFO1Block->readIndex >= sharedLFO1Block->blockSize)
+	{
+		sharedLFO1->update(true);
+		sharedLFO1->renderModulatorBlock(*sharedLFO1Block, sharedLFOBlockSize);
+	}
+
+	if (sharedLFO2Block->enabled && sharedLFO2Block->readIndex >= sharedLFO2Block->blockSize)
+	{
+		sharedLFO2->update(true);
+		sharedLFO2->renderModulatorBlock(*sharedLFO2Block, sharedLFOBlockSize);
+	}
 }
 
+/**
+\brief Renders the active voices with all of their filter ladders running in lockstep
+in the MultiVoiceLadder kernels: the first ladder of every voice in one pass, then the second.
+The voices keep their cutoff ramps and limiters; serial configs feed the limited first ladder into the
+second, twin configs feed both from the oscillators.
+
+\param gainFactor per-voice gain into voiceFrameLeft/voiceFrameRight
+*/
+void SynthEngine::renderVoicesMultiVoiceFilter(double gainFactor)
+{
+	// --- ladder states belong to the kernels in this mode; start clean when switching over
+	if (!lastRenderWasMultiVoice)
+	{
+		multiVoiceLadder[0].reset();
+		multiVoiceLadder[1].reset();
+	}
+
+	double voiceInput[LADDER_LANES] = { 0.0 };
+	double ladderInput[LADDER_LANES] = { 0.0 };
+	double ladderOutput[LADDER_LANES] = { 0.0 };
+	double limiterOutput[LADDER_LANES] = { 0.0 };
+	double rightOutput[LADDER_LANES] = { 0.0 };
+	bool voiceActive[LADDER_LANES] = { false };
+	bool voiceStereo[LADDER_LANES] = { false };
+	twinFilterConfig config[LADDER_LANES];
+	LadderLaneCoeffs coeffs[2];
+
+	// --- render up to the filters and load the lanes
+	for (unsigned int i = 0; i < MAX_VOICES; i++)
+	{
+		config[i] = twinFilterConfig::kBypass;
+		voiceActive[i] = synthVoices[i]->isVoiceActive();
+		voiceStereo[i] = false;
+		if (voiceActive[i])
+		{
+			voiceInput[i] = synthVoices[i]->renderPreFilter();
+			voiceStereo[i] = synthVoices[i]->isStereo();
+
+			// --- saturating ladders and stereo voices run in the voice; their lanes are bypassed
+			if (synthVoices[i]->filterIsNonLinear() || voiceStereo[i])
+			{
+				voiceInput[i] = synthVoices[i]->processFilter(voiceInput[i]);
+				if (voiceStereo[i])
+					rightOutput[i] = synthVoices[i]->processFilterRight();
+			}
+			else
+				config[i] = synthVoices[i]->getFilterLaneCoeffs(coeffs[0], coeffs[1]);
+		}
+
+		if (config[i] == twinFilterConfig::kBypass)
+		{
+			multiVoiceLadder[0].setLaneBypass(i);
+			multiVoiceLadder[1].setLaneBypass(i);
+		}
+		else
+		{
+			multiVoiceLadder[0].setLaneCoeffs(i, coeffs[0]);
+			multiVoiceLadder[1].setLaneCoeffs(i, coeffs[1]);
+		}
+		ladderInput[i] = voiceInput[i];
+	}
+
+	// --- first ladder, all voices
+	multiVoiceLadder[0].processAudioSamples(&ladderInput[0], &ladderOutput[0]);
+
+	for (unsigned int i = 0; i < MAX_VOICES; i++)
+	{
+		if (config[i] == twinFilterConfig::kBypass)
+			continue;
+
+		limiterOutput[i] = synthVoices[i]->processFilterLimiter(0, ladderOutput[i]);
+
+		// --- HP -> LP configs are serial
+		if (config[i] == twinFilterConfig::kHP_LP2 || config[i] == twinFilterConfig::kHP_LP4)
+			ladderInput[i] = limiterOutput[i];
+	}
+
+	// --- second ladder, all voices
+	multiVoiceLadder[1].processAudioSamples(&ladderInput[0], &ladderOutput[0]);
+
+	// --- finish and accumulate
+	SynthRenderData voiceRender;
+	for (unsigned int i = 0; i < MAX_VOICES; i++)
+	{
+		if (!voiceActive[i])
+			continue;
+
+		double filterOutput = voiceInput[i];
+		if (config[i] == twinFilterConfig::kHP_LP2 || config[i] == twinFilterConfig::kHP_LP4)
+			filterOutput = synthVoices[i]->processFilterLimiter(1, ladderOutput[i]);
+		else if (config[i] != twinFilterConfig::kBypass)
+			filterOutput = limiterOutput[i] + synthVoices[i]->processFilterLimiter(1, ladderOutput[i]);
+
+		voiceRender.clear();
+		voiceRender = synthVoices[i]->renderPostFilter(filterOutput, voiceStereo[i] ? rightOutput[i] : filterOutput);
 
+		// --- the voice's frame; renderAudioOutput( ) sums them
+		voiceFrameLeft[i] = gainFactor * voiceRender.synthOutputs[0];
+		voiceFrameRight[i] = gainFactor * voiceRender.synthOutputs[1];
+	}
+}
 
 /**
 \brief The MIDI event handler function; for note on/off messages it finds the voices to turn on/off.
@@ -598,11 +1145,9 @@ bool SynthEngine::processMIDIEvent(midiEvent& event)
 		{
 			// --- UNISON mode is heavily dependent on the manufacturer's 
 			//     implementation and decision
-			//     for the synth core, we will use 3 voices detuned as: -parameters.unisonDetune_Cents, 0, +parameters.unisonDetune_Cents
+			//     for the synth core, one voice plays the note and its unison stack supplies the
+			//     detuned copies (see UnisonParameters), so the EGs and LFOs run once
 			synthVoices[0]->processMIDIEvent(event);
-			synthVoices[1]->processMIDIEvent(event);
-			synthVoices[2]->processMIDIEvent(event);
-			synthVoices[3]->processMIDIEvent(event);
 		}
 
 		// --- need to store these for things like portamento
@@ -648,11 +1193,9 @@ bool SynthEngine::processMIDIEvent(midiEvent& event)
 		}
 		else if (parameters.mode == synthMode::kUnison)
 		{
-			// --- this will get complicated with voice stealing.
-			synthVoices[0]->processMIDIEvent(event);
-			synthVoices[1]->processMIDIEvent(event);
-			synthVoices[2]->processMIDIEvent(event);
-			synthVoices[3]->processMIDIEvent(event);
+			// --- one voice, as in note-on
+			if (synthVoices[0]->isVoiceActive())
+				synthVoices[0]->processMIDIEvent(event);
 
 			return true;
 		}
@@ -714,6 +1257,17 @@ void SynthEngine::setParameters(const SynthEngineParameters& _parameters)
 
 	// --- map 0 -> 16383 to MIDI 14-bit
 	unipolarIntToMIDI14_bit(unipolarValue, midiInputData->globalMIDIData[kMIDIMasterVolumeLSB], midiInputData->globalMIDIData[kMIDIMasterVolumeMSB]);
+	updateMasterVolume();
+
+	// --- wavetable storage; switching only changes which copy the next table selection reads
+	waveTableData->setFloatStorage(parameters.enableFloatWaveTables);
+	waveTableData->setInterpolation(parameters.waveTableInterpolation);
+
+	// --- per-voice chorus
+	voiceChorus.setParameters(parameters.voiceChorusParameters);
+
+	// --- master FX chain layout and settings
+	masterFXChain.setParameters(parameters.masterFXParameters);
 
 	// --- store pitch bend range in midi data table; for a released synth, you want to decode this as SYSEX as well
 	// --- sensitivity is in semitones (0 -> 127) and cents (0 -> 127)
@@ -745,42 +1299,20 @@ void SynthEngine::setParameters(const SynthEngineParameters& _parameters)
 	// --- map -8192 -> 8191 to MIDI 14-bit
 	bipolarIntToMIDI14_bit(mtFine, -8192, 8191, midiInputData->globalMIDIData[kMIDIMasterTuneFineLSB], midiInputData->globalMIDIData[kMIDIMasterTuneFineMSB]);
 
-	// --- now trickle down the voice parameters
-	for (unsigned int i = 0; i < MAX_VOICES; i++)
+	// --- unison mode stacks masterUnisonVoiceCount detuned copies in the voice; the other modes
+	//     play a single copy with no stack detune. The per-copy detune and pan are computed in
+	//     the oscillators, so nothing is written per voice here
+	if (parameters.mode == synthMode::kUnison)
 	{
-		if (synthVoices[i]->isVoiceActive())
-		{
-			// -- note the special handling for unison mode - you could probably
-			//    clean this up
-			if (parameters.mode == synthMode::kUnison)
-			{	
-				if (i == 0)
-				{
-					parameters.voiceParameters->voiceUnisonDetune_Cents = 0.0;
-					parameters.voiceParameters->dcaParameters->panValue = 0.5;
-				}
-				else if (i == 1)
-				{
-					parameters.voiceParameters->voiceUnisonDetune_Cents = parameters.masterUnisonDetune_Cents;
-					parameters.voiceParameters->dcaParameters->panValue = -1.0;
-				}
-				else if (i == 2)
-				{
-					parameters.voiceParameters->voiceUnisonDetune_Cents = -parameters.masterUnisonDetune_Cents;
-					parameters.voiceParameters->dcaParameters->panValue = 1.0;
-				}
-				else if (i == 3)
-				{
-					parameters.voiceParameters->voiceUnisonDetune_Cents = 0.707*parameters.masterUnisonDetune_Cents;
-					parameters.voiceParameters->dcaParameters->panValue = -0.5;
-				}
-			}
-			else
-			{
-				parameters.voiceParameters->voiceUnisonDetune_Cents = 0.0;
-				parameters.voiceParameters->dcaParameters->panValue = 0.0;
-			}
-		}
+		parameters.voiceParameters->unisonParameters->voiceCount = parameters.masterUnisonVoiceCount;
+		parameters.voiceParameters->unisonParameters->detune_Cents = parameters.masterUnisonDetune_Cents;
+		parameters.voiceParameters->unisonParameters->stereoSpread = parameters.masterUnisonStereoSpread;
+	}
+	else
+	{
+		parameters.voiceParameters->unisonParameters->voiceCount = 1;
+		parameters.voiceParameters->unisonParameters->detune_Cents = 0.0;
+		parameters.voiceParameters->unisonParameters->stereoSpread = 0.0;
 	}
 }
 
@@ -10,9 +10,17 @@
 #include "vafilters.h"
 #include "synthlfo.h"
 #include "dca_eg.h"
+#include "oversampler.h"
+#include "noisegenerator.h"
+#include "fmalgorithm.h"
+#include "masterfxchain.h"
+#include "voicechorus.h"
 
 #include <array>
 
+// --- max frames per voice render in the block path; longer blocks are split
+const uint32_t MAX_RENDER_BLOCK_SIZE = 128;
+
 /**
 \enum modSource
 \ingroup SynthStructures
@@ -66,6 +74,15 @@ enum modDestination
 	kDCA_AmpMod,// Amp Mod Input
 	kDCA_SampleHoldMod, //bipolar clamping mod input
 
+	// --- oscillator wave morph position
+	kOsc1_WaveMorph,
+	kOsc2_WaveMorph,
+	kOsc3_WaveMorph,
+	kOsc4_WaveMorph,
+
+	// --- second twin filter Fc
+	kFilter2_fc,
+
 	// --- remain last, will always be the size of modulator array
 	kNumModDestinations
 };
@@ -83,7 +100,11 @@ owning voice must be privately owned. For example see voiceIsRunning
 */
 struct SynthVoiceParameters
 {
-	SynthVoiceParameters() {}
+	SynthVoiceParameters() 
+	{
+		// --- filter is off until the patch turns it on; its default fc would otherwise silence the voice
+		filter1Parameters->filterConfiguration = twinFilterConfig::kBypass;
+	}
 
 	SynthVoiceParameters& operator=(const SynthVoiceParameters& params)
 	{
@@ -94,13 +115,17 @@ struct SynthVoiceParameters
 		portamentoTime_mSec = params.portamentoTime_mSec;
 		legatoMode = params.legatoMode;
 		freeRunOscMode = params.freeRunOscMode;
-		voiceUnisonDetune_Cents = params.voiceUnisonDetune_Cents;
+		oversamplingRatio = params.oversamplingRatio;
 
 		osc1Parameters = params.osc1Parameters;
 		osc2Parameters = params.osc2Parameters;
 		osc3Parameters = params.osc3Parameters;
 		osc4Parameters = params.osc4Parameters;
 		dcaParameters = params.dcaParameters;
+		filter1Parameters = params.filter1Parameters;
+		noiseOscParameters = params.noiseOscParameters;
+		fmParameters = params.fmParameters;
+		unisonParameters = params.unisonParameters;
 
 		lfo1Parameters = params.lfo1Parameters;
 		ampEGParameters = params.ampEGParameters;
@@ -122,8 +147,8 @@ struct SynthVoiceParameters
 	// --- freerun
 	bool freeRunOscMode = false;
 
-	// --- unison Detune - each voice will be detuned differently
-	double voiceUnisonDetune_Cents = 0.0;
+	// --- oscillators (and future non-linear stages) render at this multiple of fs: 1, 2 or 4
+	uint32_t oversamplingRatio = 1;
 
 	// --- GUI CONTROL INTERFACE -------------------------------- //
 	// --- pitched oscillators
@@ -132,6 +157,15 @@ struct SynthVoiceParameters
 	std::shared_ptr<SynthOscParameters> osc3Parameters = std::make_shared<SynthOscParameters>();
 	std::shared_ptr<SynthOscParameters> osc4Parameters = std::make_shared<SynthOscParameters>();
 
+	// --- noise source, added to the oscillator blend
+	std::shared_ptr<NoiseOscParameters> noiseOscParameters = std::make_shared<NoiseOscParameters>();
+
+	// --- audio-rate PM between the oscillators; replaces the vector mix when on
+	std::shared_ptr<FMAlgorithmParameters> fmParameters = std::make_shared<FMAlgorithmParameters>();
+
+	// --- detuned copies of every oscillator, rendered inside the voice
+	std::shared_ptr<UnisonParameters> unisonParameters = std::make_shared<UnisonParameters>();
+
 	// --- LFO oscillators
 	std::shared_ptr<SynthLFOParameters> lfo1Parameters = std::make_shared<SynthLFOParameters>();
 	std::shared_ptr<SynthLFOParameters> lfo2Parameters = std::make_shared<SynthLFOParameters>();
@@ -142,6 +176,9 @@ struct SynthVoiceParameters
 	// --- DCA
 	std::shared_ptr<DCAParameters> dcaParameters = std::make_shared<DCAParameters>();
 
+	// --- filters
+	std::shared_ptr<TwinMoogFilterParameters> filter1Parameters = std::make_shared<TwinMoogFilterParameters>();
+
 	//vector synthesis
 	VectorJoystickData vectorJSData;
 };
@@ -280,6 +317,34 @@ public:
 
 	bool voiceIsStealing() { return stealPending; }
 
+	// --- give every random source in this voice its own stream of the engine seed
+	void setNoiseSeed(uint64_t seed, uint32_t voiceIndex);
+
+	// --- engine-level free-running LFOs; used in place of our own when enabled and the LFO is in kFreeRun mode
+	void setSharedLFOBlocks(std::shared_ptr<LFOBlockData> _sharedLFO1Block, std::shared_ptr<LFOBlockData> _sharedLFO2Block)
+	{
+		sharedLFO1Block = _sharedLFO1Block;
+		sharedLFO2Block = _sharedLFO2Block;
+	}
+
+	// --- split render for the engine's multi-voice filter kernel:
+	//     renderPreFilter( ) -> getFilterLaneCoeffs( ) -> [engine ladders + processFilterLimiter( )] -> renderPostFilter( )
+	//     renderAudioOutput( ) is the same chain with the voice's own filter
+	//     NOTE: a stereo voice (spread unison) returns the left channel from renderPreFilter( );
+	//           the right channel only runs through the voice's own filters, see processFilterRight( )
+	double renderPreFilter();
+	twinFilterConfig getFilterLaneCoeffs(LadderLaneCoeffs& coeffs1, LadderLaneCoeffs& coeffs2);
+	double processFilterLimiter(uint32_t filterIndex, double xn) { return filter1->processLimiter(filterIndex, xn); }
+	bool filterIsNonLinear() { return filter1->isNonLinear(); }
+	bool isStereo() { return stereoOutput; }
+	double processFilter(double xn) { return filter1->processAudioSample(xn); }
+	double processFilterRight() { return filter1Right->processAudioSample(preFilterRight); }
+	const SynthRenderData renderPostFilter(double filterOutputLeft, double filterOutputRight);
+
+	// --- block render: renders up to MAX_RENDER_BLOCK_SIZE frames and accumulates them, scaled by busGain,
+	//     into the stereo bus through the DCA's block path; stops early if the voice shuts off
+	void renderAudioBlock(double* busLeft, double* busRight, uint32_t blockSize, double busGain);
+
 protected:
 	// --- parameters
 	std::shared_ptr<SynthVoiceParameters> parameters = nullptr;
@@ -318,8 +383,20 @@ protected:
 		//LFO 2
 		modSourceData[kLFO2_Normal] = &lfo2Output.modulationOutputs[kLFONormalOutput];
 
+		// --- oscillators
+		modSourceData[kOsc1_Normal] = &osc1Output.outputs[0];
+		modSourceData[kOsc2_Normal] = &osc2Output.outputs[0];
+		modSourceData[kOsc3_Normal] = &osc3Output.outputs[0];
+		modSourceData[kOsc4_Normal] = &osc4Output.outputs[0];
+
 		// --- destinations
 		modDestinationData[kOsc1_fo] = &(osc1->getModulators()->modulationInputs[kBipolarMod]);
+		modDestinationData[kOsc1_WaveMorph] = &(osc1->getModulators()->modulationInputs[kWaveMorphMod]);
+		modDestinationData[kOsc2_WaveMorph] = &(osc2->getModulators()->modulationInputs[kWaveMorphMod]);
+		modDestinationData[kOsc3_WaveMorph] = &(osc3->getModulators()->modulationInputs[kWaveMorphMod]);
+		modDestinationData[kOsc4_WaveMorph] = &(osc4->getModulators()->modulationInputs[kWaveMorphMod]);
+		modDestinationData[kFilter1_fc] = &(filter1->getModulators()->modulationInputs[kBipolarMod]);
+		modDestinationData[kFilter2_fc] = &(filter1->getModulators()->modulationInputs[kAuxBipolarMod_1]);
 		modDestinationData[kDCA_EGMod] = &(dca->getModulators()->modulationInputs[kEGMod]);
 		modDestinationData[kDCA_AmpMod] = &(dca->getModulators()->modulationInputs[kMaxDownAmpMod]);
 
@@ -359,19 +436,68 @@ protected:
 	bool stealPending = false;
 	midiEvent voiceStealMIDIEvent;
 
+	// --- shared tables; needed here to set up the morphing banks
+	std::shared_ptr<WaveTableData> waveTableData = nullptr;
+
 	// --- smart pointers to the oscillator objects
 	std::unique_ptr<SynthOsc> osc1;
 	std::unique_ptr<SynthOsc> osc2;
 	std::unique_ptr<SynthOsc> osc3;
 	std::unique_ptr<SynthOsc> osc4;
 
+	// --- noise source
+	std::unique_ptr<NoiseOscillator> noiseOsc;
+
+	// --- filter outputs for the block path, ahead of the DCA
+	double voiceBlockLeft[MAX_RENDER_BLOCK_SIZE] = { 0.0 };
+	double voiceBlockRight[MAX_RENDER_BLOCK_SIZE] = { 0.0 };
+
+	// --- note-off and steal handling once the amp EG has finished
+	void updateVoiceState();
+
+	// --- FM/PM operator routing between osc1..osc4
+	FMOperatorMatrix fmMatrix;
+
 	// --- filters:
-	// add here....
+	std::unique_ptr<TwinMoogFilters> filter1;
+
+	// --- right channel copy of filter1, only run while the unison stack is spread (stereo)
+	std::unique_ptr<TwinMoogFilters> filter1Right;
+	bool stereoOutput = false;
+	double preFilterRight = 0.0;
+
+	// --- oversampled render path for the oscillators
+	Oversampler oversampler;
+	Oversampler oversamplerRight;
+	uint32_t currentOversamplingRatio = 1;
+	double oversampledBuffer[MAX_OVERSAMPLING_RATIO] = { 0.0 };
+	double oversampledBufferRight[MAX_OVERSAMPLING_RATIO] = { 0.0 };
+	double sampleRate = 44100.0;
+
+	// --- switch the oscillators and the decimator to a new ratio
+	void updateOversampling();
+
+	// --- render and blend the oscillators for one sample at the current (oversampled) rate;
+	//     returns the left (or mono) blend, right is only rendered separately in stereo
+	double renderOscillatorBlend(double& right);
 
 	// --- LFOs
 	std::unique_ptr<SynthLFO> lfo1;
 	std::unique_ptr<SynthLFO> lfo2;
 
+	// --- LFO blocks, rendered once per component update
+	LFOBlockData lfo1Block;
+	LFOBlockData lfo2Block;
+	std::shared_ptr<LFOBlockData> sharedLFO1Block = nullptr;
+	std::shared_ptr<LFOBlockData> sharedLFO2Block = nullptr;
+	uint32_t sharedLFOFrame = 0;	///< frame offset into the shared blocks during renderAudioBlock( )
+
+	// --- tell the LFOs which of their outputs the mod matrix is using
+	void updateLFORouting();
+
+	// --- one sample of LFO output from our block or the engine's shared block
+	void renderLFOOutput(SynthLFO* lfo, LFOBlockData& block, LFOBlockData* sharedBlock, ModOutputData& output, bool updateAllModRoutings);
+
 	// --- EGs
 	std::unique_ptr<EnvelopeGenerator> ampEG;
 
@@ -409,6 +535,12 @@ protected:
 
 		return update;
 	}
+
+	// --- true if the next needsComponentUpdate( ) call will return true
+	bool willUpdateComponents()
+	{
+		return granularityCounter < 0 || granularityCounter + 1 == (int)updateGranularity;
+	}
 };
 
 // --- engine mode: poly, mono or unison
@@ -440,6 +572,15 @@ struct SynthEngineParameters
 		masterTuningFine = params.masterTuningFine;
 
 		masterUnisonDetune_Cents = params.masterUnisonDetune_Cents;
+		masterUnisonVoiceCount = params.masterUnisonVoiceCount;
+		masterUnisonStereoSpread = params.masterUnisonStereoSpread;
+		enableMultiVoiceFilter = params.enableMultiVoiceFilter;
+		enableSharedFreeRunLFO = params.enableSharedFreeRunLFO;
+		enableFloatWaveTables = params.enableFloatWaveTables;
+		waveTableInterpolation = params.waveTableInterpolation;
+		noiseSeed = params.noiseSeed;
+		voiceChorusParameters = params.voiceChorusParameters;
+		masterFXParameters = params.masterFXParameters;
 	
 		// --- important! 
 		voiceParameters = params.voiceParameters;
@@ -468,8 +609,34 @@ struct SynthEngineParameters
 	int masterTuningFine = 0;		// --- (+/-) cents see MIDI spec
 
 	// --- unison Detune - this is the max detuning value NOTE a standard (or RPN or NRPN) parameter :/
+	//     it sets the detune of the voices' unison stacks (UnisonParameters::detune_Cents)
 	double masterUnisonDetune_Cents = 0.0;
 
+	// --- unison mode only: detuned copies per note and their pan width [0, 1]; poly and mono play one copy
+	uint32_t masterUnisonVoiceCount = 4;
+	double masterUnisonStereoSpread = 1.0;
+
+	// --- run all voices' filter ladders in lockstep in the engine (see MultiVoiceLadder)
+	bool enableMultiVoiceFilter = false;
+
+	// --- free-running LFOs are computed once in the engine and shared by all voices
+	bool enableSharedFreeRunLFO = false;
+
+	// --- oscillators read the float32 copies of the wavetables (made at bank load) instead of the 64-bit tables
+	bool enableFloatWaveTables = false;
+
+	// --- wavetable read interpolation for every bank: linear, hermite, lagrange4 or windowedSinc (see wtInterpolation)
+	uint32_t waveTableInterpolation = wtInterpolation::linear;
+
+	// --- seed for every noise/S&H source; the same seed renders the same noise after a reset
+	uint32_t noiseSeed = 0;
+
+	// --- per-voice chorus, ahead of the voice summing
+	VoiceChorusParameters voiceChorusParameters;
+
+	// --- post-engine FX chain
+	MasterFXParameters masterFXParameters;
+
 	// --- VOICE layer parameters
 	std::shared_ptr<SynthVoiceParameters> voiceParameters = std::make_shared<SynthVoiceParameters>();
 
@@ -557,6 +724,9 @@ public:
 	virtual bool processMIDIEvent(midiEvent& event);
 	virtual bool initialize(PluginInfo pluginInfo);
 
+	// --- render a block of frames with no MIDI events inside it; see renderAudioOutput( ) for single frames
+	void renderAudioBlock(double* outputLeft, double* outputRight, uint32_t blockSize);
+
 	// --- get parameters
 	SynthEngineParameters getParameters();
 
@@ -578,6 +748,15 @@ public:
 	// --- get the bank names
 	std::vector<std::string> getBankNames(uint32_t voiceIndex, uint32_t oscillatorIndex);
 
+	// --- CPU timing of a master FX slot (see MasterFXParameters::enableCPUTiming)
+	MasterFXSlotTiming getMasterFXSlotTiming(uint32_t slot) { return masterFXChain.getSlotTiming(slot); }
+
+	// --- delay of the master FX chain in samples (see MasterFXChain::getLatency( )); report it to the host
+	uint32_t getLatency() { return masterFXChain.getLatency(); }
+
+	// --- impulse response for the master FX convolver, one path of its routing matrix; call off the audio thread
+	void setMasterFXImpulseResponse(uint32_t input, uint32_t output, const double* ir, uint32_t length) { masterFXChain.setConvolverImpulseResponse(input, output, ir, length); }
+
 protected:
 	// --- our outputs, same number as synth voice!
 	SynthRenderData synthOutputData;
@@ -595,8 +774,36 @@ protected:
 	// --- shared tables, in case they are huge or need a long creation time
 	std::shared_ptr<WaveTableData> waveTableData = std::make_shared<WaveTableData>();
 
+	// --- shared free-running LFOs and their blocks (see SynthEngineParameters::enableSharedFreeRunLFO)
+	std::unique_ptr<SynthLFO> sharedLFO1;
+	std::unique_ptr<SynthLFO> sharedLFO2;
+	std::shared_ptr<LFOBlockData> sharedLFO1Block = std::make_shared<LFOBlockData>();
+	std::shared_ptr<LFOBlockData> sharedLFO2Block = std::make_shared<LFOBlockData>();
+	void renderSharedLFOs();
+	const uint32_t sharedLFOBlockSize = 64;		///< same as the voice update granularity
+
+	// --- master volume gain; recomputed when the master volume changes, not per sample
+	double masterVolumeGain = 1.0;
+	void updateMasterVolume();
+
+	// --- one frame of the voices at the master volume into synthOutputData, without the master FX
+	void renderVoicesFrame();
+
+	// --- multi-voice filter kernels: [0] = first ladder of each voice, [1] = second
+	MultiVoiceLadder multiVoiceLadder[2];
+	bool lastRenderWasMultiVoice = false;
+	void renderVoicesMultiVoiceFilter(double gainFactor);
+
+	// --- per-voice chorus: the voices render into their own lanes and the chorus sums them
+	MultiVoiceChorus voiceChorus;
+	double voiceFrameLeft[MAX_VOICES] = { 0.0 };	///< one frame of every voice, 0.0 for idle voices
+	double voiceFrameRight[MAX_VOICES] = { 0.0 };
+	double voiceBusLeft[MAX_VOICES][MAX_RENDER_BLOCK_SIZE] = { { 0.0 } };	///< block render, one bus per voice
+	double voiceBusRight[MAX_VOICES][MAX_RENDER_BLOCK_SIZE] = { { 0.0 } };
+
 private:
-	// --- ADD FX Here...
+	// --- post-engine FX, on the master bus after the master volume
+	MasterFXChain masterFXChain;
 
 };
 
@@ -1080,6 +1080,11 @@ struct SynthOscParameters
 		enableHardSync = params.enableHardSync;
 		enableFreeRunMode = params.enableFreeRunMode;
 
+		enableWaveMorph = params.enableWaveMorph;
+		morphBankIndex = params.morphBankIndex;
+		waveMorphPosition = params.waveMorphPosition;
+		enableFixedPointPhase = params.enableFixedPointPhase;
+
 		return *this;
 	}
 
@@ -1106,6 +1111,14 @@ struct SynthOscParameters
 	double fmRatio = 1.0;				// [1, +???]
 	bool enableHardSync = false;		// [1, +???]
 	bool enableFreeRunMode = false;		// [1, +???]
+
+	// --- wave morphing: frames are the tables of the morphing bank
+	bool enableWaveMorph = false;
+	int32_t morphBankIndex = 0;
+	double waveMorphPosition = 0.0;		// [0, 1] start -> end frame; kWaveMorphMod adds to this
+
+	// --- 32-bit fixed-point phase accumulator instead of the double read index
+	bool enableFixedPointPhase = false;
 };
 
 /**
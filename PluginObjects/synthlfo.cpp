@@ -24,21 +24,11 @@ bool SynthLFO::update(bool updateAllModRoutings)
 		return true;
 
 
-	//line for final LFO freq (GUI + modulated)
+	// --- delay and ramp lengths; the ramp itself is advanced per sample (renderSample)
+	lfodelay.setTargetValueInSamples(msecToSamples(sampleRate, parameters->delay));
 
-	double d = msecToSamples(sampleRate, parameters->ramp); //establishing the timer
-	rampTime.setTargetValueInSamples(d);
-
-		//implementing the lfo output ramp
-	if (parameters->ramp > 0.0) {
-
-		if (!(rampTime.timerExpired())) {
-			//need to figure out how to make outputAmplitude start at 0
-				parameters->outputAmplitude = parameters->outputAmplitude + (1 / d);
-				rampTime.advanceTimer();
-
-		}
-	};
+	double rampSamples = msecToSamples(sampleRate, parameters->ramp);
+	rampInc = rampSamples >= 1.0 ? 1.0 / rampSamples : 1.0;
 
 	double leftSlope = (parameters->waveShapeY) / (parameters->waveShapeX);
 	double rightSlope = (1 - parameters->waveShapeY) / (1 - parameters->waveShapeX);
@@ -66,54 +56,56 @@ const ModOutputData SynthLFO::renderModulatorOutput()
 	ModOutputData lfoOutputData; // should auto-zero on instantiation
 	lfoOutputData.clear();
 
-	if (renderComplete)
-	{
+	double normal = 0.0;
+	double quadPhase = 0.0;
+	double amplitude = 0.0;
+	if (!renderSample(normal, quadPhase, amplitude, true))
 		return lfoOutputData;
-	}
-	
 
-	//This is the implementation of the lfo delay
-	double dd = msecToSamples(sampleRate, parameters->delay);
-	lfodelay.setTargetValueInSamples(dd);
-	if(!(lfodelay.timerExpired()))
-	{
-		lfodelay.advanceTimer();
-		if (parameters->mode == LFOMode::kOneShot || parameters->mode == LFOMode::kSync)
-		{
-			return lfoOutputData;
-		}
+	// --- this path always makes all outputs
+	writeOutputs(lfoOutputData, normal, quadPhase, amplitude, true);
 
-		if (parameters->mode == LFOMode::kFreeRun)
-		{
-			return lfoOutputData;
-		}
-	}
+	return lfoOutputData;
+}
 
-	////implementing the lfo output ramp
-	//else if (parameters->ramp > 0.0) {
-	//	double d = msecToSamples(sampleRate, parameters->ramp); //establishing the timer
-	//	rampTime.setTargetValueInSamples(d);
-	//	if (!(rampTime.timerExpired())) {
-	//		//need to figure out how to make outputAmplitude start at 0
-	//		parameters->outputAmplitude = parameters->outputAmplitude + (1 / d);
-	//		rampTime.advanceTimer();
+void SynthLFO::renderModulatorBlock(LFOBlockData& block, uint32_t blockSize)
+{
+	if (blockSize > MAX_LFO_BLOCK_SIZE)
+		blockSize = MAX_LFO_BLOCK_SIZE;
+
+	for (uint32_t i = 0; i < blockSize; i++)
+		renderSample(block.normal[i], block.quadPhase[i], block.amplitude[i], routedQuadPhase);
+
+	block.blockSize = blockSize;
+	block.readIndex = 0;
+}
+
+bool SynthLFO::renderSample(double& normal, double& quadPhase, double& amplitude, bool renderQuadPhase)
+{
+	normal = 0.0;
+	quadPhase = 0.0;
+	amplitude = 0.0;
 
-	//		return lfoOutputData;
-	//	}
-	//};
+	if (renderComplete)
+		return false;
 
+	// --- delay: the timebase does not run until it expires (target is set in update( ) and on note-on)
+	if (!lfodelay.timerExpired())
+	{
+		lfodelay.advanceTimer();
+		return false;
+	}
 
 	// --- always first!
 	bool bWrapped = checkAndWrapModulo(modCounter, phaseInc);
 	if (bWrapped && parameters->mode == LFOMode::kOneShot)
 	{
 		renderComplete = true;
-		return lfoOutputData;
+		return false;
 	}
 
 	// --- QP output always follows location of current modulo; first set equal
-
-	modCounterQP = modCounter;  ///this is the old code
+	modCounterQP = modCounter;
 
 	// --- then, advance modulo by quadPhaseInc = 0.25 = 90 degrees, AND wrap if needed
 	advanceAndCheckWrapModulo(modCounterQP, 0.25);
@@ -121,46 +113,42 @@ const ModOutputData SynthLFO::renderModulatorOutput()
 	// --- calculate the oscillator value
 	if (parameters->waveform == LFOWaveform::kSin)
 	{
-		// --- calculate normal angle
+		// --- calculate normal angle; norm output with parabolicSine approximation
 		double angle = modCounter*2.0*kPi - kPi;
+		normal = parabolicSine(-angle);
 
-		// --- norm output with parabolicSine approximation
-		lfoOutputData.modulationOutputs[kLFONormalOutput] = parabolicSine(-angle);
-
-		// --- calculate QP angle
-		angle = modCounterQP*2.0*kPi - kPi;
-
-		// --- calc QP output
-		lfoOutputData.modulationOutputs[kLFOQuadPhaseOutput] = parabolicSine(-angle);
+		// --- calculate QP angle and output
+		if (renderQuadPhase)
+		{
+			angle = modCounterQP*2.0*kPi - kPi;
+			quadPhase = parabolicSine(-angle);
+		}
 	}
 	else if (parameters->waveform == LFOWaveform::kTriangle)
 	{
-		// --- triv saw
-		lfoOutputData.modulationOutputs[kLFONormalOutput] = unipolarToBipolar(modCounter);
-
-		// --- bipolar triagle
-		lfoOutputData.modulationOutputs[kLFONormalOutput] = 2.0*fabs(lfoOutputData.modulationOutputs[kLFONormalOutput]) - 1.0;
+		// --- triv saw -> bipolar triangle
+		normal = 2.0*fabs(unipolarToBipolar(modCounter)) - 1.0;
 
 		// -- quad phase
-		lfoOutputData.modulationOutputs[kLFOQuadPhaseOutput] = unipolarToBipolar(modCounterQP);
-
-		// bipolar triagle
-		lfoOutputData.modulationOutputs[kLFOQuadPhaseOutput] = 2.0*fabs(lfoOutputData.modulationOutputs[kLFOQuadPhaseOutput]) - 1.0;
+		if (renderQuadPhase)
+			quadPhase = 2.0*fabs(unipolarToBipolar(modCounterQP)) - 1.0;
 	}
 	else if (parameters->waveform == LFOWaveform::kSaw)
 	{
-		lfoOutputData.modulationOutputs[kLFONormalOutput] = unipolarToBipolar(modCounter);
-		lfoOutputData.modulationOutputs[kLFOQuadPhaseOutput] = unipolarToBipolar(modCounterQP);
+		normal = unipolarToBipolar(modCounter);
+		quadPhase = unipolarToBipolar(modCounterQP);
 	}
 	else if (parameters->waveform == LFOWaveform::kNoise)
 	{
-		lfoOutputData.modulationOutputs[kLFONormalOutput] = doWhiteNoise();
-		lfoOutputData.modulationOutputs[kLFOQuadPhaseOutput] = doWhiteNoise();
+		normal = noise.uniform();
+		if (renderQuadPhase)
+			quadPhase = noise.uniform();
 	}
 	else if (parameters->waveform == LFOWaveform::kQRNoise)
 	{
-		lfoOutputData.modulationOutputs[kLFONormalOutput] = doPNSequence(pnRegister);
-		lfoOutputData.modulationOutputs[kLFOQuadPhaseOutput] = doPNSequence(pnRegister);
+		normal = doPNSequence(pnRegister);
+		if (renderQuadPhase)
+			quadPhase = doPNSequence(pnRegister);
 	}
 	else if (parameters->waveform == LFOWaveform::kRSH || parameters->waveform == LFOWaveform::kQRSH)
 	{
@@ -168,7 +156,7 @@ const ModOutputData SynthLFO::renderModulatorOutput()
 		if (randomSHCounter < 0)
 		{
 			if (parameters->waveform == LFOWaveform::kRSH)
-				randomSHValue = doWhiteNoise();
+				randomSHValue = noise.uniform();
 			else
 				randomSHValue = doPNSequence(pnRegister);
 
@@ -182,7 +170,7 @@ const ModOutputData SynthLFO::renderModulatorOutput()
 			randomSHCounter -= sampleRate / parameters->frequency_Hz;
 
 			if (parameters->waveform == LFOWaveform::kRSH)
-				randomSHValue = doWhiteNoise();
+				randomSHValue = noise.uniform();
 			else
 				randomSHValue = doPNSequence(pnRegister);
 		}
@@ -190,39 +178,25 @@ const ModOutputData SynthLFO::renderModulatorOutput()
 		// --- advance the sample counter
 		randomSHCounter += 1.0;
 
-		lfoOutputData.modulationOutputs[kLFONormalOutput] = randomSHValue;
-		lfoOutputData.modulationOutputs[kLFOQuadPhaseOutput] = randomSHValue;
+		normal = randomSHValue;
+		quadPhase = randomSHValue;
 	}
 
+	// --- scale by the ramped amplitude
+	amplitude = parameters->outputAmplitude * rampGain;
+	normal *= amplitude;
+	quadPhase *= amplitude;
 
-
-	// --- scale by amplitude
-	lfoOutputData.modulationOutputs[kLFONormalOutput] *= parameters->outputAmplitude;
-	lfoOutputData.modulationOutputs[kLFOQuadPhaseOutput] *= parameters->outputAmplitude;
-
-	// --- invert two main outputs to make the opposite versions, scaling carries over
-	lfoOutputData.modulationOutputs[kLFONormalOutputInverted] = -lfoOutputData.modulationOutputs[kLFONormalOutput];
-	lfoOutputData.modulationOutputs[kLFOQuadPhaseOutputInverted] = -lfoOutputData.modulationOutputs[kLFOQuadPhaseOutput];
-	
-	// --- special unipolar from max output for tremolo
-	//
-	// --- first, convert to unipolar
-	lfoOutputData.modulationOutputs[kUnipolarOutputFromMax] = bipolarToUnipolar(lfoOutputData.modulationOutputs[kLFONormalOutput]);
-	lfoOutputData.modulationOutputs[kUnipolarOutputFromMin] = bipolarToUnipolar(lfoOutputData.modulationOutputs[kLFONormalOutput]);
-
-	// --- then shift upwards by enough to put peaks right at 1.0
-	//     NOTE: leaving the 0.5 in the equation - it is the unipolar offset when convering bipolar; but it could be changed...
-	lfoOutputData.modulationOutputs[kUnipolarOutputFromMax] = lfoOutputData.modulationOutputs[kUnipolarOutputFromMax] + (1.0 - 0.5 - (parameters->outputAmplitude / 2.0));
-	
-	// --- then shift down enough to put troughs at 0.0
-	lfoOutputData.modulationOutputs[kUnipolarOutputFromMin] = lfoOutputData.modulationOutputs[kUnipolarOutputFromMin] - (1.0 - 0.5 - (parameters->outputAmplitude / 2.0));
+	// --- advance the ramp
+	if (rampGain < 1.0)
+	{
+		rampGain += rampInc;
+		if (rampGain > 1.0)
+			rampGain = 1.0;
+	}
 
 	// --- setup for next sample period
 	advanceModulo(modCounter, phaseInc);
 
-	// --- scale by amplituded
-	return lfoOutputData;
+	return true;
 }
-
-
-
@@ -2,6 +2,7 @@
 
 #include "synthdefs.h"
 #include "guiconstants.h"
+#include "noisegenerator.h"
 
 
 /**
@@ -58,6 +59,35 @@ enum {
 	kUnipolarOutputFromMin		/* this mimics an EG going from 0.0 -> MAX */
 };
 
+// --- largest block the LFO renders at once; the voice renders one block per component update
+const uint32_t MAX_LFO_BLOCK_SIZE = 128;
+
+/**
+\struct LFOBlockData
+
+\ingroup SynthDefs
+
+\brief One block of LFO output; the derived outputs are formed on read (see SynthLFO::writeOutputs)
+
+ - normal, quadPhase : amplitude-scaled outputs; quadPhase is only written if routed
+
+ - amplitude : the (ramped) amplitude for each sample, needed by the unipolar outputs
+
+ - readIndex : next sample to read; the owner advances it
+
+ - enabled : for the engine-level shared LFO only
+
+*/
+struct LFOBlockData
+{
+	double normal[MAX_LFO_BLOCK_SIZE] = { 0.0 };
+	double quadPhase[MAX_LFO_BLOCK_SIZE] = { 0.0 };
+	double amplitude[MAX_LFO_BLOCK_SIZE] = { 0.0 };
+	uint32_t blockSize = 0;
+	uint32_t readIndex = 0;
+	bool enabled = false;
+};
+
 
 
 
@@ -136,6 +166,10 @@ Outputs: contains 6 outputs
 	- kUnipolarOutputFromMax	
 	- kUnipolarOutputFromMin		
 
+Block rendering: renderModulatorBlock( ) runs the waveform for a whole block after update( ); only the
+outputs flagged with setRoutedOutputs( ) are computed. The delay and ramp are per-object state, never
+written back to the (shared) parameters.
+
 */
 
 // --- LFO object, note ISynthOscillator
@@ -148,11 +182,8 @@ public:
 	SynthLFO(const std::shared_ptr<MidiInputData> _midiInputData, std::shared_ptr<SynthLFOParameters> _parameters)
 		: midiInputData(_midiInputData) 
 	, parameters(_parameters){
-		srand(time(NULL)); // --- seed random number generator
-
-		// --- randomize the PN register
-		pnRegister = rand();
-
+		// --- default stream; the voice gives each LFO its own (see setNoiseSeed)
+		setNoiseSeed(0, 0);
 	}	/* C-TOR */
 	virtual ~SynthLFO() {}				/* D-TOR */
 
@@ -168,11 +199,22 @@ public:
 		modT = 0.0;
 
 		lfodelay.resetTimer();
-		rampTime.resetTimer();
+		lfodelay.setTargetValueInSamples(msecToSamples(sampleRate, parameters->delay));
+		resetRamp();
+
+		// --- rewind the noise so renders are reproducible
+		resetNoise();
 
 		return true;
 	}
 
+	// --- choose the random stream for the noise and S&H waveforms; rewinds it
+	void setNoiseSeed(uint64_t seed, uint64_t stream)
+	{
+		noise.setSeed(seed, stream);
+		resetNoise();
+	}
+
 	// --- ISynthModulator cont'd
 	virtual bool update(bool updateAllModRoutings = true);
 	virtual bool doNoteOn(double midiPitch, uint32_t _midiNoteNumber, uint32_t midiNoteVelocity) 
@@ -185,8 +227,8 @@ public:
 			modCounter = parameters->waveShapeX;
 			phaseInc = parameters->waveShapeY;
 			lfodelay.resetTimer();
-			rampTime.resetTimer();
-
+			lfodelay.setTargetValueInSamples(msecToSamples(sampleRate, parameters->delay));
+			resetRamp();
 		}
 	
 
@@ -196,13 +238,34 @@ public:
 
 	virtual bool doNoteOff(double midiPitch, uint32_t _midiNoteNumber, uint32_t midiNoteVelocity)
 	{
-		if (parameters->ramp > 0.0) parameters->outputAmplitude = 0.0;
 		return true; 
 	}
 
-	// --- the oscillator function
+	// --- the oscillator function; one sample, all outputs
 	const ModOutputData renderModulatorOutput();
 
+	// --- render blockSize samples of the routed outputs into the block and rewind it
+	void renderModulatorBlock(LFOBlockData& block, uint32_t blockSize);
+
+	// --- form the routed outputs for one sample of a block
+	inline void writeOutputs(ModOutputData& output, const LFOBlockData& block, uint32_t index)
+	{
+		if (index >= block.blockSize)
+			index = block.blockSize > 0 ? block.blockSize - 1 : 0;
+
+		writeOutputs(output, block.normal[index], routedQuadPhase ? block.quadPhase[index] : 0.0, block.amplitude[index], routedDerived);
+	}
+
+	// --- choose what the block renderer computes; the normal output is always computed
+	void setRoutedOutputs(bool quadPhase, bool derived)
+	{
+		routedQuadPhase = quadPhase;
+		routedDerived = derived;
+	}
+
+	// --- can be replaced by the engine's shared LFO
+	bool isFreeRunning() { return parameters->mode == LFOMode::kFreeRun; }
+
 	// --- get our modulators
 	virtual std::shared_ptr<ModInputData> getModulators() {
 		return modulators;
@@ -228,7 +291,48 @@ protected:
 
 
 	Timer lfodelay;
-	Timer rampTime;
+
+	// --- output ramp (after the delay): 0 -> 1 over parameters->ramp mSec
+	double rampGain = 1.0;
+	double rampInc = 1.0;
+
+	// --- outputs to compute in the block renderer
+	bool routedQuadPhase = true;
+	bool routedDerived = true;
+
+	// --- restart the ramp
+	inline void resetRamp()
+	{
+		double rampSamples = msecToSamples(sampleRate, parameters->ramp);
+		rampInc = rampSamples >= 1.0 ? 1.0 / rampSamples : 1.0;
+		rampGain = rampSamples >= 1.0 ? 0.0 : 1.0;
+	}
+
+	// --- one sample of the normal and quad phase outputs, scaled by the ramped amplitude;
+	//     returns false (and zeros) during the delay and after a one-shot
+	bool renderSample(double& normal, double& quadPhase, double& amplitude, bool renderQuadPhase);
+
+	// --- inverted and unipolar outputs from the two main outputs
+	inline void writeOutputs(ModOutputData& output, double normal, double quadPhase, double amplitude, bool derived)
+	{
+		output.modulationOutputs[kLFONormalOutput] = normal;
+		output.modulationOutputs[kLFOQuadPhaseOutput] = quadPhase;
+
+		if (!derived)
+			return;
+
+		// --- invert two main outputs to make the opposite versions, scaling carries over
+		output.modulationOutputs[kLFONormalOutputInverted] = -normal;
+		output.modulationOutputs[kLFOQuadPhaseOutputInverted] = -quadPhase;
+
+		// --- special unipolar from max output for tremolo
+		//     first, convert to unipolar; then shift upwards by enough to put peaks right at 1.0
+		//     NOTE: leaving the 0.5 in the equation - it is the unipolar offset when convering bipolar; but it could be changed...
+		output.modulationOutputs[kUnipolarOutputFromMax] = bipolarToUnipolar(normal) + (1.0 - 0.5 - (amplitude / 2.0));
+
+		// --- then shift down enough to put troughs at 0.0
+		output.modulationOutputs[kUnipolarOutputFromMin] = bipolarToUnipolar(normal) - (1.0 - 0.5 - (amplitude / 2.0));
+	}
 
 
 	// --- timebase variables
@@ -239,6 +343,17 @@ protected:
 
 	double modT = 0.0;
 
+	// --- random source for kNoise/kRSH, and the seed for the PN register
+	NoiseGenerator noise;
+
+	// --- rewind the stream and re-seed the PN register from it (never 0 or the LFSR sticks)
+	inline void resetNoise()
+	{
+		noise.reset();
+		pnRegister = noise.nextUint32() | 1;
+		randomSHCounter = -1;
+	}
+
 	// --- 32-bit register for RS&H
 	uint32_t pnRegister = 0;			///< 32 bit register for PN oscillator
 	int randomSHCounter = -1;			///< random sample/hold counter;  -1 is reset condition
@@ -58,9 +58,6 @@ bool SynthOsc::reset(double _sampleRate)
 	wavetableOscillator->reset(_sampleRate);
 	wavetableOscillator->setModulators(modulators);
 
-	// --- for noise generation
-	srand(time(NULL));
-
 	return true;
 }
 
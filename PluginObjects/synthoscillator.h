@@ -44,6 +44,29 @@ public:
 		return true;
 	}
 
+	// --- oversampled voice path
+	void setOversamplingRatio(uint32_t oversamplingRatio)
+	{
+		wavetableOscillator->setOversamplingRatio(oversamplingRatio);
+		wavetableOscillator_2->setOversamplingRatio(oversamplingRatio);
+	}
+
+	// --- unison stack (see UnisonStack)
+	void setUnisonParameters(std::shared_ptr<UnisonParameters> unisonParameters)
+	{
+		wavetableOscillator->setUnisonParameters(unisonParameters);
+		wavetableOscillator_2->setUnisonParameters(unisonParameters);
+	}
+
+	void setNoiseSeed(uint64_t seed, uint64_t stream)
+	{
+		wavetableOscillator->setNoiseSeed(seed, stream);
+		wavetableOscillator_2->setNoiseSeed(seed, stream);
+	}
+
+	// --- true when outputs[0] and outputs[1] differ (spread unison stack)
+	bool isStereo() { return wavetableOscillator->isStereo(); }
+
 	// --- our render function
 	const OscillatorOutputData renderAudioOutput();
 	
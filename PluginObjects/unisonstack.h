@@ -0,0 +1,179 @@
+#ifndef __unisonStack_h__
+#define __unisonStack_h__
+
+// --- includes
+#include "synthdefs.h"
+#include "noisegenerator.h"
+
+// --- max detuned copies per oscillator
+const uint32_t MAX_UNISON_VOICES = 16;
+
+/**
+\struct UnisonParameters
+\ingroup SynthStructures
+\brief Parameters for the unison stack, shared by the four oscillators of a voice.
+
+- voiceCount : number of stacked copies, 1 = off
+- detune_Cents : outermost copies are detuned by +/- this value; the rest are spread evenly in between
+  (the engine sets it from SynthEngineParameters::masterUnisonDetune_Cents)
+- stereoSpread : [0, 1] pan width of the stack; 0 keeps the voice mono
+- phaseSpread : [0, 1] amount of random start phase per copy on note-on (not in free-run mode)
+*/
+struct UnisonParameters
+{
+	UnisonParameters() {}
+	UnisonParameters& operator=(const UnisonParameters& params)	// need this override for collections to work
+	{
+		if (this == &params)
+			return *this;
+
+		voiceCount = params.voiceCount;
+		detune_Cents = params.detune_Cents;
+		stereoSpread = params.stereoSpread;
+		phaseSpread = params.phaseSpread;
+		return *this;
+	}
+
+	// --- individual parameters
+	uint32_t voiceCount = 1;
+	double detune_Cents = 0.0;
+	double stereoSpread = 0.0;
+	double phaseSpread = 1.0;
+};
+
+/**
+\class UnisonStack
+\ingroup SynthClasses
+\brief The per-copy state of a unison oscillator: fixed-point phases and increments, pitch ratios and pan gains.
+
+The owning oscillator does the table reads; this object holds everything that is per copy so a render is
+three flat loops over at most MAX_UNISON_VOICES lanes (phase -> read index, table reads, pan/sum).
+
+- pitch ratios and pan gains are recomputed only when the parameters change
+- copy detune is symmetric and linear across the stack; the pan positions interleave so neighbouring
+  detunes land on opposite sides
+- pan gains are equal-power, scaled so that a centred copy has unity gain in both channels
+- the stack is normalized by 1/sqrt(N) to keep the loudness of N uncorrelated copies near one copy
+
+\author Will Pirkle
+\version Revision : 1.0
+\date Date : 2018 / 09 / 24
+*/
+class UnisonStack
+{
+public:
+	UnisonStack() { }
+	~UnisonStack() { }
+
+	// --- random start phases come from this stream (see NoiseGenerator::setSeed)
+	void setSeed(uint64_t seed, uint64_t stream) { noise.setSeed(seed, stream); }
+
+	// --- recompute the per-copy tables if anything changed; call at control rate
+	void setParameters(const UnisonParameters& params)
+	{
+		uint32_t count = params.voiceCount;
+		if (count < 1)
+			count = 1;
+		else if (count > MAX_UNISON_VOICES)
+			count = MAX_UNISON_VOICES;
+
+		if (compiled && count == voiceCount && params.detune_Cents == detune_Cents &&
+			params.stereoSpread == stereoSpread)
+		{
+			phaseSpread = params.phaseSpread;
+			return;
+		}
+
+		voiceCount = count;
+		detune_Cents = params.detune_Cents;
+		stereoSpread = params.stereoSpread;
+		phaseSpread = params.phaseSpread;
+		compileStack();
+	}
+
+	bool isEnabled() { return voiceCount > 1; }
+	bool isStereo() { return voiceCount > 1 && stereoSpread > 0.0; }
+	uint32_t getVoiceCount() { return voiceCount; }
+
+	// --- highest copy pitch relative to the root, for table (mip-map) selection
+	double getMaxPitchRatio() { return maxPitchRatio; }
+
+	// --- new note: optionally restart the phases, scattered by phaseSpread
+	//     NOTE: all lanes are set so a later change in voiceCount does not start copies in phase
+	void doNoteOn(bool resetPhase)
+	{
+		if (!resetPhase)
+			return;
+
+		for (uint32_t i = 0; i < MAX_UNISON_VOICES; i++)
+			phase[i] = (uint32_t)(phaseSpread * (double)noise.nextUint32());
+	}
+
+	// --- rewind the phases and the random stream
+	void reset()
+	{
+		noise.reset();
+		memset(&phase[0], 0, MAX_UNISON_VOICES * sizeof(uint32_t));
+		memset(&phaseInc[0], 0, MAX_UNISON_VOICES * sizeof(uint32_t));
+	}
+
+	// --- all copies from the root frequency; each is bounded to Nyquist
+	void setFrequency(double oscillatorFrequency, double renderSampleRate)
+	{
+		double nyquist = renderSampleRate / 2.0;
+		for (uint32_t i = 0; i < voiceCount; i++)
+		{
+			double fo = oscillatorFrequency * pitchRatio[i];
+			boundValue(fo, 0.0, nyquist);
+			phaseInc[i] = (uint32_t)(fo / renderSampleRate * 4294967296.0);
+		}
+	}
+
+	// --- state for the owning oscillator's render loops
+	uint32_t phase[MAX_UNISON_VOICES] = { 0 };
+	uint32_t phaseInc[MAX_UNISON_VOICES] = { 0 };
+	double panLeftGain[MAX_UNISON_VOICES] = { 0.0 };		///< includes the 1/sqrt(N) normalization
+	double panRightGain[MAX_UNISON_VOICES] = { 0.0 };		///< includes the 1/sqrt(N) normalization
+
+protected:
+	NoiseGenerator noise;
+	bool compiled = false;
+
+	uint32_t voiceCount = 1;
+	double detune_Cents = 0.0;
+	double stereoSpread = 0.0;
+	double phaseSpread = 1.0;
+
+	double pitchRatio[MAX_UNISON_VOICES] = { 0.0 };
+	double maxPitchRatio = 1.0;
+
+	// --- pitch ratios and pan gains
+	void compileStack()
+	{
+		double normalize = 1.0 / sqrt((double)voiceCount);
+		maxPitchRatio = 1.0;
+
+		for (uint32_t i = 0; i < voiceCount; i++)
+		{
+			// --- position of this copy in the detune range [-1, +1]
+			double detunePosition = voiceCount > 1 ? 2.0*(double)i / (double)(voiceCount - 1) - 1.0 : 0.0;
+			pitchRatio[i] = pow(2.0, detunePosition*detune_Cents / 1200.0);
+			if (pitchRatio[i] > maxPitchRatio)
+				maxPitchRatio = pitchRatio[i];
+
+			// --- interleaved pan order: 0, N-1, 1, N-2, ...
+			uint32_t panIndex = (i & 1) ? voiceCount - 1 - (i >> 1) : (i >> 1);
+			double panPosition = voiceCount > 1 ? 2.0*(double)panIndex / (double)(voiceCount - 1) - 1.0 : 0.0;
+			panPosition *= stereoSpread;
+
+			// --- equal power, unity at centre
+			double angle = (panPosition + 1.0)*kPi / 4.0;
+			panLeftGain[i] = kSqrtTwo*cos(angle)*normalize;
+			panRightGain[i] = kSqrtTwo*sin(angle)*normalize;
+		}
+
+		compiled = true;
+	}
+};
+
+#endif /* defined(__unisonStack_h__) */
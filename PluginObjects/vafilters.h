@@ -3,9 +3,43 @@
 
 // --- includes
 #include "synthdefs.h"
+#include "oversampler.h"
 
 const int NUM_SUBFILTERS = 4;
 
+// --- fast tan( ) for the bilinear prewarp: Pade-style rational approximation,
+//     relative error < 1e-4 for x in [0, 1.5] which covers fc up to ~0.47*fs
+inline double fastTan(double x)
+{
+	double x2 = x*x;
+	return x*(135135.0 - x2*(17325.0 - x2*378.0)) / (135135.0 - x2*(62370.0 - x2*(3150.0 - x2*28.0)));
+}
+
+// --- prewarped g = tan(pi*fc/fs); same value as ZVAFilter::calculateFilterCoeffs( ) without the tan( )
+inline double calculatePrewarp_g(double fc, double sampleRate)
+{
+	return fastTan(kPi*fc / sampleRate);
+}
+
+// --- fast tanh( ) for the saturating ladder: Pade-style rational approximation, error < 0.025
+//     on [-3, 3] where it reaches +/-1 exactly; clamped outside
+inline double fastTanh(double x)
+{
+	if (x > 3.0)
+		return 1.0;
+	if (x < -3.0)
+		return -1.0;
+
+	double x2 = x*x;
+	return x*(27.0 + x2) / (27.0 + 9.0*x2);
+}
+
+// --- tan(x/2) from tan(x); moves a prewarped g to twice the sample rate with one sqrt( )
+inline double halfAngleTan(double tanX)
+{
+	return tanX / (1.0 + sqrt(1.0 + tanX*tanX));
+}
+
 /**
 \class ZVAFilterEx
 \ingroup SynthClasses
@@ -43,6 +77,14 @@ public:
 		return g; 
 	}
 
+	// --- fast coefficient path: set the 1st order alpha = g/(1+g) directly
+	//     NOTE: invalidates the stored fc so the next setParameters( ) always recalculates
+	void setAlpha(double _alpha)
+	{
+		alpha = _alpha;
+		zvaFilterParameters.fc = -1.0;
+	}
+
 protected:
 };
 
@@ -66,6 +108,7 @@ struct MoogFilterParameters
 		filterOutputGain_dB = params.filterOutputGain_dB;
 		enableGainComp = params.enableGainComp;
 		enableNLP = params.enableNLP;
+		drive = params.drive;
 		return *this;
 	}
 
@@ -75,10 +118,142 @@ struct MoogFilterParameters
 	double Q = 0.707;
 	double filterOutputGain_dB = 0.0; // usually not used
 	bool enableGainComp = false;
-	bool enableNLP = false;
+	bool enableNLP = false;		// --- saturating ladder, runs at 2x internally
+	double drive = 1.0;			// --- NLP only: input gain into the saturator
 };
 
 
+// --- one lane per voice; at 4 doubles this is one AVX register per coefficient/state row,
+//     raising MAX_VOICES to 8 widens every row to 8 lanes with no other changes
+const uint32_t LADDER_LANES = MAX_VOICES;
+
+// --- the complete coefficient set for one ladder, in a form with no per-type branching
+struct LadderLaneCoeffs
+{
+	double G = 0.0;									// --- sub-filter alpha = g/(1 + g)
+	double beta[NUM_SUBFILTERS] = { 0.0 };			// --- feedback taps on the integrator states
+	double alpha0 = 1.0;							// --- delay-free loop correction
+	double K = 0.0;									// --- resonance
+	double inputGain = 1.0;							// --- gain comp (1 + 0.5K) or 1
+	double apfMix[NUM_SUBFILTERS] = { 0.0 };		// --- 1.0 = stage is an APF1 (kLPF2, stages 2 and 3)
+	double outputMix[NUM_SUBFILTERS + 1] = { 0.0 };	// --- output = A*u + B*y0 + C*y1 + D*y2 + E*y3
+};
+
+/**
+\class MultiVoiceLadder
+\ingroup SynthClasses
+\brief Runs LADDER_LANES independent Moog ladders (one per voice) in lockstep.
+
+- structure-of-arrays: every coefficient and integrator state is a row of LADDER_LANES doubles
+- per-lane cutoff (G, betas) and resonance (K, alpha0) vectors
+- kLPF2/kLPF4/kHPF2/kHPF4 are folded into the APF stage mix and the output mix (see LadderLaneCoeffs)
+  so every lane runs the same arithmetic and the lane loops have no branches; the compiler vectorizes
+  the fixed-length lane loops (SSE2/AVX) without intrinsics
+- same math as MoogFilter::processAudioSample( ); kLPF2 also runs the unused 4th stage (its beta is 0)
+
+\author Will Pirkle
+\version Revision : 1.0
+\date Date : 2018 / 09 / 24
+*/
+class MultiVoiceLadder
+{
+public:
+	MultiVoiceLadder()
+	{
+		for (uint32_t lane = 0; lane < LADDER_LANES; lane++)
+			setLaneBypass(lane);
+	}
+	~MultiVoiceLadder() {}
+
+	// --- clear all integrator states
+	void reset()
+	{
+		memset(&state[0][0], 0, NUM_SUBFILTERS * LADDER_LANES * sizeof(double));
+	}
+
+	// --- load a lane from a MoogFilter's coefficients (see MoogFilter::getLadderLaneCoeffs)
+	inline void setLaneCoeffs(uint32_t lane, const LadderLaneCoeffs& coeffs)
+	{
+		if (lane >= LADDER_LANES)
+			return;
+
+		G[lane] = coeffs.G;
+		alpha0[lane] = coeffs.alpha0;
+		K[lane] = coeffs.K;
+		inputGain[lane] = coeffs.inputGain;
+
+		for (int i = 0; i < NUM_SUBFILTERS; i++)
+		{
+			beta[i][lane] = coeffs.beta[i];
+			apfMix[i][lane] = coeffs.apfMix[i];
+		}
+		for (int i = 0; i < NUM_SUBFILTERS + 1; i++)
+			outputMix[i][lane] = coeffs.outputMix[i];
+	}
+
+	// --- lane passes input to output; its states are frozen (G = 0)
+	inline void setLaneBypass(uint32_t lane)
+	{
+		LadderLaneCoeffs coeffs;
+		coeffs.outputMix[0] = 1.0;
+		setLaneCoeffs(lane, coeffs);
+	}
+
+	// --- one sample for every lane; input and output hold LADDER_LANES values
+	inline void processAudioSamples(const double* input, double* output)
+	{
+		double stageInput[LADDER_LANES];
+		double y[LADDER_LANES];
+
+		// --- u(n) = alpha0*[x(n)*gainComp - K*sigma]
+		for (uint32_t lane = 0; lane < LADDER_LANES; lane++)
+		{
+			double sigma = beta[0][lane] * state[0][lane] +
+						   beta[1][lane] * state[1][lane] +
+						   beta[2][lane] * state[2][lane] +
+						   beta[3][lane] * state[3][lane];
+
+			stageInput[lane] = alpha0[lane] * (input[lane] * inputGain[lane] - K[lane] * sigma);
+			y[lane] = outputMix[0][lane] * stageInput[lane];
+		}
+
+		// --- four 1st order stages, LPF or APF by mix
+		for (int i = 0; i < NUM_SUBFILTERS; i++)
+		{
+			double* s = &state[i][0];
+			for (uint32_t lane = 0; lane < LADDER_LANES; lane++)
+			{
+				double xn = stageInput[lane];
+				double vn = (xn - s[lane])*G[lane];
+				double lpf = vn + s[lane];
+				s[lane] = vn + lpf;
+
+				// --- APF = LPF - HPF = 2*LPF - x
+				double stageOutput = lpf + apfMix[i][lane] * (lpf - xn);
+
+				y[lane] += outputMix[i + 1][lane] * stageOutput;
+				stageInput[lane] = stageOutput;
+			}
+		}
+
+		for (uint32_t lane = 0; lane < LADDER_LANES; lane++)
+			output[lane] = y[lane];
+	}
+
+protected:
+	// --- coefficient rows
+	alignas(32) double G[LADDER_LANES];
+	alignas(32) double alpha0[LADDER_LANES];
+	alignas(32) double K[LADDER_LANES];
+	alignas(32) double inputGain[LADDER_LANES];
+	alignas(32) double beta[NUM_SUBFILTERS][LADDER_LANES];
+	alignas(32) double apfMix[NUM_SUBFILTERS][LADDER_LANES];
+	alignas(32) double outputMix[NUM_SUBFILTERS + 1][LADDER_LANES];
+
+	// --- integrator states, one row per stage
+	alignas(32) double state[NUM_SUBFILTERS][LADDER_LANES] = { { 0.0 } };
+};
+
 /**
 \class MoogFilter
 \ingroup SynthClasses
@@ -116,6 +291,7 @@ public:
 		{
 			subFilter[i].reset(_sampleRate);
 		}
+		resetNLP();
 
 		// --- setup
 		calculateFilterCoeffs();
@@ -131,6 +307,10 @@ public:
 	// --- set parameters
 	void setParameters(const MoogFilterParameters& params)
 	{
+		// --- the saturating ladder keeps its own state; start it clean when switching over
+		if (params.enableNLP && !moogFilterParameters.enableNLP)
+			resetNLP();
+
 		// --- if Fc changed, reset it on all subfilters
 		moogFilterParameters = params;
 
@@ -151,48 +331,81 @@ public:
 
 	// --- calculate MOOG coefficients; the subFilters are updated with subFilter[i].setParameters(params);
 	void calculateFilterCoeffs()
+	{
+		calculateLadderCoeffs(subFilter[0].getAlpha(), subFilter[0].getLittle_g());
+	}
+
+	// --- fast coefficient path for cutoff modulation: g is the prewarped tan(pi*fc/fs)
+	//     (see calculatePrewarp_g); no tan( ) or pow( ) and no parameter copies
+	void setLittle_g(double g)
+	{
+		double G = g / (1.0 + g);
+		for (int i = 0; i < NUM_SUBFILTERS; i++)
+			subFilter[i].setAlpha(G);
+
+		calculateLadderCoeffs(G, g);
+	}
+
+	// --- ladder coefficients from the sub-filter G (alpha) and prewarped g; the saturating ladder
+	//     runs at 2x so it gets its own set from g at twice the sample rate
+	void calculateLadderCoeffs(double G, double g)
+	{
+		calculateLadderCoeffs(G, g, K, beta, alpha0);
+
+		if (!moogFilterParameters.enableNLP)
+			return;
+
+		double g2 = halfAngleTan(g);
+		nlpCoeffs.G = g2 / (1.0 + g2);
+		// --- let the resonance run past the linear limit so the ladder can self-oscillate; alpha0 follows the scaled K
+		calculateLadderCoeffs(nlpCoeffs.G, g2, nlpCoeffs.K, nlpCoeffs.beta, nlpCoeffs.alpha0, nlpResonanceScale);
+
+		nlpCoeffs.inputGain = moogFilterParameters.drive * (moogFilterParameters.enableGainComp ? 1.0 + 0.5*nlpCoeffs.K : 1.0);
+		setLadderMix(nlpCoeffs);
+	}
+
+	// --- resonanceScale multiplies K before alpha0 is calculated from it
+	void calculateLadderCoeffs(double G, double g, double& _K, double* _beta, double& _alpha0, double resonanceScale = 1.0)
 	{
 		if (moogFilterParameters.filterAlgorithm == moogFilterAlgorithm::kLPF4 ||
 			moogFilterParameters.filterAlgorithm == moogFilterAlgorithm::kHPF4 ||
 			moogFilterParameters.filterAlgorithm == moogFilterAlgorithm::kHPF2)
 		{
 			// --- Q is 1 -> 10 for my plugins; just map it to 0 -> 4
-			K = (4.0)*(moogFilterParameters.Q - 1.0) / (10.0 - 1.0);
+			_K = (4.0)*(moogFilterParameters.Q - 1.0) / (10.0 - 1.0);
+			_K *= resonanceScale;
 
-			double G = subFilter[0].getAlpha();
-			double g = subFilter[0].getLittle_g();
 			double onePlus_g = 1.0 + g;
 
 			// --- follow cookbook instructions
-			beta[0] = (G*G*G / onePlus_g);
-			beta[1] = (G*G / onePlus_g);
-			beta[2] = (G / onePlus_g);
-			beta[3] = (1.0 / onePlus_g);
+			_beta[0] = (G*G*G / onePlus_g);
+			_beta[1] = (G*G / onePlus_g);
+			_beta[2] = (G / onePlus_g);
+			_beta[3] = (1.0 / onePlus_g);
 
 			// --- alpha0 = 1/(1 + K*G*G*G*G)
-			alpha0 = 1.0 / (1.0 + K*G*G*G*G);
+			_alpha0 = 1.0 / (1.0 + _K*G*G*G*G);
 		}
 		else if (moogFilterParameters.filterAlgorithm == moogFilterAlgorithm::kLPF2)
 		{
 			// --- Q controls always 1 -> 10  kFilterGUI_Q_Range = (10.0 - 1.0)
 			//	   this maps qControl = 1 -> 10   to   K = 0 -> 2
-			K = (2.0)*(moogFilterParameters.Q - 1.0) / (10.0 - 1.0);
+			_K = (2.0)*(moogFilterParameters.Q - 1.0) / (10.0 - 1.0);
+			_K *= resonanceScale;
 
 			// the allpass G value
-			double G = subFilter[0].getAlpha();
-			double g = subFilter[0].getLittle_g();
 			double onePlus_g = 1.0 + g;
 			double GA = 2.0*G - 1;
 
 			// --- half ladder calcs
 			// --- follow cookbook instructions
-			beta[0] = (GA*G / onePlus_g);
-			beta[1] = (GA / onePlus_g);
-			beta[2] = (2.0 / onePlus_g);
-			beta[3] = 0.0;
+			_beta[0] = (GA*G / onePlus_g);
+			_beta[1] = (GA / onePlus_g);
+			_beta[2] = (2.0 / onePlus_g);
+			_beta[3] = 0.0;
 
 			// calculate alpha0
-			alpha0 = 1.0 / (1.0 + K*GA*G*G);
+			_alpha0 = 1.0 / (1.0 + _K*GA*G*G);
 		}
 	}
 
@@ -202,6 +415,16 @@ public:
 	// --- process audio: run the filter
 	virtual double processAudioSample(double xn)
 	{
+		// --- saturating ladder: fixed cost of two ladder passes + the half-band pair (2 x 24 MACs)
+		if (moogFilterParameters.enableNLP)
+		{
+			double oversampled[2] = { 0.0 };
+			nlpOversampler.upsample(xn, &oversampled[0]);
+			oversampled[0] = processNLPSample(oversampled[0]);
+			oversampled[1] = processNLPSample(oversampled[1]);
+			return nlpOversampler.downsample(&oversampled[0]);
+		}
+
 		// --- 4th order MOOG:
 		double sigma = 0.0;
 		if (moogFilterParameters.filterAlgorithm == moogFilterAlgorithm::kLPF2)
@@ -280,7 +503,87 @@ public:
 		return xn; // should never happen
 	}
 
+	// --- export the current coefficients for the multi-voice kernel (see MultiVoiceLadder)
+	//     NOTE: linear ladder only; check isNonLinear( ) first
+	void getLadderLaneCoeffs(LadderLaneCoeffs& coeffs)
+	{
+		coeffs.G = subFilter[0].getAlpha();
+		coeffs.alpha0 = alpha0;
+		coeffs.K = K;
+		coeffs.inputGain = moogFilterParameters.enableGainComp ? 1.0 + 0.5*K : 1.0;
+
+		for (int i = 0; i < NUM_SUBFILTERS; i++)
+			coeffs.beta[i] = beta[i];
+
+		setLadderMix(coeffs);
+	}
+
+	// --- saturating ladder mode
+	bool isNonLinear() { return moogFilterParameters.enableNLP; }
+
+	void resetNLP()
+	{
+		memset(&nlpState[0], 0, NUM_SUBFILTERS * sizeof(double));
+		nlpOversampler.reset();
+	}
+
 protected:
+	// --- the per-type stage and output mix for a lane coefficient set
+	void setLadderMix(LadderLaneCoeffs& coeffs)
+	{
+		for (int i = 0; i < NUM_SUBFILTERS; i++)
+			coeffs.apfMix[i] = (i > 1 && moogFilterParameters.filterAlgorithm == moogFilterAlgorithm::kLPF2) ? 1.0 : 0.0;
+
+		// --- output = A*u + B*y0 + C*y1 + D*y2 + E*y3
+		double mix[NUM_SUBFILTERS + 1] = { 0.0, 0.0, 0.0, 0.0, 1.0 }; // kLPF4
+		if (moogFilterParameters.filterAlgorithm == moogFilterAlgorithm::kLPF2)
+		{
+			mix[3] = 1.0;
+			mix[4] = 0.0;
+		}
+		else if (moogFilterParameters.filterAlgorithm == moogFilterAlgorithm::kHPF4)
+		{
+			mix[0] = 1.0; mix[1] = -4.0; mix[2] = 6.0; mix[3] = -4.0; mix[4] = 1.0;
+		}
+		else if (moogFilterParameters.filterAlgorithm == moogFilterAlgorithm::kHPF2)
+		{
+			mix[0] = 1.0; mix[1] = -2.0; mix[2] = 1.0; mix[3] = 0.0; mix[4] = 0.0;
+		}
+
+		for (int i = 0; i < NUM_SUBFILTERS + 1; i++)
+			coeffs.outputMix[i] = mix[i];
+	}
+
+	// --- one 2x-rate sample of the saturating ladder: the input stage (u) and the input of every
+	//     following stage go through tanh( ), like the transistor pairs of the ladder; the delay-free
+	//     loop is solved with the linear model as usual; resonance past the linear limit self-oscillates
+	//     at an amplitude set by the saturators
+	inline double processNLPSample(double xn)
+	{
+		double sigma = nlpCoeffs.beta[0] * nlpState[0] +
+					   nlpCoeffs.beta[1] * nlpState[1] +
+					   nlpCoeffs.beta[2] * nlpState[2] +
+					   nlpCoeffs.beta[3] * nlpState[3];
+
+		double stageInput = fastTanh(nlpCoeffs.alpha0*(xn*nlpCoeffs.inputGain - nlpCoeffs.K*sigma));
+		double yn = nlpCoeffs.outputMix[0] * stageInput;
+
+		for (int i = 0; i < NUM_SUBFILTERS; i++)
+		{
+			double vn = (stageInput - nlpState[i])*nlpCoeffs.G;
+			double lpf = vn + nlpState[i];
+			nlpState[i] = vn + lpf;
+
+			double stageOutput = lpf + nlpCoeffs.apfMix[i] * (lpf - stageInput);
+			yn += nlpCoeffs.outputMix[i + 1] * stageOutput;
+
+			// --- each stage saturates into the next
+			stageInput = fastTanh(stageOutput);
+		}
+
+		return yn;
+	}
+
 	MoogFilterParameters moogFilterParameters;			// our copy for fc, Q and filter type
 	ZVAFilterEx subFilter[NUM_SUBFILTERS];				// --- NUM_SUBFILTERS filters
 
@@ -288,6 +591,12 @@ protected:
 	double beta[NUM_SUBFILTERS] = { 0.0 };
 	double alpha0 = 1.0;	// --- our delay free loop correction coeffient (different from sub filters which also have their own)
 	double K = 0.0;			// --- this is 0.0 --> 4.0 = Q from 1 --> 10
+
+	// --- saturating ladder: 2x-rate coefficients, state and the half-band pair
+	LadderLaneCoeffs nlpCoeffs;
+	double nlpState[NUM_SUBFILTERS] = { 0.0 };
+	HalfBand2xOversampler nlpOversampler;
+	const double nlpResonanceScale = 1.15;	// --- max K = 4.6 (LPF4): past the self-oscillation point
 };
 
 enum class twinFilterConfig { kBypass, kTWIN_LP4, kTWIN_LP2, kHP_LP4, kHP_LP2 };
@@ -308,6 +617,8 @@ struct TwinMoogFilterParameters
 		Q2 = params.Q2;
 
 		enableGainComp = params.enableGainComp;
+		enableNLP = params.enableNLP;
+		drive = params.drive;
 
 		filterConfiguration = params.filterConfiguration;
 
@@ -320,6 +631,8 @@ struct TwinMoogFilterParameters
 	double fc2 = 0.0;
 	double Q2 = 0.707;
 	bool enableGainComp = false;
+	bool enableNLP = false;		// --- saturating ladders (see MoogFilter)
+	double drive = 1.0;
 
 	twinFilterConfig filterConfiguration = twinFilterConfig::kTWIN_LP4;
 };
@@ -369,6 +682,8 @@ public:
 
 		MoogFilterParameters zvaParams1 = subFilter[0].getParameters();
 		MoogFilterParameters zvaParams2 = subFilter[1].getParameters();
+		zvaParams1.filterAlgorithm = moogFilterAlgorithm::kLPF4;
+		zvaParams2.filterAlgorithm = moogFilterAlgorithm::kLPF4;
 
 		if (parameters->filterConfiguration == twinFilterConfig::kHP_LP2)
 		{
@@ -400,26 +715,44 @@ public:
 		boundValue(fc1, freqModLow, freqModHigh);
 		boundValue(fc2, freqModLow, freqModHigh);
 
-		if (true)// (fc1 != finalFilter_fc1)
+		// --- type, Q, gain comp and saturation go through the normal (slow) path, only when they change
+		if (zvaParams1.filterAlgorithm != subFilter[0].getParameters().filterAlgorithm ||
+			parameters->Q1 != zvaParams1.Q || parameters->enableGainComp != zvaParams1.enableGainComp ||
+			parameters->enableNLP != zvaParams1.enableNLP || parameters->drive != zvaParams1.drive)
 		{
 			zvaParams1.fc = fc1;
 			zvaParams1.Q = parameters->Q1;
 			zvaParams1.enableGainComp = parameters->enableGainComp;
+			zvaParams1.enableNLP = parameters->enableNLP;
+			zvaParams1.drive = parameters->drive;
 			subFilter[0].setParameters(zvaParams1);
-			finalFilter_fc1 = fc1;
+			current_g[0] = calculatePrewarp_g(fc1, sampleRate);
 		}
-		if (true)//(fc2 != finalFilter_fc2)
+		if (zvaParams2.filterAlgorithm != subFilter[1].getParameters().filterAlgorithm ||
+			parameters->Q2 != zvaParams2.Q || parameters->enableGainComp != zvaParams2.enableGainComp ||
+			parameters->enableNLP != zvaParams2.enableNLP || parameters->drive != zvaParams2.drive)
 		{
 			zvaParams2.fc = fc2;
 			zvaParams2.Q = parameters->Q2;
 			zvaParams2.enableGainComp = parameters->enableGainComp;
+			zvaParams2.enableNLP = parameters->enableNLP;
+			zvaParams2.drive = parameters->drive;
 			subFilter[1].setParameters(zvaParams2);
-			finalFilter_fc2 = fc2;
+			current_g[1] = calculatePrewarp_g(fc2, sampleRate);
 		}
 
+		// --- cutoff: fast prewarp, then ramp g across the update interval
+		setCutoffTargets(fc1, fc2);
+
+		finalFilter_fc1 = fc1;
+		finalFilter_fc2 = fc2;
+
 		return true;
 	}
 
+	// --- number of samples between full updates; the cutoff ramps across this many samples
+	void setCoefficientRampLength(uint32_t samples) { coeffRampLength = samples > 0 ? samples : 1; }
+
 	virtual bool doNoteOn(double midiPitch, uint32_t _midiNoteNumber, uint32_t midiNoteVelocity) { return true; }
 	virtual bool doNoteOff(double midiPitch, uint32_t _midiNoteNumber, uint32_t midiNoteVelocity) { return true; }
 
@@ -427,11 +760,16 @@ public:
 	virtual bool reset(double _sampleRate)
 	{
 		// --- initialize four identical ZVAFilters as LPF1 types
+		sampleRate = _sampleRate;
 		for (int i = 0; i < 2; i++)
 		{
 			subFilter[i].reset(_sampleRate);
 			limiter[i].reset(_sampleRate);
+			current_g[i] = calculatePrewarp_g(subFilter[i].getParameters().fc, sampleRate);
+			target_g[i] = current_g[i];
+			inc_g[i] = 0.0;
 		}
+		rampCounter = 0;
 
 		return true;
 	}
@@ -445,6 +783,8 @@ public:
 		if (parameters->filterConfiguration == twinFilterConfig::kBypass)
 			return xn;
 
+		advanceCoefficientRamp();
+
 		if (parameters->filterConfiguration == twinFilterConfig::kHP_LP2 ||
 			parameters->filterConfiguration == twinFilterConfig::kHP_LP4 )
 		{
@@ -471,6 +811,28 @@ public:
 		return xn; // neve rhappen
 	}
 
+	// --- coefficient interpolation: a few multiplies + one divide per filter
+	inline void advanceCoefficientRamp()
+	{
+		if (rampCounter == 0)
+			return;
+
+		rampCounter--;
+		for (int i = 0; i < 2; i++)
+		{
+			current_g[i] = rampCounter == 0 ? target_g[i] : current_g[i] + inc_g[i];
+			subFilter[i].setLittle_g(current_g[i]);
+		}
+	}
+
+	// --- multi-voice path: the engine runs the ladders (see MultiVoiceLadder), the voice keeps
+	//     the coefficient ramp and the limiters; call advanceCoefficientRamp( ) first, once per sample
+	//     NOTE: the saturating ladders are not lane-able; run those voices through processAudioSample( )
+	twinFilterConfig getFilterConfiguration() { return parameters->filterConfiguration; }
+	bool isNonLinear() { return subFilter[0].isNonLinear() || subFilter[1].isNonLinear(); }
+	void getLadderLaneCoeffs(uint32_t filterIndex, LadderLaneCoeffs& coeffs) { subFilter[filterIndex > 0 ? 1 : 0].getLadderLaneCoeffs(coeffs); }
+	double processLimiter(uint32_t filterIndex, double xn) { return limiter[filterIndex > 0 ? 1 : 0].processAudioSample(xn); }
+
 	// --- access to modulators
 	// --- get our modulators
 	virtual std::shared_ptr<ModInputData> getModulators() {
@@ -498,6 +860,26 @@ protected:
 	double finalFilter_fc1 = 1000.0;
 	double finalFilter_fc2 = 1000.0;
 	double freqModSemitoneRange = 0.0;
+	double sampleRate = 44100.0;
+
+	// --- interpolated prewarped cutoff, one per filter
+	double current_g[2] = { 0.0 };
+	double target_g[2] = { 0.0 };
+	double inc_g[2] = { 0.0 };
+	uint32_t rampCounter = 0;
+	uint32_t coeffRampLength = 1;
+
+	// --- set up the cutoff ramp from the current g to the new targets
+	inline void setCutoffTargets(double fc1, double fc2)
+	{
+		target_g[0] = calculatePrewarp_g(fc1, sampleRate);
+		target_g[1] = calculatePrewarp_g(fc2, sampleRate);
+
+		for (int i = 0; i < 2; i++)
+			inc_g[i] = (target_g[i] - current_g[i]) / (double)coeffRampLength;
+
+		rampCounter = coeffRampLength;
+	}
 };
 
 
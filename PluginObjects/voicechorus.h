@@ -0,0 +1,261 @@
+#ifndef __voiceChorus_h__
+#define __voiceChorus_h__
+
+// --- includes
+#include "synthdefs.h"
+#include "fxobjects.h"
+
+// --- one chorus lane per voice
+const uint32_t CHORUS_LANES = MAX_VOICES;
+
+// --- same delay range as ModulatedDelay's kChorus algorithm: 10 mSec + up to 30 mSec of depth
+const double CHORUS_MIN_DELAY_mSec = 10.0;
+const double CHORUS_MAX_DEPTH_mSec = 30.0;
+
+/**
+\struct VoiceChorusParameters
+\ingroup SynthStructures
+\brief Parameters for the per-voice chorus that runs ahead of the voice summing in the engine.
+
+- enable : false = the voices are summed straight to the bus (no chorus, no cost)
+- rate_Hz, depth_Pct, waveform : the shared LFO, with ModulatedDelay's chorus depth mapping
+- voicePhaseSpread : [0, 1] spread of the per-voice LFO phases; 1 = evenly around the cycle
+- stereoPhaseOffset : [0, 1] right tap LFO phase offset from the left tap, in cycles (0.25 = quadrature)
+- wetLevel_dB, dryLevel_dB : mix of each voice's chorus taps and its dry signal
+*/
+struct VoiceChorusParameters
+{
+	VoiceChorusParameters() {}
+	VoiceChorusParameters& operator=(const VoiceChorusParameters& params)	// need this override for collections to work
+	{
+		if (this == &params)
+			return *this;
+
+		enable = params.enable;
+		rate_Hz = params.rate_Hz;
+		depth_Pct = params.depth_Pct;
+		waveform = params.waveform;
+		voicePhaseSpread = params.voicePhaseSpread;
+		stereoPhaseOffset = params.stereoPhaseOffset;
+		wetLevel_dB = params.wetLevel_dB;
+		dryLevel_dB = params.dryLevel_dB;
+		return *this;
+	}
+
+	// --- individual parameters
+	bool enable = false;
+	double rate_Hz = 0.5;
+	double depth_Pct = 50.0;
+	generatorWaveform waveform = generatorWaveform::kTriangle;
+	double voicePhaseSpread = 1.0;
+	double stereoPhaseOffset = 0.25;
+	double wetLevel_dB = -3.0;
+	double dryLevel_dB = 0.0;
+};
+
+/**
+\class MultiVoiceChorus
+\ingroup SynthClasses
+\brief A chorus for every voice, run in lockstep: all voices' delay lines are processed in one pass over
+CHORUS_LANES lanes, before the voices are summed, so each voice gets its own modulation and stereo width.
+
+- the lane states are SoA rows of CHORUS_LANES doubles (same layout as MultiVoiceLadder); the lane loops
+  have fixed length so the compiler vectorizes them
+- the delay lines share one interleaved memory, row = one sample of every lane, with a guard row past the
+  end so the linear-interpolated read of the last row never wraps (see GuardedCircularBuffer)
+- one LFO phase for all lanes plus a per-lane offset; the right tap reads the same line at stereoPhaseOffset
+- the voice's (L + R)/2 feeds its line; the taps go out left/right, mixed with the voice's dry L/R
+- all lanes run while the chorus is enabled, so the tail of a released voice decays naturally
+
+\author Will Pirkle
+\version Revision : 1.0
+\date Date : 2018 / 09 / 24
+*/
+class MultiVoiceChorus
+{
+public:
+	MultiVoiceChorus() { }
+	~MultiVoiceChorus() { }
+
+	/** size and clear the delay lines; do NOT call from realtime audio thread */
+	void reset(double _sampleRate)
+	{
+		sampleRate = _sampleRate;
+
+		// --- power of two rows, at least the longest delay + 1 for the interpolation
+		uint32_t maxDelay = (uint32_t)((CHORUS_MIN_DELAY_mSec + CHORUS_MAX_DEPTH_mSec)*sampleRate / 1000.0) + 2;
+		rows = 1;
+		while (rows < maxDelay)
+			rows <<= 1;
+		rowMask = rows - 1;
+
+		delayMemory.create((size_t)(rows + CHORUS_GUARD_ROWS) * CHORUS_LANES);
+		writeRow = 0;
+		lfoPhase = 0.0;
+
+		// --- the delay range depends on the sample rate
+		setParameters(parameters);
+	}
+
+	/** set parameters; cheap enough for control rate */
+	void setParameters(const VoiceChorusParameters& params)
+	{
+		parameters = params;
+
+		lfoPhaseInc = sampleRate > 0.0 ? parameters.rate_Hz / sampleRate : 0.0;
+		useSine = parameters.waveform == generatorWaveform::kSin;
+		wetGain = pow(10.0, parameters.wetLevel_dB / 20.0);
+		dryGain = pow(10.0, parameters.dryLevel_dB / 20.0);
+
+		// --- doBipolarModulation(depth * lfo, min, min + maxDepth) as centre +/- range
+		double depth = parameters.depth_Pct / 100.0;
+		boundValue(depth, 0.0, 1.0);
+		centreDelay_Samples = (CHORUS_MIN_DELAY_mSec + 0.5*CHORUS_MAX_DEPTH_mSec)*sampleRate / 1000.0;
+		delayRange_Samples = depth*0.5*CHORUS_MAX_DEPTH_mSec*sampleRate / 1000.0;
+
+		double spread = parameters.voicePhaseSpread;
+		boundValue(spread, 0.0, 1.0);
+		double stereo = parameters.stereoPhaseOffset;
+		boundValue(stereo, 0.0, 1.0);
+		for (uint32_t i = 0; i < CHORUS_LANES; i++)
+		{
+			lanePhaseLeft[i] = spread*(double)i / (double)CHORUS_LANES;
+			lanePhaseRight[i] = lanePhaseLeft[i] + stereo;
+		}
+	}
+
+	/** true if the engine should route the voices through the chorus */
+	bool isEnabled() { return parameters.enable; }
+
+	/** one frame: voiceLeft/voiceRight are CHORUS_LANES wide (0.0 for silent voices); outputs are the sum over the lanes */
+	inline void processFrame(const double* voiceLeft, const double* voiceRight, double& outputLeft, double& outputRight)
+	{
+		processLanes(voiceLeft, voiceRight);
+
+		double sumLeft = 0.0;
+		double sumRight = 0.0;
+		for (uint32_t i = 0; i < CHORUS_LANES; i++)
+		{
+			sumLeft += laneOutLeft[i];
+			sumRight += laneOutRight[i];
+		}
+		outputLeft = sumLeft;
+		outputRight = sumRight;
+	}
+
+	/** a block: voiceLeft[lane]/voiceRight[lane] are blockSize frames each; the chorused sum is ADDED to the bus */
+	void processBlock(double* const* voiceLeft, double* const* voiceRight, double* busLeft, double* busRight, uint32_t blockSize)
+	{
+		alignas(32) double inLeft[CHORUS_LANES];
+		alignas(32) double inRight[CHORUS_LANES];
+
+		for (uint32_t n = 0; n < blockSize; n++)
+		{
+			for (uint32_t i = 0; i < CHORUS_LANES; i++)
+			{
+				inLeft[i] = voiceLeft[i][n];
+				inRight[i] = voiceRight[i][n];
+			}
+
+			double outputLeft = 0.0;
+			double outputRight = 0.0;
+			processFrame(inLeft, inRight, outputLeft, outputRight);
+			busLeft[n] += outputLeft;
+			busRight[n] += outputRight;
+		}
+	}
+
+private:
+	// --- rows of the interleaved lines past the end, mirrored from the start
+	static const uint32_t CHORUS_GUARD_ROWS = 1;
+
+	VoiceChorusParameters parameters;
+	double sampleRate = 0.0;
+
+	// --- interleaved delay lines: [row * CHORUS_LANES + lane]
+	DelayMemory<double> delayMemory;
+	uint32_t rows = 0;
+	uint32_t rowMask = 0;
+	uint32_t writeRow = 0;
+
+	// --- LFO and mapping
+	double lfoPhase = 0.0;
+	double lfoPhaseInc = 0.0;
+	bool useSine = false;
+	double centreDelay_Samples = 0.0;
+	double delayRange_Samples = 0.0;
+	double wetGain = 1.0;
+	double dryGain = 1.0;
+
+	// --- lanes
+	alignas(32) double lanePhaseLeft[CHORUS_LANES] = { 0.0 };
+	alignas(32) double lanePhaseRight[CHORUS_LANES] = { 0.0 };
+	alignas(32) double laneOutLeft[CHORUS_LANES] = { 0.0 };
+	alignas(32) double laneOutRight[CHORUS_LANES] = { 0.0 };
+
+	/** bipolar LFO value of a phase in [0, 3); triangle or parabolic sine (same shapes as the LFO object) */
+	inline double lfoValue(double phase)
+	{
+		phase -= (double)(int)phase;
+		if (useSine)
+		{
+			double angle = kPi - kTwoPi*phase;
+			double y = (4.0 / kPi)*angle - (4.0 / (kPi*kPi))*angle*fabs(angle);
+			return 0.225*(y*fabs(y) - y) + y;
+		}
+		return 2.0*fabs(2.0*phase - 1.0) - 1.0;
+	}
+
+	/** write all lanes, read both taps of all lanes */
+	inline void processLanes(const double* voiceLeft, const double* voiceRight)
+	{
+		double* line = delayMemory.get();
+		if (!line)
+		{
+			for (uint32_t i = 0; i < CHORUS_LANES; i++)
+			{
+				laneOutLeft[i] = dryGain*voiceLeft[i];
+				laneOutRight[i] = dryGain*voiceRight[i];
+			}
+			return;
+		}
+
+		// --- write row runs downwards, so a read is writeRow + delay with no wrap inside the interpolation
+		writeRow = (writeRow - 1) & rowMask;
+		double* row = &line[writeRow*CHORUS_LANES];
+		double* guard = &line[rows*CHORUS_LANES];
+		for (uint32_t i = 0; i < CHORUS_LANES; i++)
+		{
+			double xn = 0.5*(voiceLeft[i] + voiceRight[i]);
+			row[i] = xn;
+			if (writeRow == 0)
+				guard[i] = xn;
+		}
+
+		for (uint32_t i = 0; i < CHORUS_LANES; i++)
+		{
+			double delayLeft = centreDelay_Samples + delayRange_Samples*lfoValue(lfoPhase + lanePhaseLeft[i]);
+			double delayRight = centreDelay_Samples + delayRange_Samples*lfoValue(lfoPhase + lanePhaseRight[i]);
+
+			uint32_t intLeft = (uint32_t)delayLeft;
+			uint32_t intRight = (uint32_t)delayRight;
+			double fracLeft = delayLeft - (double)intLeft;
+			double fracRight = delayRight - (double)intRight;
+
+			const double* tapLeft = &line[((writeRow + intLeft) & rowMask)*CHORUS_LANES + i];
+			const double* tapRight = &line[((writeRow + intRight) & rowMask)*CHORUS_LANES + i];
+
+			double yLeft = fracLeft*tapLeft[CHORUS_LANES] + (1.0 - fracLeft)*tapLeft[0];
+			double yRight = fracRight*tapRight[CHORUS_LANES] + (1.0 - fracRight)*tapRight[0];
+
+			laneOutLeft[i] = dryGain*voiceLeft[i] + wetGain*yLeft;
+			laneOutRight[i] = dryGain*voiceRight[i] + wetGain*yRight;
+		}
+
+		lfoPhase += lfoPhaseInc;
+		if (lfoPhase >= 1.0)
+			lfoPhase -= 1.0;
+	}
+};
+
+#endif /* defined(__voiceChorus_h__) */
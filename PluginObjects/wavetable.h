@@ -4,6 +4,8 @@
 #include <sstream>
 #include <stdint.h>
 #include <fstream>
+#include <vector>
+#include <chrono>
 
 // --- constants
 const uint32_t MAX_WAVE_TABLES = 128;
@@ -12,6 +14,99 @@ const uint32_t kDefaultWaveTableLength = 256;
 enum wtDataType { decimal, hex, encrypted_hex };
 enum wtTableInterval { highRes, min3rd, octave };
 enum wtTableType { kSingleTable, kMultiTable, kHiResWTSet, kUninitialized };
+enum wtInterpolation { linear, hermite, lagrange4, windowedSinc };
+
+// --- one line of the interpolation benchmark (see WaveTableBank::benchmarkInterpolation)
+struct InterpolationBenchmark
+{
+	uint32_t interpolation = wtInterpolation::linear;
+	double snr_dB = 0.0;		// --- vs. the ideal band-limited reading of the table
+	double nsPerRead = 0.0;		// --- average cost of one readWaveTable( )
+};
+
+// --- windowed sinc kernel size and resolution
+const uint32_t kWTSincTaps = 8;
+const uint32_t kWTSincPhases = 512;
+
+// --- 4-point, 3rd order Hermite (Catmull-Rom); taps are y[-1], y[0], y[1], y[2]
+inline double doHermiteInterpolation(const double* y, double frac)
+{
+	double c0 = y[1];
+	double c1 = 0.5*(y[2] - y[0]);
+	double c2 = y[0] - 2.5*y[1] + 2.0*y[2] - 0.5*y[3];
+	double c3 = 0.5*(y[3] - y[0]) + 1.5*(y[1] - y[2]);
+	return ((c3*frac + c2)*frac + c1)*frac + c0;
+}
+
+// --- 4-point Lagrange, closed form of doLagrangeInterpolation( ) for x = {-1, 0, 1, 2}
+inline double doLagrange4Interpolation(const double* y, double frac)
+{
+	double dm1 = frac + 1.0;
+	double d0 = frac;
+	double d1 = frac - 1.0;
+	double d2 = frac - 2.0;
+
+	return -y[0] * (d0*d1*d2) / 6.0
+		+ y[1] * (dm1*d1*d2) / 2.0
+		- y[2] * (dm1*d0*d2) / 2.0
+		+ y[3] * (dm1*d0*d1) / 6.0;
+}
+
+// --- Blackman windowed sinc, 8 taps: y[-3] ... y[4]
+//     coefficients are stored per fractional phase (+1 guard row) and interpolated between rows
+struct WindowedSincKernel
+{
+	WindowedSincKernel()
+	{
+		for (uint32_t p = 0; p <= kWTSincPhases; p++)
+		{
+			double frac = (double)p / (double)kWTSincPhases;
+			double sum = 0.0;
+			for (uint32_t t = 0; t < kWTSincTaps; t++)
+			{
+				// --- distance from the tap to the read point
+				double x = (double)t - (double)(kWTSincTaps / 2 - 1) - frac;
+				double sinc = x == 0.0 ? 1.0 : sin(kPi*x) / (kPi*x);
+
+				// --- window spans the kernel centered on the read point
+				double n = (x + (double)kWTSincTaps / 2.0) / (double)kWTSincTaps;
+				double window = 0.42 - 0.5*cos(2.0*kPi*n) + 0.08*cos(4.0*kPi*n);
+
+				coeffs[p][t] = sinc*window;
+				sum += coeffs[p][t];
+			}
+
+			// --- unity DC gain
+			for (uint32_t t = 0; t < kWTSincTaps; t++)
+				coeffs[p][t] /= sum;
+		}
+	}
+
+	inline double interpolate(const double* y, double frac)
+	{
+		double phase = frac*kWTSincPhases;
+		uint32_t row = (uint32_t)phase;
+		double rowFrac = phase - row;
+
+		const double* c0 = coeffs[row];
+		const double* c1 = coeffs[row + 1];
+
+		double output = 0.0;
+		for (uint32_t t = 0; t < kWTSincTaps; t++)
+			output += y[t] * (c0[t] + rowFrac*(c1[t] - c0[t]));
+
+		return output;
+	}
+
+	double coeffs[kWTSincPhases + 1][kWTSincTaps];
+};
+
+// --- one shared kernel for all tables
+inline WindowedSincKernel& getWindowedSincKernel()
+{
+	static WindowedSincKernel kernel;
+	return kernel;
+}
 
 // --- 1024 point sinusoid table; burned into ROM here: ------------- >>>
 static double sin_n1024[1024] = { 0.00000000000000000000000000000000, 0.00613588464915447526909497710790, 0.01227153828571992538742918554817, 0.01840672990580482018541097488651, 0.02454122852291228812360301958506, 0.03067480317663662595095708240933, 0.03680722294135883171373180289265, 0.04293825693494082024193048141569, 0.04906767432741801493456534899451, 0.05519524434968993420458360787961, 0.06132073630220857829442593356362, 0.06744391956366405094236426975840, 0.07356456359966742630795977220259, 0.07968243797143012563388708713319, 0.08579731234443989384974571521525, 0.09190895649713272386183149365024, 0.09801714032956060362877792613290, 0.10412163387205458642270627933613, 0.11022220729388305937579417559391, 0.11631863091190475234526502390509, 0.12241067519921619566325432515441, 0.12849811079379316880455519367388, 0.13458070850712616772781871077314, 0.14065823933284921087860652733070, 0.14673047445536174793190298260015, 0.15279718525844343535169400638551, 0.15885814333386144570070541703899, 0.16491312048996989436666638084716, 0.17096188876030121717164433903235, 0.17700422041214874946390978038835, 0.18303988795514095078154070961318, 0.18906866414980619262031780181132, 0.19509032201612824808378832130984, 0.20110463484209190054841087658133, 0.20711137619221856032147854875802, 0.21311031991609136193588369678764, 0.21910124015686979759287567048887, 0.22508391135979283204093803760770, 0.23105810828067110951344886871084, 0.23702360599436719801325068601727, 0.24298017990326387094413007616822, 0.24892760574572014853345081064617, 0.25486565960451457169000377689372, 0.26079411791527551400804441072978, 0.26671275747489836538406393628975, 0.27262135544994897662363086965343, 0.27851968938505305972697101424274, 0.28440753721127187692019333553617, 0.29028467725446233105301985233382, 0.29615088824362378883137125740177, 0.30200594931922808417112946699490, 0.30784964004153486660797511831333, 0.31368174039889151760718277728301, 0.31950203081601569188308076263638, 0.32531029216226292621882976163761, 0.33110630575987642920665621204535, 0.33688985339222005110926261295390, 0.34266071731199437833126353325497, 0.34841868024943456472186653627432, 0.35416352542049034379800787064596, 0.35989503653498811086564046490821, 0.36561299780477385379384713814943, 0.37131719395183754306444257053954, 0.37700741021641825945209802739555, 0.38268343236508978177923268049199, 0.38834504669882624616761290781142, 0.39399204006104809883126449676638, 0.39962419984564678809846327567357, 0.40524131400498986099734111121506, 0.41084317105790391089215063402662, 0.41642956009763715252702809266339, 0.42200027079979968158696124191920, 0.42755509343028208490977704059333, 0.43309381885315195725993930864206, 0.43861623853852765853034156862122, 0.44412214457042920034979260890395, 0.44961132965460653965195092496288, 0.45508358712634383591577602601319, 0.46053871095824000514440399456362, 0.46597649576796618120511084271129, 0.47139673682599764203970948983624, 0.47679923006332208812452222446154, 0.48218377207912271886769417506002, 0.48755016014843599592154532729182, 0.49289819222978403789880985641503, 0.49822766697278186853736769990064, 0.50353838372571757542317527622799, 0.50883014254310698909478105633752, 0.51410274419322166128409890006878, 0.51935599016558964269307807626319, 0.52458968267846894928396750401589, 0.52980362468629460526159391520196, 0.53499761988709715332390715047950, 0.54017147272989285422539751380100, 0.54532498842204646383180488555809, 0.55045797293660481130928019410931, 0.55557023301960217764872140833177, 0.56066157619733603123535203849315, 0.56573181078361312046354214544408, 0.57078074588696725566450140831876, 0.57580819141784533865546791275847, 0.58081395809576452649025668506511, 0.58579785745643886407663103454979, 0.59075970185887416441516961640446, 0.59569930449243335690567846540944, 0.60061647938386897305207412500749, 0.60551104140432554512329943463556, 0.61038280627630947527961779996986, 0.61523159058062681925349579614704, 0.62005721176328909560737656647689, 0.62485948814238634341222677903716, 0.62963823891492698425764729108778, 0.63439328416364548779426968394546, 0.63912444486377573138469188052113, 0.64383154288979138613058239570819, 0.64851440102211244109753351949621, 0.65317284295377675551463880765368, 0.65780669329707863735023920526146, 0.66241577759017178372857870272128, 0.66699992230363747136578922436456, 0.67155895484701833009211213720846, 0.67609270357531592310351697960868, 0.68060099779545302212113710993435, 0.68508366777270035541391735023353, 0.68954054473706682948375146224862, 0.69397146088965400156922669339110, 0.69837624940897291558883352990961, 0.70275474445722529992508498253301, 0.70710678118654746171500846685376, 0.71143219574521643355780042838887, 0.71573082528381859468424863734981, 0.72000250796138165476634185324656, 0.72424708295146689174259790888755, 0.72846439044822519637278901427635, 0.73265427167241281569687316732598, 0.73681656887736979300029815931339, 0.74095112535495910588423384979251, 0.74505778544146594732922039838741, 0.74913639452345925917597924126312, 0.75318679904361240939891786183580, 0.75720884650648445646226036842563, 0.76120238548426177871419895382132, 0.76516726562245895859604161159950, 0.76910333764557958780017088429304, 0.77301045336273699337681364340824, 0.77688846567323244229896772594657, 0.78073722857209437719916422793176, 0.78455659715557524158668911695713, 0.78834642762660622761217155129998, 0.79210657730021238887019308094750, 0.79583690460888345530321430487675, 0.79953726910790501314352241024608, 0.80320753148064483184498385526240, 0.80684755354379922298591054641292, 0.81045719825259476820633608440403, 0.81403632970594830275956610421417, 0.81758481315158371138807069655741, 0.82110251499110464834529921063222, 0.82458930278502529098716422595317, 0.82804504525775579626412081779563, 0.83146961230254523567140267914510, 0.83486287498638001025597077386919, 0.83822470555483796772477944614366, 0.84155497743689833267666244864813, 0.84485356524970700586862903946894, 0.84812034480329712149426768519334, 0.85135519310526519554116475774208, 0.85455798836540053375898651211173, 0.85772861000027211808571792062139, 0.86086693863776730939463277536561, 0.86397285612158669643179109698394, 0.86704624551569264845340967440279, 0.87008699110871134951850081051816, 0.87309497841829009079361867406988, 0.87607009419540660122294184475322, 0.87901222642863341416585853949073, 0.88192126434835493853370280703530, 0.88479709843093778953715400348301, 0.88763962040285393495508969863295, 0.89044872324475787817021910086623, 0.89322430119551532445854036268429, 0.89596624975618510688946116715670, 0.89867446569395381672507028270047, 0.90134884704602202809553546103416, 0.90398929312344333819595476597897, 0.90659570451491533482624163298169, 0.90916798309052226922943873432814, 0.91170603200542987831767050010967, 0.91420975570353069095119735720800, 0.91667905992104270485043571170536, 0.91911385169005777040496241170331, 0.92151403934204190182555294086342, 0.92387953251128673848313610506011, 0.92621024213831126825624551202054, 0.92850608047321547822150478168624, 0.93076696107898371224109723698348, 0.93299279883473884567024470015895, 0.93518350993894749922930031971191, 0.93733901191257495977282587773516, 0.93945922360218991897795604018029, 0.94154406518302080630888895029784, 0.94359345816196038558842928978265, 0.94560732538052127971184290800011, 0.94758559101774109123539346910547, 0.94952818059303667475035126699368, 0.95143502096900833819859144568909, 0.95330604035419375108517670014407, 0.95514116830577067140950475732097, 0.95694033573220893540423048762023, 0.95870347489587159905966018413892, 0.96043051941556578654513032233808, 0.96212140426904158019283386238385, 0.96377606579543984022251379428781, 0.96539444169768939829623377590906, 0.96697647104485207059099138859892, 0.96852209427441726674601341073867, 0.97003125319454397423868385885726, 0.97150389098625178352364173406386, 0.97293995220556006575662877366995, 0.97433938278557585821459952057921, 0.97570213003852857003295184767921, 0.97702814265775439483974196264171, 0.97831737071962765472932233024039, 0.97956976568544051886533452488948, 0.98078528040323043057924223830923, 0.98196386910955524296440444231848, 0.98310548743121628501029363178532, 0.98421009238692902520995176018914, 0.98527764238894122161838140527834, 0.98630809724459866938417462733923, 0.98730141815785843473207705756067, 0.98825756773074946437418475397862, 0.98917650996478101443898367506335, 0.99005821026229712256139237069874, 0.99090263542778000971367191596073, 0.99170975366909952519733906228794, 0.99247953459870996706371215623221, 0.99321194923479450000769475082052, 0.99390697000235606051177228437155, 0.99456457073425541537403660186101, 0.99518472667219681770944816889823, 0.99576741446765981713440396561055, 0.99631261218277800129072829804500, 0.99682029929116566790980868972838, 0.99729045667869020697082760307239, 0.99772306664419163624302200332750, 0.99811811290014917918966830256977, 0.99847558057329477421149022120517, 0.99879545620517240500646494183457, 0.99907772775264536146977434327709, 0.99932238458834954375475945198559, 0.99952941750109314256178549840115, 0.99969881869620424996725205346593, 0.99983058179582340319058175737155, 0.99992470183914450299056397852837, 0.99998117528260110908888691483298, 1.00000000000000000000000000000000, 0.99998117528260110908888691483298, 0.99992470183914450299056397852837, 0.99983058179582340319058175737155, 0.99969881869620424996725205346593, 0.99952941750109314256178549840115, 0.99932238458834954375475945198559, 0.99907772775264536146977434327709, 0.99879545620517240500646494183457, 0.99847558057329477421149022120517, 0.99811811290014917918966830256977, 0.99772306664419163624302200332750, 0.99729045667869020697082760307239, 0.99682029929116577893211115224403, 0.99631261218277800129072829804500, 0.99576741446765981713440396561055, 0.99518472667219692873175063141389, 0.99456457073425541537403660186101, 0.99390697000235606051177228437155, 0.99321194923479450000769475082052, 0.99247953459870996706371215623221, 0.99170975366909952519733906228794, 0.99090263542778000971367191596073, 0.99005821026229712256139237069874, 0.98917650996478101443898367506335, 0.98825756773074946437418475397862, 0.98730141815785843473207705756067, 0.98630809724459866938417462733923, 0.98527764238894122161838140527834, 0.98421009238692902520995176018914, 0.98310548743121628501029363178532, 0.98196386910955524296440444231848, 0.98078528040323043057924223830923, 0.97956976568544051886533452488948, 0.97831737071962765472932233024039, 0.97702814265775439483974196264171, 0.97570213003852857003295184767921, 0.97433938278557585821459952057921, 0.97293995220556017677893123618560, 0.97150389098625178352364173406386, 0.97003125319454397423868385885726, 0.96852209427441737776831587325432, 0.96697647104485207059099138859892, 0.96539444169768939829623377590906, 0.96377606579543984022251379428781, 0.96212140426904158019283386238385, 0.96043051941556589756743278485374, 0.95870347489587159905966018413892, 0.95694033573220893540423048762023, 0.95514116830577067140950475732097, 0.95330604035419386210747916265973, 0.95143502096900833819859144568909, 0.94952818059303667475035126699368, 0.94758559101774120225769593162113, 0.94560732538052139073414537051576, 0.94359345816196038558842928978265, 0.94154406518302080630888895029784, 0.93945922360218991897795604018029, 0.93733901191257495977282587773516, 0.93518350993894761025160278222756, 0.93299279883473884567024470015895, 0.93076696107898371224109723698348, 0.92850608047321558924380724420189, 0.92621024213831137927854797453620, 0.92387953251128673848313610506011, 0.92151403934204201284785540337907, 0.91911385169005777040496241170331, 0.91667905992104270485043571170536, 0.91420975570353069095119735720800, 0.91170603200542987831767050010967, 0.90916798309052249127404365935945, 0.90659570451491533482624163298169, 0.90398929312344344921825722849462, 0.90134884704602202809553546103416, 0.89867446569395392774737274521613, 0.89596624975618521791176362967235, 0.89322430119551521343623790016863, 0.89044872324475798919252156338189, 0.88763962040285393495508969863295, 0.88479709843093790055945646599866, 0.88192126434835504955600526955095, 0.87901222642863352518816100200638, 0.87607009419540660122294184475322, 0.87309497841829020181592113658553, 0.87008699110871146054080327303382, 0.86704624551569275947571213691845, 0.86397285612158680745409355949960, 0.86086693863776719837233031284995, 0.85772861000027211808571792062139, 0.85455798836540053375898651211173, 0.85135519310526519554116475774208, 0.84812034480329723251657014770899, 0.84485356524970722791323396450025, 0.84155497743689844369896491116378, 0.83822470555483818976938437117497, 0.83486287498638012127827323638485, 0.83146961230254545771600760417641, 0.82804504525775579626412081779563, 0.82458930278502517996486176343751, 0.82110251499110475936760167314787, 0.81758481315158371138807069655741, 0.81403632970594852480417102924548, 0.81045719825259476820633608440403, 0.80684755354379944503051547144423, 0.80320753148064494286728631777805, 0.79953726910790523518812733527739, 0.79583690460888356632551676739240, 0.79210657730021227784789061843185, 0.78834642762660633863447401381563, 0.78455659715557513056438665444148, 0.78073722857209459924376915296307, 0.77688846567323244229896772594657, 0.77301045336273710439911610592389, 0.76910333764557958780017088429304, 0.76516726562245906961834407411516, 0.76120238548426188973650141633698, 0.75720884650648467850686529345694, 0.75318679904361252042122032435145, 0.74913639452345925917597924126312, 0.74505778544146605835152286090306, 0.74095112535495899486193138727685, 0.73681656887737001504490308434470, 0.73265427167241281569687316732598, 0.72846439044822530739509147679200, 0.72424708295146689174259790888755, 0.72000250796138176578864431576221, 0.71573082528381870570655109986546, 0.71143219574521665560240535342018, 0.70710678118654757273731092936941, 0.70275474445722518890278252001735, 0.69837624940897291558883352990961, 0.69397146088965400156922669339110, 0.68954054473706705152835638727993, 0.68508366777270035541391735023353, 0.68060099779545324416574203496566, 0.67609270357531592310351697960868, 0.67155895484701855213671706223977, 0.66699992230363758238809168688022, 0.66241577759017200577318362775259, 0.65780669329707874837254166777711, 0.65317284295377664449233634513803, 0.64851440102211255211983598201186, 0.64383154288979138613058239570819, 0.63912444486377584240699434303679, 0.63439328416364548779426968394546, 0.62963823891492720630225221611909, 0.62485948814238634341222677903716, 0.62005721176328942867428395402385, 0.61523159058062693027579825866269, 0.61038280627630969732422272500116, 0.60551104140432565614560189715121, 0.60061647938386886202977166249184, 0.59569930449243346792798092792509, 0.59075970185887416441516961640446, 0.58579785745643897509893349706545, 0.58081395809576452649025668506511, 0.57580819141784544967777037527412, 0.57078074588696725566450140831876, 0.56573181078361345353044953299104, 0.56066157619733614225765450100880, 0.55557023301960217764872140833177, 0.55045797293660492233158265662496, 0.54532498842204635280950242304243, 0.54017147272989296524769997631665, 0.53499761988709715332390715047950, 0.52980362468629482730619884023326, 0.52458968267846894928396750401589, 0.51935599016558975371538053877885, 0.51410274419322177230640136258444, 0.50883014254310732216168844388449, 0.50353838372571768644547773874365, 0.49822766697278175751506523738499, 0.49289819222978414892111231893068, 0.48755016014843588489924286477617, 0.48218377207912288540114786883350, 0.47679923006332208812452222446154, 0.47139673682599786408431441486755, 0.46597649576796618120511084271129, 0.46053871095824022718900891959493, 0.45508358712634389142692725727102, 0.44961132965460687271885831250984, 0.44412214457042931137209507141961, 0.43861623853852754750803910610557, 0.43309381885315206828224177115771, 0.42755509343028202939862580933550, 0.42200027079979984812041493569268, 0.41642956009763715252702809266339, 0.41084317105790413293675555905793, 0.40524131400498991650849234247289, 0.39962419984564706565421943196270, 0.39399204006104815434241572802421, 0.38834504669882657923452029535838, 0.38268343236508989280153514300764, 0.37700741021641814842979556487990, 0.37131719395183770959789626431302, 0.36561299780477379828269590689160, 0.35989503653498833291024538993952, 0.35416352542049039930915910190379, 0.34841868024943478676647146130563, 0.34266071731199443384241476451280, 0.33688985339222032866501876924303, 0.33110630575987648471780744330317, 0.32531029216226325928573714918457, 0.31950203081601580290538322515204, 0.31368174039889140658488031476736, 0.30784964004153503314142881208682, 0.30200594931922802865997823573707, 0.29615088824362401087597618243308, 0.29028467725446238656417108359165, 0.28440753721127209896479826056748, 0.27851968938505317074927347675839, 0.27262135544994925417938702594256, 0.26671275747489847640636639880540, 0.26079411791527584707495179827674, 0.25486565960451468271230623940937, 0.24892760574572009302229957938835, 0.24298017990326406523315938557062, 0.23702360599436717025767507038836, 0.23105810828067133155805379374215, 0.22508391135979283204093803760770, 0.21910124015687004739305621114909, 0.21311031991609141744703492804547, 0.20711137619221883787723470504716, 0.20110463484209201157071333909698, 0.19509032201612860890627132448572, 0.18906866414980635915377149558481, 0.18303988795514089527038947835536, 0.17700422041214894375293908979074, 0.17096188876030121717164433903235, 0.16491312048997014416684692150739, 0.15885814333386147345628103266790, 0.15279718525844368515187454704574, 0.14673047445536180344305421385798, 0.14065823933284954394551391487767, 0.13458070850712627875012117328879, 0.12849811079379308553782834678714, 0.12241067519921634831892021111344, 0.11631863091190471071190160046172, 0.11022220729388323978703567718185, 0.10412163387205457254491847152167, 0.09801714032956082567338285116421, 0.09190895649713275161740710927916, 0.08579731234444015752771406368993, 0.07968243797143019502282612620547, 0.07356456359966773161929154412064, 0.06744391956366417584245454008851, 0.06132073630220848808880518276965, 0.05519524434969009379914339774587, 0.04906767432741796636230802164391, 0.04293825693494102146985369472532, 0.03680722294135883171373180289265, 0.03067480317663686534279676720871, 0.02454122852291232628751949107482, 0.01840672990580510121061408312926, 0.01227153828572000691943255645810, 0.00613588464915479879502324678242, 0.00000000000000012246467991473532, -0.00613588464915455419901313405262, -0.01227153828571976232342244372830, -0.01840672990580485834932744637626, -0.02454122852291207995678590236821, -0.03067480317663661901206317850210, -0.03680722294135858191355126223243, -0.04293825693494077860856705797232, -0.04906767432741772350102138489092, -0.05519524434968985093785676099287, -0.06132073630220824522751854601665, -0.06744391956366392604227399942829, -0.07356456359966749569689881127488, -0.07968243797142994522264558554525, -0.08579731234443992160532133084416, -0.09190895649713251569501437643339, -0.09801714032956058975099011831844, -0.10412163387205432274473793086145, -0.11022220729388300386464294433608, -0.11631863091190447478950886761595, -0.12241067519921609851873967045321, -0.12849811079379283573764780612692, -0.13458070850712605670551624825748, -0.14065823933284929414533337421744, -0.14673047445536158139844928882667, -0.15279718525844343535169400638551, -0.15885814333386122365610049200768, -0.16491312048996989436666638084716, -0.17096188876030096737146379837213, -0.17700422041214869395275854913052, -0.18303988795514064547020893769513, -0.18906866414980610935359095492458, -0.19509032201612835910609078382549, -0.20110463484209176177053279843676, -0.20711137619221858807705416438694, -0.21311031991609119540243000301416, -0.21910124015686979759287567048887, -0.22508391135979260999633311257639, -0.23105810828067108175787325308193, -0.23702360599436694821307014535705, -0.24298017990326381543297884491039, -0.24892760574571987097769465435704, -0.25486565960451446066770131437806, -0.26079411791527562503034687324543, -0.26671275747489825436176147377410, -0.27262135544994903213478210091125, -0.27851968938505289319351732046925, -0.28440753721127182140904210427834, -0.29028467725446210900841492730251, -0.29615088824362378883137125740177, -0.30200594931922780661537331070576, -0.30784964004153481109682388705551, -0.31368174039889118454027538973605, -0.31950203081601558086077830012073, -0.32531029216226298172998099289543, -0.33110630575987626267320251827186, -0.33688985339222010662041384421173, -0.34266071731199421179780983948149, -0.34841868024943456472186653627432, -0.35416352542049012175340294561465, -0.35989503653498811086564046490821, -0.36561299780477357623809098186030, -0.37131719395183743204214010802389, -0.37700741021641792638519063984859, -0.38268343236508967075693021797633, -0.38834504669882635718991537032707, -0.39399204006104793229781080299290, -0.39962419984564684360961450693139, -0.40524131400498969446388741744158, -0.41084317105790391089215063402662, -0.41642956009763693048242316763208, -0.42200027079979962607581001066137, -0.42755509343028180735402088430419, -0.43309381885315184623763684612641, -0.43861623853852732546343418107426, -0.44412214457042908932749014638830, -0.44961132965460665067425338747853, -0.45508358712634366938232233223971, -0.46053871095824006065555522582144, -0.46597649576796595916050591767998, -0.47139673682599764203970948983624, -0.47679923006332186607991729943024, -0.48218377207912266335654294380220, -0.48755016014843566285463793974486, -0.49289819222978392687650739389937, -0.49822766697278153547046031235368, -0.50353838372571746440087281371234, -0.50883014254310710011708351885318, -0.51410274419322155026179643755313, -0.51935599016558964269307807626319, -0.52458968267846872723936257898458, -0.52980362468629460526159391520196, -0.53499761988709693127930222544819, -0.54017147272989285422539751380100, -0.54532498842204613076489749801112, -0.55045797293660470028697773159365, -0.55557023301960195560411648330046, -0.56066157619733592021304957597749, -0.56573181078361323148584460795973, -0.57078074588696714464219894580310, -0.57580819141784533865546791275847, -0.58081395809576430444565176003380, -0.58579785745643886407663103454979, -0.59075970185887394237056469137315, -0.59569930449243324588337600289378, -0.60061647938386863998516673746053, -0.60551104140432543410099697211990, -0.61038280627630947527961779996986, -0.61523159058062670823119333363138, -0.62005721176328920662967902899254, -0.62485948814238623238992431652150, -0.62963823891492698425764729108778, -0.63439328416364526574966475891415, -0.63912444486377573138469188052113, -0.64383154288979127510827993319253, -0.64851440102211233007523105698056, -0.65317284295377653347003388262237, -0.65780669329707852632793674274581, -0.66241577759017178372857870272128, -0.66699992230363736034348676184891, -0.67155895484701844111441459972411, -0.67609270357531581208121451709303, -0.68060099779545302212113710993435, -0.68508366777270013336931242520222, -0.68954054473706682948375146224862, -0.69397146088965377952462176835979, -0.69837624940897280456653106739395, -0.70275474445722507788048005750170, -0.70710678118654746171500846685376, -0.71143219574521643355780042838887, -0.71573082528381848366194617483416, -0.72000250796138165476634185324656, -0.72424708295146678072029544637189, -0.72846439044822519637278901427635, -0.73265427167241259365226824229467, -0.73681656887736979300029815931339, -0.74095112535495888383962892476120, -0.74505778544146583630691793587175, -0.74913639452345903713137431623181, -0.75318679904361240939891786183580, -0.75720884650648423441765544339432, -0.76120238548426200075880387885263, -0.76516726562245895859604161159950, -0.76910333764557947677786842177738, -0.77301045336273666030990625586128, -0.77688846567323255332127018846222, -0.78073722857209437719916422793176, -0.78455659715557501954208419192582, -0.78834642762660589454526416375302, -0.79210657730021238887019308094750, -0.79583690460888345530321430487675, -0.79953726910790479109891748521477, -0.80320753148064505388958878029371, -0.80684755354379922298591054641292, -0.81045719825259465718403362188837, -0.81403632970594808071496117918286, -0.81758481315158382241037315907306, -0.82110251499110464834529921063222, -0.82458930278502506894255930092186, -0.82804504525775546319721343024867, -0.83146961230254523567140267914510, -0.83486287498638001025597077386919, -0.83822470555483785670247698362800, -0.84155497743689855472126737367944, -0.84485356524970700586862903946894, -0.84812034480329712149426768519334, -0.85135519310526486247425737019512, -0.85455798836540064478128897462739, -0.85772861000027200706341545810574, -0.86086693863776708735002785033430, -0.86397285612158647438718617195264, -0.86704624551569264845340967440279, -0.87008699110871134951850081051816, -0.87309497841828986874901374903857, -0.87607009419540671224524430726888, -0.87901222642863341416585853949073, -0.88192126434835493853370280703530, -0.88479709843093756749254907845170, -0.88763962040285404597739216114860, -0.89044872324475787817021910086623, -0.89322430119551521343623790016863, -0.89596624975618488484485624212539, -0.89867446569395381672507028270047, -0.90134884704602191707323299851851, -0.90398929312344311615134984094766, -0.90659570451491544584854409549735, -0.90916798309052238025174119684380, -0.91170603200542976729536803759402, -0.91420975570353046890659243217669, -0.91667905992104270485043571170536, -0.91911385169005765938265994918766, -0.92151403934204179080325047834776, -0.92387953251128651643853118002880, -0.92621024213831137927854797453620, -0.92850608047321547822150478168624, -0.93076696107898360121879477446782, -0.93299279883473895669254716267460, -0.93518350993894761025160278222756, -0.93733901191257484875052341521950, -0.93945922360218969693335111514898, -0.94154406518302080630888895029784, -0.94359345816196027456612682726700, -0.94560732538052116868954044548445, -0.94758559101774120225769593162113, -0.94952818059303667475035126699368, -0.95143502096900833819859144568909, -0.95330604035419375108517670014407, -0.95514116830577078243180721983663, -0.95694033573220882438192802510457, -0.95870347489587148803735772162327, -0.96043051941556567552282785982243, -0.96212140426904158019283386238385, -0.96377606579543984022251379428781, -0.96539444169768928727393131339340, -0.96697647104485218161329385111458, -0.96852209427441726674601341073867, -0.97003125319454397423868385885726, -0.97150389098625167250133927154820, -0.97293995220556017677893123618560, -0.97433938278557585821459952057921, -0.97570213003852845901064938516356, -0.97702814265775428381743950012606, -0.97831737071962765472932233024039, -0.97956976568544051886533452488948, -0.98078528040323031955693977579358, -0.98196386910955535398670690483414, -0.98310548743121628501029363178532, -0.98421009238692902520995176018914, -0.98527764238894111059607894276269, -0.98630809724459866938417462733923, -0.98730141815785832370977459504502, -0.98825756773074946437418475397862, -0.98917650996478090341668121254770, -0.99005821026229712256139237069874, -0.99090263542778000971367191596073, -0.99170975366909952519733906228794, -0.99247953459871007808601461874787, -0.99321194923479450000769475082052, -0.99390697000235606051177228437155, -0.99456457073425541537403660186101, -0.99518472667219692873175063141389, -0.99576741446765981713440396561055, -0.99631261218277800129072829804500, -0.99682029929116566790980868972838, -0.99729045667869020697082760307239, -0.99772306664419163624302200332750, -0.99811811290014917918966830256977, -0.99847558057329477421149022120517, -0.99879545620517240500646494183457, -0.99907772775264536146977434327709, -0.99932238458834943273245698946994, -0.99952941750109314256178549840115, -0.99969881869620424996725205346593, -0.99983058179582340319058175737155, -0.99992470183914450299056397852837, -0.99998117528260110908888691483298, -1.00000000000000000000000000000000, -0.99998117528260110908888691483298, -0.99992470183914450299056397852837, -0.99983058179582340319058175737155, -0.99969881869620424996725205346593, -0.99952941750109314256178549840115, -0.99932238458834954375475945198559, -0.99907772775264536146977434327709, -0.99879545620517240500646494183457, -0.99847558057329477421149022120517, -0.99811811290014917918966830256977, -0.99772306664419163624302200332750, -0.99729045667869020697082760307239, -0.99682029929116566790980868972838, -0.99631261218277800129072829804500, -0.99576741446765981713440396561055, -0.99518472667219692873175063141389, -0.99456457073425541537403660186101, -0.99390697000235606051177228437155, -0.99321194923479461102999721333617, -0.99247953459871007808601461874787, -0.99170975366909952519733906228794, -0.99090263542778000971367191596073, -0.99005821026229712256139237069874, -0.98917650996478090341668121254770, -0.98825756773074946437418475397862, -0.98730141815785843473207705756067, -0.98630809724459878040647708985489, -0.98527764238894122161838140527834, -0.98421009238692913623225422270480, -0.98310548743121639603259609430097, -0.98196386910955535398670690483414, -0.98078528040323043057924223830923, -0.97956976568544062988763698740513, -0.97831737071962776575162479275605, -0.97702814265775428381743950012606, -0.97570213003852857003295184767921, -0.97433938278557596923690198309487, -0.97293995220556028780123369870125, -0.97150389098625178352364173406386, -0.97003125319454397423868385885726, -0.96852209427441737776831587325432, -0.96697647104485229263559631363023, -0.96539444169768939829623377590906, -0.96377606579543995124481625680346, -0.96212140426904169121513632489950, -0.96043051941556578654513032233808, -0.95870347489587159905966018413892, -0.95694033573220893540423048762023, -0.95514116830577089345410968235228, -0.95330604035419386210747916265973, -0.95143502096900844922089390820474, -0.94952818059303678577265372950933, -0.94758559101774131327999839413678, -0.94560732538052127971184290800011, -0.94359345816196038558842928978265, -0.94154406518302091733119141281350, -0.93945922360218980795565357766463, -0.93733901191257495977282587773516, -0.93518350993894772127390524474322, -0.93299279883473906771484962519025, -0.93076696107898371224109723698348, -0.92850608047321558924380724420189, -0.92621024213831149030085043705185, -0.92387953251128662746083364254446, -0.92151403934204190182555294086342, -0.91911385169005788142726487421896, -0.91667905992104281587273817422101, -0.91420975570353057992889489469235, -0.91170603200542987831767050010967, -0.90916798309052249127404365935945, -0.90659570451491555687084655801300, -0.90398929312344333819595476597897, -0.90134884704602213911783792354981, -0.89867446569395403876967520773178, -0.89596624975618499586715870464104, -0.89322430119551532445854036268429, -0.89044872324475798919252156338189, -0.88763962040285415699969462366425, -0.88479709843093767851485154096736, -0.88192126434835504955600526955095, -0.87901222642863363621046346452204, -0.87607009419540693428984923230018, -0.87309497841829009079361867406988, -0.87008699110871146054080327303382, -0.86704624551569287049801459943410, -0.86397285612158658540948863446829, -0.86086693863776730939463277536561, -0.85772861000027222910802038313705, -0.85455798836540075580359143714304, -0.85135519310526508451886229522643, -0.84812034480329734353887261022464, -0.84485356524970722791323396450025, -0.84155497743689877676587229871075, -0.83822470555483796772477944614366, -0.83486287498638012127827323638485, -0.83146961230254545771600760417641, -0.82804504525775568524181835527997, -0.82458930278502529098716422595317, -0.82110251499110487038990413566353, -0.81758481315158404445497808410437, -0.81403632970594830275956610421417, -0.81045719825259487922863854691968, -0.80684755354379944503051547144423, -0.80320753148064527593419370532501, -0.79953726910790501314352241024608, -0.79583690460888367734781922990805, -0.79210657730021261091479800597881, -0.78834642762660611658986908878433, -0.78455659715557524158668911695713, -0.78073722857209459924376915296307, -0.77688846567323277536587511349353, -0.77301045336273688235451118089259, -0.76910333764557969882247334680869, -0.76516726562245918064064653663081, -0.76120238548426222280340880388394, -0.75720884650648456748456283094129, -0.75318679904361263144352278686711, -0.74913639452345959224288662881008, -0.74505778544146583630691793587175, -0.74095112535495910588423384979251, -0.73681656887737012606720554686035, -0.73265427167241314876378055487294, -0.72846439044822508535048655176070, -0.72424708295146700276490037140320, -0.72000250796138187681094677827787, -0.71573082528381903877345848741243, -0.71143219574521643355780042838887, -0.70710678118654768375961339188507, -0.70275474445722563299199237007997, -0.69837624940897269354422860487830, -0.69397146088965400156922669339110, -0.68954054473706716255065884979558, -0.68508366777270079950312720029615, -0.68060099779545302212113710993435, -0.67609270357531603412581944212434, -0.67155895484701866315901952475542, -0.66699992230363802647730153694283, -0.66241577759017178372857870272128, -0.65780669329707885939484413029277, -0.65317284295377708858154619520064, -0.64851440102211233007523105698056, -0.64383154288979149715288485822384, -0.63912444486377595342929680555244, -0.63439328416364593188347953400807, -0.62963823891492698425764729108778, -0.62485948814238645443452924155281, -0.62005721176328953969658641653950, -0.61523159058062737436500810872531, -0.61038280627630947527961779996986, -0.60551104140432565614560189715121, -0.60061647938386930611898151255446, -0.59569930449243324588337600289378, -0.59075970185887427543747207892011, -0.58579785745643908612123595958110, -0.58081395809576497057946653512772, -0.57580819141784522763316545024281, -0.57078074588696736668680387083441, -0.56573181078361356455275199550670, -0.56066157619733658634686435107142, -0.55557023301960217764872140833177, -0.55045797293660503335388511914061, -0.54532498842204679689871227310505, -0.54017147272989274320309505128535, -0.53499761988709726434620961299515, -0.52980362468629493832850130274892, -0.52458968267846939337317735407851, -0.51935599016558953167077561374754, -0.51410274419322188332870382510009, -0.50883014254310743318399090640014, -0.50353838372571813053468758880626, -0.49822766697278186853736769990064, -0.49289819222978425994341478144634, -0.48755016014843638449960394609661, -0.48218377207912260784539171254437, -0.47679923006332219914682468697720, -0.47139673682599791959546564612538, -0.46597649576796668080547192403174, -0.46053871095823994963325276330579, -0.45508358712634400244922971978667, -0.44961132965460698374116077502549, -0.44412214457042981097245615274005, -0.43861623853852765853034156862122, -0.43309381885315217930454423367337, -0.42755509343028252899898689065594, -0.42200027079979957056465877940354, -0.41642956009763726354933055517904, -0.41084317105790424395905802157358, -0.40524131400499041610885342379333, -0.39962419984564678809846327567357, -0.39399204006104826536471819053986, -0.38834504669882669025682275787403, -0.38268343236509039240189622432808, -0.37700741021641825945209802739555, -0.37131719395183782062019872682868, -0.36561299780477435339420821946987, -0.35989503653498799984333800239256, -0.35416352542049051033146156441944, -0.34841868024943489778877392382128, -0.34266071731199493344277584583324, -0.33688985339221999559811138169607, -0.33110630575987659574010990581883, -0.32531029216226337030803961170022, -0.31950203081601546983847583760507, -0.31368174039889151760718277728301, -0.30784964004153514416373127460247, -0.30200594931922858377149054831534, -0.29615088824362373332022002614394, -0.29028467725446249758647354610730, -0.28440753721127220998710072308313, -0.27851968938505367034963455807883, -0.27262135544994897662363086965343, -0.26671275747489858742866886132106, -0.26079411791527595809725426079240, -0.25486565960451440515655008312024, -0.24892760574572020404460204190400, -0.24298017990326417625546184808627, -0.23702360599436772536918738296663, -0.23105810828067099849114640619518, -0.22508391135979297081881611575227, -0.21910124015687015841535867366474, -0.21311031991609197255854724062374, -0.20711137619221853256590293312911, -0.20110463484209212259301580161264, -0.19509032201612871992857378700137, -0.18906866414980602608686410803784, -0.18303988795514100629269194087101, -0.17700422041214905477524155230640, -0.17096188876030177228315665161062, -0.16491312048996981109993953396042, -0.15885814333386158447858349518356, -0.15279718525844379617417700956139, -0.14673047445536238631014214206516, -0.14065823933284921087860652733070, -0.13458070850712641752799925143336, -0.12849811079379364064934065936541, -0.12241067519921602912980063138093, -0.11631863091190483561199187079183, -0.11022220729388336468712594751196, -0.10412163387205512765643078409994, -0.09801714032956050648426327143170, -0.09190895649713287651749737960927, -0.08579731234444028242780433402004, -0.07968243797143075013433843878374, -0.07356456359966741243017196438814, -0.06744391956366428686475700260416, -0.06132073630220905707810530316237, -0.05519524434968977461002381801336, -0.04906767432741809126239829197402, -0.04293825693494113943105006114820, -0.03680722294135939376413801937815, -0.03067480317663654268423023552259, -0.02454122852291244771816280945131, -0.01840672990580522611070435345937, -0.01227153828572057243928572489722, -0.00613588464915447700381845308470 };
@@ -108,6 +203,7 @@ public:
 	Wavetable() {
 		// --- clear the table of 128 table-pointers
 		memset(pdMultiTable128, 0, MAX_WAVE_TABLES*(sizeof(double*)));
+		memset(pfTable128, 0, MAX_WAVE_TABLES*(sizeof(float*)));
 	}
 
 	// --- clean up
@@ -118,28 +214,118 @@ public:
 	// --- set the table cloaked as void*
 	inline virtual void selectTable(uint32_t midiNoteNumber)
 	{
-		currentWaveTableLen = 0;
+		pvSelectedTable = (void*)getSourceTable(midiNoteNumber, currentWaveTableLen);
+
+		// --- float32 copy replaces the source table when enabled
+		selectedTableIsFloat = useFloatStorage && pfTable128[midiNoteNumber];
+		if (selectedTableIsFloat)
+			pvSelectedTable = (void*)(pfTable128[midiNoteNumber]);
+	}
+
+	// --- the 64-bit source table for a MIDI note and its length; does not change the selection
+	inline const void* getSourceTable(uint32_t midiNoteNumber, uint32_t& tableLen)
+	{
+		tableLen = 0;
 		if (tableType == wtTableType::kHiResWTSet)
-			currentWaveTableLen = pHiResWTSet->tableLengths[midiNoteNumber];
+			tableLen = pHiResWTSet->tableLengths[midiNoteNumber];
 		else
-			currentWaveTableLen = tableLength;
+			tableLen = tableLength;
 
-		pvSelectedTable = nullptr;
 		if (tableType == wtTableType::kSingleTable && pdSingleTable)
-			pvSelectedTable = (void*)(pdSingleTable);
+			return pdSingleTable;
 		else if (tableType == wtTableType::kMultiTable && pdMultiTable128[midiNoteNumber])
-			pvSelectedTable = (void*)(pdMultiTable128[midiNoteNumber]);
+			return pdMultiTable128[midiNoteNumber];
 		else
 		{
 			if (pHiResWTSet->isHexTable && pHiResWTSet->pp_uHexTableSet[midiNoteNumber])
-				pvSelectedTable = (void*)(pHiResWTSet->pp_uHexTableSet[midiNoteNumber]);
+				return pHiResWTSet->pp_uHexTableSet[midiNoteNumber];
 			else if (pHiResWTSet->pp_dDecimalTableSet[midiNoteNumber])
-				pvSelectedTable = (void*)(pHiResWTSet->pp_dDecimalTableSet[midiNoteNumber]);
+				return pHiResWTSet->pp_dDecimalTableSet[midiNoteNumber];
 		}
+
+		return nullptr;
+	}
+
+	// --- float32 storage: decodes every table once into floats, halving the read footprint
+	//     returns the worst-case SNR (dB) of the float tables vs. the 64-bit source
+	//     NOTE: call once at load, before the table is handed to the voices; the copies are
+	//           only freed by destroyWaveTables( ), so a voice never reads a deleted table
+	inline double createFloatTables()
+	{
+		if (floatTables.size() > 0)
+			return floatStorageSNR;
+
+		double worstSNR = 200.0;
+		const void* lastSource = nullptr;
+		uint32_t lastSourceLen = 0;
+		float* lastFloatTable = nullptr;
+		for (uint32_t note = 0; note < MAX_WAVE_TABLES; note++)
+		{
+			uint32_t sourceLen = 0;
+			const void* source = getSourceTable(note, sourceLen);
+			if (!source || sourceLen == 0)
+				continue;
+
+			// --- shared source tables share the float copy
+			if (source == lastSource && sourceLen == lastSourceLen)
+			{
+				pfTable128[note] = lastFloatTable;
+				continue;
+			}
+
+			float* floatTable = new float[sourceLen];
+			double signalPower = 0.0;
+			double noisePower = 0.0;
+			for (uint32_t i = 0; i < sourceLen; i++)
+			{
+				double sample = readSourceSample(source, i);
+				floatTable[i] = (float)sample;
+
+				double error = sample - (double)floatTable[i];
+				signalPower += sample*sample;
+				noisePower += error*error;
+			}
+
+			if (noisePower > 0.0 && signalPower > 0.0)
+				worstSNR = fmin(worstSNR, 10.0*log10(signalPower / noisePower));
+
+			pfTable128[note] = floatTable;
+			floatTables.push_back(floatTable);
+
+			lastSource = source;
+			lastSourceLen = sourceLen;
+			lastFloatTable = floatTable;
+		}
+
+		floatStorageSNR = worstSNR;
+		return worstSNR;
+	}
+
+	// --- read the float32 copies (if they were created) from the next selectTable( ) on;
+	//     both copies stay valid, so this is only a flag and can be switched at any time
+	inline void setFloatStorage(bool enable) { useFloatStorage = enable && floatTables.size() > 0; }
+
+	// --- worst-case SNR measured by createFloatTables( )
+	double getFloatStorageSNR() { return floatStorageSNR; }
+	bool isFloatStorage() { return useFloatStorage; }
+
+	inline void destroyFloatTables()
+	{
+		for (size_t i = 0; i < floatTables.size(); i++)
+			delete[] floatTables[i];
+		floatTables.clear();
+
+		memset(pfTable128, 0, MAX_WAVE_TABLES*(sizeof(float*)));
+		pvSelectedTable = nullptr;
+		useFloatStorage = false;
+		selectedTableIsFloat = false;
+		floatStorageSNR = 0.0;
 	}
 
 	inline void destroyWaveTables()
 	{
+		destroyFloatTables();
+
 		// --- the only one that needs destruction here is the multi-table
 		//     the others are all hard-coded (burned in)
 		if (tableType == wtTableType::kMultiTable)
@@ -186,7 +372,7 @@ public:
 		}
 	}
 
-	// --- read and interpolate: could add lagrange here
+	// --- read and interpolate: linear, hermite, lagrange or windowed sinc (see setInterpolation)
 	inline virtual double readWaveTable(double readIndex)
 	{
 		if (!pvSelectedTable)
@@ -201,10 +387,19 @@ public:
 		// --- get FRAC part
 		double fractionalPart = readIndex - intReadIndex;
 
+		// --- higher order: gather the taps around the read point, then run the kernel
+		if (interpolation != wtInterpolation::linear)
+			return outputComp * readWaveTableHighOrder(intReadIndex, fractionalPart);
+
 		// --- setup second index for interpolation; wrap the buffer if needed
 		int intReadIndexNext = intReadIndex + 1 > currentWaveTableLen - 1 ? 0 : intReadIndex + 1;
 
-		if (tableType == wtTableType::kSingleTable || tableType == wtTableType::kMultiTable)	
+		if (selectedTableIsFloat)
+		{
+			wtData[0] = ((float*)pvSelectedTable)[intReadIndex];
+			wtData[1] = ((float*)pvSelectedTable)[intReadIndexNext];
+		}
+		else if (tableType == wtTableType::kSingleTable || tableType == wtTableType::kMultiTable)	
 		{
 			wtData[0] = ((double*)pvSelectedTable)[intReadIndex];
 			wtData[1] = ((double*)pvSelectedTable)[intReadIndexNext];
@@ -238,6 +433,121 @@ public:
 	// --- get len
 	virtual uint32_t getWaveTableLength() { return currentWaveTableLen; }
 
+	// --- interpolation mode; see wtInterpolation
+	void setInterpolation(uint32_t _interpolation) { interpolation = _interpolation; }
+	uint32_t getInterpolation() { return interpolation; }
+
+	// --- quality check: SNR (dB) of a table read with the given interpolation at fractional
+	//     positions, measured against the ideal band-limited reading of the same points: the
+	//     table's harmonic series (its DFT) evaluated directly at each point
+	//     NOTE: changes the selected table; not for use on the audio thread
+	inline double measureInterpolationSNR(uint32_t midiNoteNumber, uint32_t testInterpolation, uint32_t pointsPerSample = 8)
+	{
+		selectTable(midiNoteNumber);
+		if (!pvSelectedTable || currentWaveTableLen < 2 || pointsPerSample == 0)
+			return 0.0;
+
+		const uint32_t tableLen = currentWaveTableLen;
+		const uint32_t numHarmonics = tableLen / 2;
+
+		// --- harmonic series: x(n) = sum of a[k]cos(2pi kn/N) + b[k]sin(2pi kn/N), k = 0 ... N/2
+		std::vector<double> cosTable(tableLen);
+		std::vector<double> sinTable(tableLen);
+		for (uint32_t n = 0; n < tableLen; n++)
+		{
+			cosTable[n] = cos(kTwoPi*n / tableLen);
+			sinTable[n] = sin(kTwoPi*n / tableLen);
+		}
+
+		std::vector<double> a(numHarmonics + 1, 0.0);
+		std::vector<double> b(numHarmonics + 1, 0.0);
+		for (uint32_t k = 0; k <= numHarmonics; k++)
+		{
+			for (uint32_t n = 0; n < tableLen; n++)
+			{
+				double sample = readTableSample(n);
+				uint32_t index = (uint32_t)(((uint64_t)k*n) % tableLen);
+				a[k] += sample*cosTable[index];
+				b[k] += sample*sinTable[index];
+			}
+
+			// --- DC and Nyquist appear once in the spectrum, the others twice
+			double scale = (k == 0 || 2 * k == tableLen) ? 1.0 / tableLen : 2.0 / tableLen;
+			a[k] *= scale;
+			b[k] *= scale;
+		}
+
+		uint32_t savedInterpolation = interpolation;
+		interpolation = testInterpolation;
+
+		double signalPower = 0.0;
+		double noisePower = 0.0;
+		for (uint32_t i = 0; i < tableLen*pointsPerSample; i++)
+		{
+			double readIndex = (double)i / (double)pointsPerSample;
+
+			// --- sum the harmonics at the read point; (cosK, sinK) rotates by the fundamental
+			double w = kTwoPi*readIndex / tableLen;
+			double cosW = cos(w);
+			double sinW = sin(w);
+			double cosK = 1.0;
+			double sinK = 0.0;
+			double reference = 0.0;
+			for (uint32_t k = 0; k <= numHarmonics; k++)
+			{
+				reference += a[k] * cosK + b[k] * sinK;
+				double nextCos = cosK*cosW - sinK*sinW;
+				sinK = sinK*cosW + cosK*sinW;
+				cosK = nextCos;
+			}
+			reference *= outputComp;
+
+			double test = readWaveTable(readIndex);
+
+			signalPower += reference*reference;
+			noisePower += (test - reference)*(test - reference);
+		}
+		interpolation = savedInterpolation;
+
+		if (noisePower <= 0.0)
+			return 200.0; // --- identical
+		return 10.0*log10(signalPower / noisePower);
+	}
+
+	// --- CPU check: average nanoseconds per readWaveTable( ) with the given interpolation,
+	//     sweeping the table at a non-integer increment as an oscillator would
+	//     NOTE: changes the selected table; not for use on the audio thread
+	inline double measureInterpolationCost(uint32_t midiNoteNumber, uint32_t testInterpolation, uint32_t numReads = 1 << 20)
+	{
+		selectTable(midiNoteNumber);
+		if (!pvSelectedTable || currentWaveTableLen == 0 || numReads == 0)
+			return 0.0;
+
+		uint32_t savedInterpolation = interpolation;
+		interpolation = testInterpolation;
+
+		const double tableLen = (double)currentWaveTableLen;
+		const double readIndexInc = 1.6180339887;
+		double readIndex = 0.0;
+		double sum = 0.0;
+
+		auto start = std::chrono::high_resolution_clock::now();
+		for (uint32_t i = 0; i < numReads; i++)
+		{
+			sum += readWaveTable(readIndex);
+			readIndex += readIndexInc;
+			if (readIndex >= tableLen)
+				readIndex -= tableLen;
+		}
+		auto end = std::chrono::high_resolution_clock::now();
+		interpolation = savedInterpolation;
+
+		// --- keep the reads from being optimized away
+		benchmarkSink = sum;
+
+		return std::chrono::duration<double, std::nano>(end - start).count() / numReads;
+	}
+
 	inline uint64_t getDecryptionKey()
 	{
 		if (pHiResWTSet)
@@ -371,12 +681,75 @@ public:
 	// --- type
 	wtTableType tableType = wtTableType::kUninitialized;
 
+	// --- interpolation (linear is default)
+	uint32_t interpolation = wtInterpolation::linear;
+
+	// --- optional float32 copies of the tables, one pointer per MIDI note
+	float* pfTable128[MAX_WAVE_TABLES];
+	std::vector<float*> floatTables;
+	bool useFloatStorage = false;
+	bool selectedTableIsFloat = false;
+	double floatStorageSNR = 0.0;
+
+	// --- written by measureInterpolationCost( )
+	volatile double benchmarkSink = 0.0;
+
 	// --- name for GUI
 	std::string waveformName;
 
 
 protected:
+	// --- one decoded sample from the selected table
+	inline double readTableSample(int index)
+	{
+		if (selectedTableIsFloat)
+			return ((float*)pvSelectedTable)[index];
+
+		return readSourceSample(pvSelectedTable, index);
+	}
+
+	// --- one decoded sample from a 64-bit source table
+	inline double readSourceSample(const void* table, int index)
+	{
+		if (tableType == wtTableType::kSingleTable || tableType == wtTableType::kMultiTable || pHiResWTSet->tableDataType == wtDataType::decimal)
+			return ((const double*)table)[index];
+		else if (pHiResWTSet->isEncrypted)
+			return uint64ToDouble(pHiResWTSet->encryptionKey ^ ((const uint64_t*)table)[index]);
 
+		return uint64ToDouble(((const uint64_t*)table)[index]);
+	}
+
+	// --- gather taps (wrapped) and run the selected kernel
+	inline double readWaveTableHighOrder(int intReadIndex, double fractionalPart)
+	{
+		const int tableLen = (int)currentWaveTableLen;
+		double taps[kWTSincTaps];
+
+		if (interpolation == wtInterpolation::windowedSinc)
+		{
+			// --- taps y[-3] ... y[4]
+			int index = intReadIndex - (int)(kWTSincTaps / 2 - 1);
+			for (uint32_t t = 0; t < kWTSincTaps; t++, index++)
+			{
+				int wrapped = index < 0 ? index + tableLen : (index >= tableLen ? index - tableLen : index);
+				taps[t] = readTableSample(wrapped);
+			}
+			return getWindowedSincKernel().interpolate(taps, fractionalPart);
+		}
+
+		// --- taps y[-1] ... y[2]
+		int index = intReadIndex - 1;
+		for (uint32_t t = 0; t < 4; t++, index++)
+		{
+			int wrapped = index < 0 ? index + tableLen : (index >= tableLen ? index - tableLen : index);
+			taps[t] = readTableSample(wrapped);
+		}
+
+		if (interpolation == wtInterpolation::hermite)
+			return doHermiteInterpolation(taps, fractionalPart);
+
+		return doLagrange4Interpolation(taps, fractionalPart);
+	}
 };
 #endif // definer
 
@@ -60,7 +60,11 @@ public:
 	WaveTableBank(){ }
 
 	// --- add a new wavetable -NOTE: this must be done at the same (just after) time as construction
-	inline void addWaveTable(Wavetable* wt){ wavetables.push_back(wt); }
+	inline void addWaveTable(Wavetable* wt)
+	{
+		wt->setInterpolation(interpolation);
+		wavetables.push_back(wt);
+	}
 
 	// --- from a .h File
 	//     tableNames can be nullptr -- if so, the name is the default table name
@@ -83,6 +87,9 @@ public:
 			this->addWaveTable(wt);
 		}
 
+		// --- float32 copies are made here, before any voice can select a table
+		createFloatTables();
+
 		// --- we are enabled!
 		enabled = true;
 	}
@@ -323,6 +330,74 @@ public:
 	// --- add more mathematical table generation
 
 
+	// --- interpolation is chosen per bank; see wtInterpolation
+	void setInterpolation(uint32_t _interpolation)
+	{
+		if (_interpolation == interpolation)
+			return;
+
+		interpolation = _interpolation;
+		for (size_t i = 0; i < wavetables.size(); i++)
+			wavetables[i]->setInterpolation(interpolation);
+	}
+	uint32_t getInterpolation() { return interpolation; }
+
+	// --- quality/CPU benchmark of one waveform at one MIDI note, one entry per wtInterpolation mode:
+	//     SNR against the ideal band-limited table and the average cost of a read
+	//     NOTE: changes the selected table; not for use on the audio thread
+	std::vector<InterpolationBenchmark> benchmarkInterpolation(uint32_t waveformIndex, uint32_t midiNoteNumber)
+	{
+		std::vector<InterpolationBenchmark> report;
+		if (waveformIndex >= wavetables.size() || midiNoteNumber >= MAX_WAVE_TABLES)
+			return report;
+
+		const uint32_t modes[4] = { wtInterpolation::linear, wtInterpolation::hermite, wtInterpolation::lagrange4, wtInterpolation::windowedSinc };
+		for (uint32_t i = 0; i < 4; i++)
+		{
+			InterpolationBenchmark line;
+			line.interpolation = modes[i];
+			line.snr_dB = wavetables[waveformIndex]->measureInterpolationSNR(midiNoteNumber, modes[i]);
+			line.nsPerRead = wavetables[waveformIndex]->measureInterpolationCost(midiNoteNumber, modes[i]);
+			report.push_back(line);
+		}
+
+		return report;
+	}
+
+	// --- float32 copies of every table in the bank, made once at load; returns the worst-case SNR (dB)
+	//     NOTE: not for use on the audio thread
+	double createFloatTables()
+	{
+		double worstSNR = 200.0;
+		for (size_t i = 0; i < wavetables.size(); i++)
+			worstSNR = fmin(worstSNR, wavetables[i]->createFloatTables());
+
+		return worstSNR;
+	}
+
+	// --- read the float32 copies instead of the 64-bit tables; only a flag, so it is safe on the audio thread
+	void setFloatStorage(bool enable)
+	{
+		if (enable == floatStorage)
+			return;
+
+		for (size_t i = 0; i < wavetables.size(); i++)
+			wavetables[i]->setFloatStorage(enable);
+
+		floatStorage = enable;
+	}
+	bool isFloatStorage() { return floatStorage; }
+
+	// --- SNR report, one entry (dB) per waveform, as measured when the float copies were made
+	std::vector<double> getFloatStorageReport()
+	{
+		std::vector<double> report;
+		for (size_t i = 0; i < wavetables.size(); i++)
+			report.push_back(wavetables[i]->getFloatStorageSNR());
+
+		return report;
+	}
+
 	// --- state
 	bool isEnabled() { return enabled; }
 	void setEnabled(bool _enabled) { enabled = _enabled; }
@@ -340,6 +415,12 @@ private:
 	// --- state (for user loading)
 	bool enabled = false;
 
+	// --- table interpolation for the whole bank
+	uint32_t interpolation = wtInterpolation::linear;
+
+	// --- float32 table storage
+	bool floatStorage = false;
+
 	// --- helper
 	inline uint32_t calculateNumTables(uint32_t seedMIDINote, uint32_t tableIntervalSemitones)
 	{
@@ -6,6 +6,7 @@
 
 // --- wavetable objects and structs
 #include "wavetablebank.h"
+#include "morphingwavebank.h"
 #include "wavetables/Lead.h"
 #include "wavetables/Rand.h"
 
@@ -44,12 +45,44 @@ public:
 
 	~WaveTableData()
 	{
-		for (int i = 0; i < waveBanks.size(); i++)
+		for (size_t i = 0; i < waveBanks.size(); i++)
 		{
 			WaveTableBank* wtBank = waveBanks[i];
 			delete wtBank;
 		}
 		waveBanks.clear();
+
+		for (size_t i = 0; i < morphingBanks.size(); i++)
+			delete morphingBanks[i];
+		morphingBanks.clear();
+	}
+
+	// --- decode the morphing banks; this is slow-ish (every frame of every note is decoded)
+	//     so it is done once, from the first SynthVoice::initialize( ) call, and never on the audio thread
+	bool initMorphingWaveBanks()
+	{
+		if (morphingBanks.size() > 0)
+			return true;
+
+		// --- the Lead bank's 32 tables become 32 morph frames
+		MorphingWaveBank* morphBank_0 = new MorphingWaveBank;
+		morphBank_0->setWaveBankName("Sik Morph");
+		morphBank_0->initializeWithHiResWTBank(Lead_BankDescriptor);
+		morphingBanks.push_back(morphBank_0);
+
+		// --- THIS IS WHERE YOU ADD MORE MORPHING BANKS!!
+
+		return true;
+	}
+
+	// --- get a morphing bank; nullptr if not initialized (yet)
+	MorphingWaveBank* getMorphingInterface(uint32_t morphBankIndex)
+	{
+		if (morphBankIndex >= morphingBanks.size())
+			return nullptr;
+
+		MorphingWaveBank* morphBank = morphingBanks[morphBankIndex];
+		return morphBank->isEnabled() ? morphBank : nullptr;
 	}
 
 	virtual bool resetWaveBanks(double sampleRate)
@@ -75,6 +108,40 @@ public:
 		return waveBanks[waveBankIndex];
 	}
 
+	// --- set the table interpolation for one bank
+	bool setBankInterpolation(uint32_t waveBankIndex, uint32_t interpolation)
+	{
+		if (waveBankIndex >= waveBanks.size())
+			return false;
+
+		waveBanks[waveBankIndex]->setInterpolation(interpolation);
+		return true;
+	}
+
+	// --- set the table interpolation for every bank; see SynthEngineParameters::waveTableInterpolation
+	void setInterpolation(uint32_t interpolation)
+	{
+		for (size_t i = 0; i < waveBanks.size(); i++)
+			waveBanks[i]->setInterpolation(interpolation);
+	}
+
+	// --- read one bank's float32 tables (made when the bank was loaded); only a flag
+	bool setBankFloatStorage(uint32_t waveBankIndex, bool enable)
+	{
+		if (waveBankIndex >= waveBanks.size())
+			return false;
+
+		waveBanks[waveBankIndex]->setFloatStorage(enable);
+		return true;
+	}
+
+	// --- read the float32 tables of every bank; see SynthEngineParameters::enableFloatWaveTables
+	void setFloatStorage(bool enable)
+	{
+		for (size_t i = 0; i < waveBanks.size(); i++)
+			waveBanks[i]->setFloatStorage(enable);
+	}
+
 	// --- get the number of banks for this datasource
 	virtual uint32_t getNumWaveBanks() { return waveBanks.size(); }
 
@@ -101,6 +168,9 @@ public:
 private:
 	// --- vector of wavetables
 	std::vector<WaveTableBank*> waveBanks;
+
+	// --- vector of morphing banks
+	std::vector<MorphingWaveBank*> morphingBanks;
 };
 
 
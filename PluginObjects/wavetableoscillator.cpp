@@ -38,6 +38,9 @@ bool WaveTableOsc::reset(double _sampleRate)
 	modCounter = 0.0;
 	phaseInc = 0.0;
 	waveTableReadIndex = 0.0;
+	phaseAccumulator = 0;
+	phaseIncFixed = 0;
+	unisonStack.reset();
 
 	return true;
 }
@@ -77,9 +80,14 @@ bool WaveTableOsc::doNoteOn(double midiPitch, uint32_t _midiNoteNumber, uint32_t
 	{
 		modCounter = 0.0;
 		waveTableReadIndex = 0.0;
+		phaseAccumulator = 0;
 	}
 
+	// --- copies restart at scattered phases unless free-running
+	unisonStack.doNoteOn(!parameters->enableFreeRunMode);
+
 	phaseInc = 0.0;
+	phaseIncFixed = 0;
 
 	return true;
 }
@@ -147,18 +155,44 @@ bool WaveTableOsc::update(bool updateAllModRoutings)
 	boundValue(oscillatorFrequency, 0.0, sampleRate / 2.0);
 	boundValue(oscillatorFrequencySlaveOsc, 0.0, sampleRate / 2.0);
 	
-	// --- find the midi note closest to the pitch to select the wavetable
-	renderMidiNoteNumber = midiNoteNumberFromOscFrequency(oscillatorFrequency);
+	// --- unison layout changes at control rate
+	if (unisonParameters)
+		unisonStack.setParameters(*unisonParameters);
+	unisonActive = unisonStack.isEnabled();
+
+	// --- find the midi note closest to the pitch to select the wavetable;
+	//     with unison, the highest copy picks it so none of them alias
+	double tableFrequency = unisonActive ? oscillatorFrequency*unisonStack.getMaxPitchRatio() : oscillatorFrequency;
+	boundValue(tableFrequency, 0.0, sampleRate / 2.0);
+	renderMidiNoteNumber = midiNoteNumberFromOscFrequency(tableFrequency);
 
 	// --- BANK is set here; can have any number of banks
 	selectedWaveBank = waveTableData->getInterface(getBankIndex(bankSet, parameters->oscillatorBankIndex));
 
 	uint32_t tableLen = kDefaultWaveTableLength;
+
+	// --- morphing replaces the single-table selection when a morph bank is available
+	morphActive = parameters->enableWaveMorph && updateMorphFrames(tableLen);
+
 	// --- calculate phase inc; this uses FINAL oscFrequency variable above
 	//
 	//     NOTE: uses selected bank from line of code above; these must be in pairs.
-	selectedWaveTable = selectedWaveBank->selectTable(parameters->oscillatorWaveformIndex, renderMidiNoteNumber, tableLen);
+	if (!morphActive)
+		selectedWaveTable = selectedWaveBank->selectTable(parameters->oscillatorWaveformIndex, renderMidiNoteNumber, tableLen);
+
+	// --- the copies always run on fixed-point phase
+	if (unisonActive)
+		unisonStack.setFrequency(oscillatorFrequency, sampleRate*oversamplingRatio);
 	
+	// --- fixed-point phase does not depend on the table length, so a table switch is free
+	if (parameters->enableFixedPointPhase)
+	{
+		currentTableLength = tableLen;
+		phaseIncFixed = (uint32_t)(oscillatorFrequency / (sampleRate*oversamplingRatio) * kPhaseAccumulatorScale);
+		phaseInc = calculateWaveTablePhaseInc(oscillatorFrequency, sampleRate*oversamplingRatio, currentTableLength);
+		return true;
+	}
+
 	// --- if table size changed, need to reset the current read location
 	//     to be in the same relative location as before
 	if (tableLen != currentTableLength)
@@ -170,19 +204,64 @@ bool WaveTableOsc::update(bool updateAllModRoutings)
 	}
 
 	// --- note that we need the current table length for this calculation, and we save it
-	phaseInc = calculateWaveTablePhaseInc(oscillatorFrequency, sampleRate, currentTableLength);
+	phaseInc = calculateWaveTablePhaseInc(oscillatorFrequency, sampleRate*oversamplingRatio, currentTableLength);
 
 	return true;
 }
 
+bool WaveTableOsc::updateMorphFrames(uint32_t& tableLen)
+{
+	selectedMorphBank = waveTableData->getMorphingInterface(parameters->morphBankIndex);
+	if (!selectedMorphBank)
+		return false;
+
+	uint32_t frameCount = selectedMorphBank->getMorphingTableCount();
+	uint32_t note = renderMidiNoteNumber;
+	const double** frameSet = selectedMorphBank->selectMorphingTableSet(note);
+	if (!frameSet || frameCount < 2)
+		return false;
+
+	// --- morph position is unipolar: GUI position + modulation, bounded
+	double morphPosition = parameters->waveMorphPosition + modulators->modulationInputs[kWaveMorphMod];
+	boundValue(morphPosition, 0.0, 1.0);
+
+	// --- scale to the frame range and split into pair + fraction
+	double framePosition = morphPosition * (double)(frameCount - 1);
+	uint32_t frameIndex = (uint32_t)framePosition;
+	if (frameIndex > frameCount - 2)
+		frameIndex = frameCount - 2;
+
+	morphFrameA = frameSet[frameIndex];
+	morphFrameB = frameSet[frameIndex + 1];
+	morphFrac = framePosition - (double)frameIndex;
+
+	tableLen = selectedMorphBank->getTableLength();
+	return tableLen > 0;
+}
+
 const OscillatorOutputData WaveTableOsc::renderAudioOutput()
 {
 	// --- prep output buffer
 	oscillatorAudioData.outputs[0] = 0.0;
 	oscillatorAudioData.outputs[1] = 0.0;
 
+	// --- unison stack is stereo
+	if (unisonActive)
+	{
+		double right = 0.0;
+		double left = renderUnison(right);
+		double gain = parameters->outputAmplitude * modulators->modulationInputs[kAmpMod];
+
+		oscillatorAudioData.outputs[0] = left * gain;
+		oscillatorAudioData.outputs[1] = right * gain;
+		return oscillatorAudioData;
+	}
+
 	// --- render into left channel
-	oscillatorAudioData.outputs[0] = readWaveTable(waveTableReadIndex, phaseInc);
+	if (parameters->enableFixedPointPhase)
+		oscillatorAudioData.outputs[0] = readWaveTableFixedPoint(phaseAccumulator, phaseIncFixed);
+	else
+		oscillatorAudioData.outputs[0] = readWaveTable(waveTableReadIndex, phaseInc);
 
 	// --- scale by output amplitude
 	oscillatorAudioData.outputs[0] *= (parameters->outputAmplitude * modulators->modulationInputs[kAmpMod]);
@@ -215,7 +294,10 @@ double WaveTableOsc::readWaveTable(double& readIndex, double _phaseInc)
 		checkAndWrapWaveTableIndex(phaseModReadIndex, currentTableLength);
 
 		// --- do the table read operation
-		output = selectedWaveBank->readWaveTable(selectedWaveTable,phaseModReadIndex);
+		if (morphActive)
+			output = MorphingWaveBank::readMorphingTable(morphFrameA, morphFrameB, morphFrac, phaseModReadIndex);
+		else
+			output = selectedWaveBank->readWaveTable(selectedWaveTable,phaseModReadIndex);
 	}
 
 	// --- increment index
@@ -224,4 +306,68 @@ double WaveTableOsc::readWaveTable(double& readIndex, double _phaseInc)
 
 	// --- adjust with final volume (amplitude)
 	return output;
-}
\ No newline at end of file
+}
+
+// --- read a table with the fixed-point accumulator; no wrapping needed anywhere
+double WaveTableOsc::readWaveTableFixedPoint(uint32_t& phase, uint32_t _phaseInc)
+{
+	// --- phase modulation is added in the integer domain and wraps with the accumulator
+	//     NOTE: the int64_t cast keeps negative modulation values intact before the wrap
+	uint32_t phaseMod = (uint32_t)(int64_t)(modulators->modulationInputs[kPhaseMod] * kPhaseAccumulatorScale);
+	uint32_t readPhase = phase + phaseMod;
+
+	// --- scale to table length: upper 32 bits = index, lower 32 bits = fraction
+	uint64_t scaledPhase = (uint64_t)readPhase * currentTableLength;
+	double readIndex = (double)(uint32_t)(scaledPhase >> 32) + (double)(uint32_t)scaledPhase * kPhaseAccumulatorInvScale;
+
+	double output = 0.0;
+	if (morphActive)
+		output = MorphingWaveBank::readMorphingTable(morphFrameA, morphFrameB, morphFrac, readIndex);
+	else
+		output = selectedWaveBank->readWaveTable(selectedWaveTable, readIndex);
+
+	// --- increment; wraps by itself
+	phase += _phaseInc;
+
+	return output;
+}
+
+// --- render all copies of the unison stack: phases -> read indexes, table reads, then pan and sum
+//     NOTE: the loops are split so the first and last have no calls in them
+double WaveTableOsc::renderUnison(double& right)
+{
+	const uint32_t count = unisonStack.getVoiceCount();
+	double readIndex[MAX_UNISON_VOICES];
+	double output[MAX_UNISON_VOICES];
+
+	// --- phase modulation applies to every copy
+	uint32_t phaseMod = (uint32_t)(int64_t)(modulators->modulationInputs[kPhaseMod] * kPhaseAccumulatorScale);
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		uint64_t scaledPhase = (uint64_t)(unisonStack.phase[i] + phaseMod) * currentTableLength;
+		readIndex[i] = (double)(uint32_t)(scaledPhase >> 32) + (double)(uint32_t)scaledPhase * kPhaseAccumulatorInvScale;
+		unisonStack.phase[i] += unisonStack.phaseInc[i];
+	}
+
+	if (morphActive)
+	{
+		for (uint32_t i = 0; i < count; i++)
+			output[i] = MorphingWaveBank::readMorphingTable(morphFrameA, morphFrameB, morphFrac, readIndex[i]);
+	}
+	else
+	{
+		for (uint32_t i = 0; i < count; i++)
+			output[i] = selectedWaveBank->readWaveTable(selectedWaveTable, readIndex[i]);
+	}
+
+	double left = 0.0;
+	right = 0.0;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		left += output[i] * unisonStack.panLeftGain[i];
+		right += output[i] * unisonStack.panRightGain[i];
+	}
+
+	return left;
+}
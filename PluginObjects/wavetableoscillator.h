@@ -8,6 +8,13 @@
 #include "wavetablebank.h"
 #include "wavetabledata.h"
 
+// --- detuned copies
+#include "unisonstack.h"
+
+
+// --- fixed-point phase: one cycle = 2^32
+const double kPhaseAccumulatorScale = 4294967296.0;
+const double kPhaseAccumulatorInvScale = 1.0 / 4294967296.0;
 
 /**
 \class WaveTableOsc
@@ -31,6 +38,14 @@ public:
 	virtual std::vector<std::string> getWaveformNames(uint32_t bankIndex);
 	virtual std::vector<std::string> getBankNames() { return waveTableData->getWaveBankNames(bankSet); }
 	virtual void setBankSet(uint32_t _bankSet) { bankSet = _bankSet; }
+
+	// --- unison: parameters are shared by the voice's oscillators, the stack is ours
+	void setUnisonParameters(std::shared_ptr<UnisonParameters> _unisonParameters) { unisonParameters = _unisonParameters; }
+	void setNoiseSeed(uint64_t seed, uint64_t stream) { unisonStack.setSeed(seed, stream); }
+	bool isStereo() { return unisonActive && unisonStack.isStereo(); }
+
+	// --- render at N x fs for the oversampled voice path; glide/update timing stays at fs
+	void setOversamplingRatio(uint32_t _oversamplingRatio) { oversamplingRatio = _oversamplingRatio > 0 ? _oversamplingRatio : 1; }
 	virtual uint32_t getBankSet() { return bankSet; }
 	virtual bool reset(double _sampleRate);
 	virtual bool update(bool updateAllModRoutings = true);
@@ -73,11 +88,30 @@ protected:
 
 	IWaveTable* selectedWaveTable = nullptr;
 
+	// --- wave morphing: frame pair and position, chosen in update( )
+	MorphingWaveBank* selectedMorphBank = nullptr;
+	const double* morphFrameA = nullptr;
+	const double* morphFrameB = nullptr;
+	double morphFrac = 0.0;
+	bool morphActive = false;
+
+	// --- selects the frame pair; returns the table length via tableLen
+	bool updateMorphFrames(uint32_t& tableLen);
+
 	uint32_t bankSet = BANK_SET_0;
 
 	// --- for anything
 	double readWaveTable(double& readIndex, double _phaseInc);
 
+	// --- fixed-point version: phase is 0 -> 2^32 for one cycle, independent of table length
+	double readWaveTableFixedPoint(uint32_t& phase, uint32_t _phaseInc);
+
+	// --- unison stack: fixed-point phases, returns left and sets right
+	double renderUnison(double& right);
+	std::shared_ptr<UnisonParameters> unisonParameters = nullptr;
+	UnisonStack unisonStack;
+	bool unisonActive = false;
+
 	// --- the FINAL frequncy after all modulations
 	double oscillatorFrequency = 440.0;
 	double oscillatorFrequencySlaveOsc = 440.0;
@@ -98,11 +132,16 @@ protected:
 	double modCounter = 0.0;						///<  VA modulo counter 0 to 1.0
 	double phaseInc = 0.0;							///<  phase inc = fo/fs
 	double sampleRate = 0.0;						///<  fs
+	uint32_t oversamplingRatio = 1;					///<  render rate = oversamplingRatio * fs
 	
 	// --- WaveRable oscillator variables
 	double waveTableReadIndex = 0.0;		///< wavetable read location
 	uint32_t currentTableLength = kDefaultWaveTableLength;
 
+	// --- fixed-point phase accumulator: wraps for free, 1 cycle = 2^32
+	uint32_t phaseAccumulator = 0;
+	uint32_t phaseIncFixed = 0;
+
 	// --- flag indicating state (running or not)
 	bool noteOn = false;
 